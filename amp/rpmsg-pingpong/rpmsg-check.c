@@ -0,0 +1,151 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Payload integrity and sequence checking for RPMsg benchmarks
+ *
+ * Copyright (c) 2026 Microchip Technology, Inc. All rights reserved
+ */
+
+#include <pthread.h>
+#include <string.h>
+
+#include "rpmsg-check.h"
+
+#define CRC32C_POLY	0x82f63b78	/* Castagnoli, reflected */
+
+static uint32_t crc32c_table[8][256];
+static pthread_once_t crc32c_once = PTHREAD_ONCE_INIT;
+
+static void crc32c_init(void)
+{
+	uint32_t crc;
+	int i, j;
+
+	for (i = 0; i < 256; i++) {
+		crc = i;
+		for (j = 0; j < 8; j++)
+			crc = crc & 1 ? (crc >> 1) ^ CRC32C_POLY : crc >> 1;
+		crc32c_table[0][i] = crc;
+	}
+	for (i = 0; i < 256; i++)
+		for (j = 1; j < 8; j++)
+			crc32c_table[j][i] = (crc32c_table[j - 1][i] >> 8) ^
+					     crc32c_table[0][crc32c_table[j - 1][i] & 0xff];
+}
+
+/*
+ * Slicing-by-8: eight table lookups per 64 bit word instead of one per
+ * byte. The U54 harts have no CRC or carry-less multiply instructions.
+ */
+uint32_t rpmsg_crc32c(uint32_t crc, const void *buf, size_t len)
+{
+	const uint8_t *p = buf;
+	uint64_t w;
+
+	pthread_once(&crc32c_once, crc32c_init);
+	crc = ~crc;
+
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	for (; len && ((uintptr_t)p & 7); len--)
+		crc = (crc >> 8) ^ crc32c_table[0][(crc ^ *p++) & 0xff];
+	for (; len >= 8; len -= 8, p += 8) {
+		memcpy(&w, p, sizeof(w));
+		w ^= crc;
+		crc = crc32c_table[7][w & 0xff] ^
+		      crc32c_table[6][(w >> 8) & 0xff] ^
+		      crc32c_table[5][(w >> 16) & 0xff] ^
+		      crc32c_table[4][(w >> 24) & 0xff] ^
+		      crc32c_table[3][(w >> 32) & 0xff] ^
+		      crc32c_table[2][(w >> 40) & 0xff] ^
+		      crc32c_table[1][(w >> 48) & 0xff] ^
+		      crc32c_table[0][w >> 56];
+	}
+#endif
+	for (; len; len--)
+		crc = (crc >> 8) ^ crc32c_table[0][(crc ^ *p++) & 0xff];
+
+	return ~crc;
+}
+
+/* The standard check value, also covering the unaligned head and tail */
+int rpmsg_crc32c_selftest(void)
+{
+	static const char check[] = "x123456789";
+
+	return rpmsg_crc32c(0, check + 1, 9) == 0xe3069283 ? 0 : -1;
+}
+
+static int seen_test(const struct rpmsg_seq *seq, uint64_t n)
+{
+	n %= RPMSG_SEQ_HISTORY;
+	return (seq->seen[n / 64] >> (n % 64)) & 1;
+}
+
+static void seen_set(struct rpmsg_seq *seq, uint64_t n)
+{
+	n %= RPMSG_SEQ_HISTORY;
+	seq->seen[n / 64] |= 1ULL << (n % 64);
+}
+
+static void seen_clear(struct rpmsg_seq *seq, uint64_t n)
+{
+	n %= RPMSG_SEQ_HISTORY;
+	seq->seen[n / 64] &= ~(1ULL << (n % 64));
+}
+
+void rpmsg_seq_reset(struct rpmsg_seq *seq)
+{
+	memset(seq, 0, sizeof(*seq));
+}
+
+/* Move 'next' forward, counting the sequence numbers passed over as missing */
+void rpmsg_seq_skip(struct rpmsg_seq *seq, uint64_t next)
+{
+	uint64_t n;
+
+	if (next <= seq->next)
+		return;
+	seq->missing += next - seq->next;
+	if (next - seq->next >= RPMSG_SEQ_HISTORY) {
+		memset(seq->seen, 0, sizeof(seq->seen));
+	} else {
+		for (n = seq->next; n < next; n++)
+			seen_clear(seq, n);
+	}
+	seq->next = next;
+}
+
+/* Account for message 'n', which passed the integrity check */
+enum rpmsg_seq_result rpmsg_seq_rx(struct rpmsg_seq *seq, uint64_t n)
+{
+	if (n >= seq->next) {
+		rpmsg_seq_skip(seq, n);
+		seen_set(seq, n);
+		seq->next = n + 1;
+		seq->received++;
+		return RPMSG_SEQ_NEW;
+	}
+	if (seq->next - n > RPMSG_SEQ_HISTORY) {
+		seq->late++;
+		return RPMSG_SEQ_LATE;
+	}
+	if (seen_test(seq, n)) {
+		seq->duplicates++;
+		return RPMSG_SEQ_DUPLICATE;
+	}
+	seen_set(seq, n);
+	seq->missing--;
+	seq->reordered++;
+	seq->received++;
+	return RPMSG_SEQ_REORDERED;
+}
+
+/* Add up the counters of several endpoints */
+void rpmsg_seq_merge(struct rpmsg_seq *total, const struct rpmsg_seq *seq)
+{
+	total->received += seq->received;
+	total->missing += seq->missing;
+	total->reordered += seq->reordered;
+	total->duplicates += seq->duplicates;
+	total->late += seq->late;
+	total->corrupt += seq->corrupt;
+}
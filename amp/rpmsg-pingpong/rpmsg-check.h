@@ -0,0 +1,48 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/*
+ * Payload integrity and sequence checking for RPMsg benchmarks
+ *
+ * Copyright (c) 2026 Microchip Technology, Inc. All rights reserved
+ *
+ * Every message carries a sequence number and a CRC32C over the message.
+ * The receiver keeps a bitmap of the last RPMSG_SEQ_HISTORY sequence
+ * numbers, so a message that arrives after a later one is told apart from
+ * a duplicate. Messages skipped over count as missing until they turn up.
+ */
+
+#ifndef __RPMSG_CHECK_H
+#define __RPMSG_CHECK_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define RPMSG_CRC_SIZE		sizeof(uint32_t)
+#define RPMSG_SEQ_HISTORY	1024
+
+enum rpmsg_seq_result {
+	RPMSG_SEQ_NEW,		/* the highest sequence number so far */
+	RPMSG_SEQ_REORDERED,	/* missing until now, arrived after a later one */
+	RPMSG_SEQ_DUPLICATE,
+	RPMSG_SEQ_LATE,		/* older than the history, can't tell */
+};
+
+struct rpmsg_seq {
+	uint64_t next;		/* one past the highest sequence number seen */
+	unsigned long received;	/* distinct messages that passed the check */
+	unsigned long missing;	/* skipped over and not seen since */
+	unsigned long reordered;
+	unsigned long duplicates;
+	unsigned long late;
+	unsigned long corrupt;	/* bad CRC or length */
+	uint64_t seen[RPMSG_SEQ_HISTORY / 64];
+};
+
+uint32_t rpmsg_crc32c(uint32_t crc, const void *buf, size_t len);
+int rpmsg_crc32c_selftest(void);
+
+void rpmsg_seq_reset(struct rpmsg_seq *seq);
+enum rpmsg_seq_result rpmsg_seq_rx(struct rpmsg_seq *seq, uint64_t n);
+void rpmsg_seq_skip(struct rpmsg_seq *seq, uint64_t next);
+void rpmsg_seq_merge(struct rpmsg_seq *total, const struct rpmsg_seq *seq);
+
+#endif /* __RPMSG_CHECK_H */
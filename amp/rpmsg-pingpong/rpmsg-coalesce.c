@@ -0,0 +1,82 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Small message coalescing with a latency deadline on an RPMsg endpoint
+ *
+ * Copyright (c) 2026 Microchip Technology, Inc. All rights reserved
+ */
+
+#include <time.h>
+
+#include "rpmsg-coalesce.h"
+
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/* A deadline of 0 writes every message straight away */
+void rpmsg_coalesce_init(struct rpmsg_coalesce *co, struct rpmsg_frag *frag,
+			 unsigned int deadline_us)
+{
+	co->frag = frag;
+	co->deadline_ns = deadline_us * 1000ULL;
+	co->oldest_ns = 0;
+	co->msgs = 0;
+	co->full_flushes = 0;
+	co->deadline_flushes = 0;
+}
+
+int rpmsg_coalesce_write(struct rpmsg_coalesce *co, const void *msg, size_t len)
+{
+	unsigned long frames = co->frag->frames_sent;
+	int ret;
+
+	if (!co->frag->tx_len)
+		co->oldest_ns = now_ns();
+
+	ret = rpmsg_frag_send(co->frag, msg, len, co->deadline_ns != 0);
+	if (ret)
+		return ret;
+	co->msgs++;
+
+	/* rpmsg_frag_send() wrote out frames that filled up */
+	if (co->deadline_ns && co->frag->frames_sent != frames) {
+		co->full_flushes += co->frag->frames_sent - frames;
+		if (co->frag->tx_len)
+			co->oldest_ns = now_ns();
+	}
+
+	return rpmsg_coalesce_poll(co);
+}
+
+/* Nanoseconds until the pending frame is due, or -1 when nothing is pending */
+int64_t rpmsg_coalesce_remaining_ns(const struct rpmsg_coalesce *co)
+{
+	uint64_t now;
+
+	if (!co->frag->tx_len)
+		return -1;
+
+	now = now_ns();
+	if (now - co->oldest_ns >= co->deadline_ns)
+		return 0;
+	return co->oldest_ns + co->deadline_ns - now;
+}
+
+/* Write the pending frame if its deadline has expired */
+int rpmsg_coalesce_poll(struct rpmsg_coalesce *co)
+{
+	if (rpmsg_coalesce_remaining_ns(co) != 0)
+		return 0;
+
+	co->deadline_flushes++;
+	return rpmsg_frag_flush(co->frag);
+}
+
+int rpmsg_coalesce_flush(struct rpmsg_coalesce *co)
+{
+	return rpmsg_frag_flush(co->frag);
+}
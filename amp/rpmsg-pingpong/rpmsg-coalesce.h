@@ -0,0 +1,41 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/*
+ * Small message coalescing with a latency deadline on an RPMsg endpoint
+ *
+ * Copyright (c) 2026 Microchip Technology, Inc. All rights reserved
+ *
+ * Every write to the endpoint costs a full RPMsg buffer and a mailbox
+ * interrupt on the remote hart. The coalescing writer batches messages
+ * through the rpmsg-frag layer and writes the frame when it is full, or
+ * once the oldest message in it has waited 'deadline_us'. The caller runs
+ * rpmsg_coalesce_poll() from its event loop, sleeping at most
+ * rpmsg_coalesce_remaining_ns() between calls.
+ */
+
+#ifndef __RPMSG_COALESCE_H
+#define __RPMSG_COALESCE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "rpmsg-frag.h"
+
+struct rpmsg_coalesce {
+	struct rpmsg_frag *frag;
+	uint64_t deadline_ns;
+	uint64_t oldest_ns;	/* when the pending frame got its first message */
+
+	/* statistics */
+	unsigned long msgs;
+	unsigned long full_flushes;
+	unsigned long deadline_flushes;
+};
+
+void rpmsg_coalesce_init(struct rpmsg_coalesce *co, struct rpmsg_frag *frag,
+			 unsigned int deadline_us);
+int rpmsg_coalesce_write(struct rpmsg_coalesce *co, const void *msg, size_t len);
+int rpmsg_coalesce_poll(struct rpmsg_coalesce *co);
+int64_t rpmsg_coalesce_remaining_ns(const struct rpmsg_coalesce *co);
+int rpmsg_coalesce_flush(struct rpmsg_coalesce *co);
+
+#endif /* __RPMSG_COALESCE_H */
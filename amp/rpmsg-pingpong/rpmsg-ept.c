@@ -0,0 +1,474 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * RPMsg char endpoint setup with a cached fast path
+ *
+ * Copyright (c) 2026 Microchip Technology, Inc. All rights reserved
+ */
+
+#include <sys/inotify.h>
+#include <sys/ioctl.h>
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <linux/rpmsg.h>
+
+#include "rpmsg-ept.h"
+
+#define RPMSG_BUS_SYS		"/sys/bus/rpmsg"
+#define RPMSG_CLASS_SYS		"/sys/class/rpmsg"
+#define RPMSG_CHRDEV		"rpmsg_chrdev"
+#define DEV_WAIT_MS		1000
+
+/* Read the first line of a sysfs attribute, without the newline */
+static int read_attr(const char *path, char *buf, size_t len)
+{
+	FILE *fp;
+	char *nl;
+
+	fp = fopen(path, "r");
+	if (!fp)
+		return -errno;
+	if (!fgets(buf, len, fp)) {
+		fclose(fp);
+		return -EIO;
+	}
+	fclose(fp);
+	nl = strchr(buf, '\n');
+	if (nl)
+		*nl = '\0';
+	return 0;
+}
+
+/* Does /dev/'dev_name' belong to endpoint 'name' with source address 'src'? */
+static int ept_matches(const struct rpmsg_ctx *ctx, const char *dev_name,
+		       const char *name, unsigned int src)
+{
+	char path[2 * NAME_MAX], buf[64];
+
+	snprintf(path, sizeof(path), RPMSG_CLASS_SYS "/%s/%s/name",
+		 ctx->ctrl_name, dev_name);
+	if (read_attr(path, buf, sizeof(buf)) || strcmp(buf, name))
+		return 0;
+
+	/* kernels without the src attribute match on the name alone */
+	snprintf(path, sizeof(path), RPMSG_CLASS_SYS "/%s/%s/src",
+		 ctx->ctrl_name, dev_name);
+	if (read_attr(path, buf, sizeof(buf)))
+		return 1;
+	return strtoul(buf, NULL, 0) == src;
+}
+
+/* Scan the control device's endpoints, stopping at the first match */
+static int find_ept(const struct rpmsg_ctx *ctx, const char *name,
+		    unsigned int src, char *dev_name, size_t len)
+{
+	char dpath[2 * NAME_MAX];
+	struct dirent *ent;
+	DIR *dir;
+
+	snprintf(dpath, sizeof(dpath), RPMSG_CLASS_SYS "/%s", ctx->ctrl_name);
+	dir = opendir(dpath);
+	if (!dir)
+		return -errno;
+	while ((ent = readdir(dir)) != NULL) {
+		if (strncmp(ent->d_name, "rpmsg", 5) ||
+		    !strncmp(ent->d_name, "rpmsg_ctrl", 10))
+			continue;
+		if (ctx->verbose)
+			printf("checking %s/%s\n", dpath, ent->d_name);
+		if (strlen(ent->d_name) < len &&
+		    ept_matches(ctx, ent->d_name, name, src)) {
+			strcpy(dev_name, ent->d_name);
+			closedir(dir);
+			return 0;
+		}
+	}
+	closedir(dir);
+	return -ENOENT;
+}
+
+/* Find the channel whose bus device name contains 'service' */
+static int lookup_channel(const char *service, char *out, size_t len)
+{
+	struct dirent *ent;
+	DIR *dir;
+
+	dir = opendir(RPMSG_BUS_SYS "/devices");
+	if (!dir)
+		return -errno;
+	while ((ent = readdir(dir)) != NULL) {
+		if (strstr(ent->d_name, service)) {
+			snprintf(out, len, "%s", ent->d_name);
+			closedir(dir);
+			return 0;
+		}
+	}
+	closedir(dir);
+	return -ENOENT;
+}
+
+/* Channel devices are named <virtio>.<service>.<src>.<dst> */
+static unsigned int channel_dst(const char *channel)
+{
+	const char *lastdot = strrchr(channel, '.');
+
+	return lastdot ? strtoul(lastdot + 1, NULL, 10) : 0;
+}
+
+static int is_bound(const char *channel)
+{
+	char path[2 * NAME_MAX], link[PATH_MAX];
+	const char *driver;
+	ssize_t len;
+
+	snprintf(path, sizeof(path), RPMSG_BUS_SYS "/devices/%s/driver", channel);
+	len = readlink(path, link, sizeof(link) - 1);
+	if (len < 0)
+		return 0;
+	link[len] = '\0';
+	driver = strrchr(link, '/');
+	return !strcmp(driver ? driver + 1 : link, RPMSG_CHRDEV);
+}
+
+static int write_attr(const char *path, const char *val)
+{
+	int fd, ret;
+
+	fd = open(path, O_WRONLY);
+	if (fd < 0) {
+		fprintf(stderr, "Failed to open %s, %s\n", path, strerror(errno));
+		return -EINVAL;
+	}
+	ret = write(fd, val, strlen(val) + 1);
+	if (ret < 0)
+		fprintf(stderr, "Failed to write %s to %s, %s\n",
+			val, path, strerror(errno));
+	close(fd);
+	return ret < 0 ? -EINVAL : 0;
+}
+
+static int bind_chrdev(const char *channel)
+{
+	char path[2 * NAME_MAX];
+	int ret;
+
+	snprintf(path, sizeof(path), RPMSG_BUS_SYS "/devices/%s/driver_override",
+		 channel);
+	ret = write_attr(path, RPMSG_CHRDEV);
+	if (ret)
+		return ret;
+
+	return write_attr(RPMSG_BUS_SYS "/drivers/" RPMSG_CHRDEV "/bind", channel);
+}
+
+static int find_ctrl(const char *bus_dev, char *ctrl_name, size_t len)
+{
+	char dpath[2 * NAME_MAX];
+	struct dirent *ent;
+	DIR *dir;
+
+	snprintf(dpath, sizeof(dpath), RPMSG_BUS_SYS "/devices/%s/rpmsg", bus_dev);
+	dir = opendir(dpath);
+	if (!dir)
+		return -errno;
+	while ((ent = readdir(dir)) != NULL) {
+		if (!strncmp(ent->d_name, "rpmsg_ctrl", 10) &&
+		    strlen(ent->d_name) < len) {
+			strcpy(ctrl_name, ent->d_name);
+			closedir(dir);
+			return 0;
+		}
+	}
+	closedir(dir);
+	return -ENOENT;
+}
+
+static void cache_load(struct rpmsg_ctx *ctx)
+{
+	struct rpmsg_ept_entry *e;
+	char line[NAME_MAX + 64];
+	FILE *fp;
+
+	fp = fopen(ctx->cache_path, "r");
+	if (!fp)
+		return;
+	while (fgets(line, sizeof(line), fp)) {
+		e = &ctx->epts[ctx->num_epts];
+		if (sscanf(line, "channel %255s", ctx->channel) == 1 ||
+		    sscanf(line, "ctrl %31s", ctx->ctrl_name) == 1 ||
+		    sscanf(line, "dst %u", &ctx->dst) == 1)
+			continue;
+		if (ctx->num_epts < RPMSG_EPT_MAX_CACHED &&
+		    sscanf(line, "ept %15s %u %31s", e->dev_name, &e->src, e->name) == 3)
+			ctx->num_epts++;
+	}
+	fclose(fp);
+}
+
+/*
+ * Written to a temporary file and renamed, so readers never see half a cache.
+ * The temporary file is created with mkstemp() next to the cache, so that a
+ * planted file or symlink cannot redirect the write.
+ */
+static void cache_save(const struct rpmsg_ctx *ctx)
+{
+	char tmp[PATH_MAX];
+	FILE *fp;
+	int i, fd;
+
+	if (!ctx->cache_path)
+		return;
+	if (snprintf(tmp, sizeof(tmp), "%s.XXXXXX", ctx->cache_path) >= (int)sizeof(tmp))
+		return;
+	fd = mkstemp(tmp);
+	if (fd < 0)
+		return;
+	fp = fdopen(fd, "w");
+	if (!fp) {
+		close(fd);
+		unlink(tmp);
+		return;
+	}
+	fprintf(fp, "channel %s\nctrl %s\ndst %u\n", ctx->channel,
+		ctx->ctrl_name, ctx->dst);
+	for (i = 0; i < ctx->num_epts; i++)
+		fprintf(fp, "ept %s %u %s\n", ctx->epts[i].dev_name,
+			ctx->epts[i].src, ctx->epts[i].name);
+	if (fclose(fp) == 0)
+		rename(tmp, ctx->cache_path);
+	else
+		unlink(tmp);
+}
+
+static void cache_add(struct rpmsg_ctx *ctx, const char *dev_name,
+		      const char *name, unsigned int src)
+{
+	struct rpmsg_ept_entry *e;
+	int i;
+
+	for (i = 0; i < ctx->num_epts; i++) {
+		e = &ctx->epts[i];
+		if (!strcmp(e->dev_name, dev_name) || (!strcmp(e->name, name) &&
+						       e->src == src))
+			break;
+	}
+	if (i == RPMSG_EPT_MAX_CACHED)
+		return;
+	e = &ctx->epts[i];
+	if (i < ctx->num_epts && !strcmp(e->dev_name, dev_name) &&
+	    !strcmp(e->name, name) && e->src == src)
+		return;
+
+	snprintf(e->dev_name, sizeof(e->dev_name), "%s", dev_name);
+	snprintf(e->name, sizeof(e->name), "%s", name);
+	e->src = src;
+	if (i == ctx->num_epts)
+		ctx->num_epts++;
+	cache_save(ctx);
+}
+
+/*
+ * The device node normally exists as soon as the ioctl returns, but when
+ * udev creates it instead, wait for it to appear in /dev.
+ */
+static int open_dev(const char *dev_name)
+{
+	char path[32 + NAME_MAX];
+	char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+	struct pollfd pfd;
+	int fd, ifd;
+
+	snprintf(path, sizeof(path), "/dev/%s", dev_name);
+	fd = open(path, O_RDWR | O_NONBLOCK);
+	if (fd >= 0 || errno != ENOENT)
+		return fd < 0 ? -errno : fd;
+
+	ifd = inotify_init1(IN_NONBLOCK);
+	if (ifd < 0)
+		return -ENOENT;
+	inotify_add_watch(ifd, "/dev", IN_CREATE | IN_ATTRIB);
+
+	pfd.fd = ifd;
+	pfd.events = POLLIN;
+	fd = open(path, O_RDWR | O_NONBLOCK);
+	while (fd < 0 && errno == ENOENT && poll(&pfd, 1, DEV_WAIT_MS) > 0) {
+		while (read(ifd, buf, sizeof(buf)) > 0)
+			;
+		fd = open(path, O_RDWR | O_NONBLOCK);
+	}
+	close(ifd);
+
+	return fd < 0 ? -errno : fd;
+}
+
+static int ctx_cache_valid(const struct rpmsg_ctx *ctx)
+{
+	char path[2 * NAME_MAX];
+
+	if (!ctx->channel[0] || !ctx->ctrl_name[0])
+		return 0;
+	snprintf(path, sizeof(path), RPMSG_CLASS_SYS "/%s", ctx->ctrl_name);
+	if (access(path, F_OK))
+		return 0;
+	snprintf(path, sizeof(path), RPMSG_BUS_SYS "/devices/%s", ctx->channel);
+	return !access(path, F_OK) && is_bound(ctx->channel);
+}
+
+/*
+ * Resolve the channel and its control device. 'channel' names the channel's
+ * bus device; when NULL the cached channel is used, then the first one whose
+ * name contains 'service', then 'default_channel'.
+ */
+int rpmsg_ctx_open(struct rpmsg_ctx *ctx, const char *channel,
+		   const char *service, const char *default_channel,
+		   const char *cache_path, int verbose)
+{
+	char path[2 * NAME_MAX], ctrl_bus_dev[NAME_MAX + 1];
+	const char *dot;
+	int ret;
+
+	memset(ctx, 0, sizeof(*ctx));
+	ctx->ctrl_fd = -1;
+	ctx->cache_path = cache_path;
+	ctx->verbose = verbose;
+
+	if (cache_path) {
+		cache_load(ctx);
+		if ((!channel || !strcmp(channel, ctx->channel)) &&
+		    ctx_cache_valid(ctx)) {
+			ctx->cached = 1;
+			return 0;
+		}
+		ctx->num_epts = 0;
+	}
+
+	if (channel)
+		snprintf(ctx->channel, sizeof(ctx->channel), "%s", channel);
+	else if (lookup_channel(service, ctx->channel, sizeof(ctx->channel)))
+		snprintf(ctx->channel, sizeof(ctx->channel), "%s", default_channel);
+	ctx->dst = channel_dst(ctx->channel);
+
+	snprintf(path, sizeof(path), RPMSG_BUS_SYS "/devices/%s", ctx->channel);
+	if (access(path, F_OK)) {
+		fprintf(stderr, "access(%s): %s\n", path, strerror(errno));
+		return -ENODEV;
+	}
+
+	if (!is_bound(ctx->channel)) {
+		if (verbose)
+			printf("binding %s to %s\n", ctx->channel, RPMSG_CHRDEV);
+		ret = bind_chrdev(ctx->channel);
+		if (ret)
+			return ret;
+	}
+
+	/* kernel >= 6.0 has a separate <virtio>.rpmsg_ctrl.0.0 device */
+	dot = strchr(ctx->channel, '.');
+	snprintf(ctrl_bus_dev, sizeof(ctrl_bus_dev), "%.*s.rpmsg_ctrl.0.0",
+		 dot ? (int)(dot - ctx->channel) : 0, ctx->channel);
+	if (find_ctrl(ctrl_bus_dev, ctx->ctrl_name, sizeof(ctx->ctrl_name)) &&
+	    find_ctrl(ctx->channel, ctx->ctrl_name, sizeof(ctx->ctrl_name))) {
+		fprintf(stderr, "No rpmsg_ctrl device found for %s\n", ctx->channel);
+		return -ENODEV;
+	}
+
+	cache_save(ctx);
+	return 0;
+}
+
+void rpmsg_ctx_close(struct rpmsg_ctx *ctx)
+{
+	if (ctx->ctrl_fd >= 0)
+		close(ctx->ctrl_fd);
+	ctx->ctrl_fd = -1;
+}
+
+/*
+ * Open endpoint 'name' with source address 'src', trying in turn the cached
+ * device, an existing endpoint with the same name and address, and creating
+ * a new one. Endpoints are not destroyed on close, so they are reused by the
+ * next run.
+ */
+int rpmsg_ept_open(struct rpmsg_ctx *ctx, const char *name, unsigned int src,
+		   struct rpmsg_ept *ept)
+{
+	struct rpmsg_endpoint_info info;
+	char path[32 + NAME_MAX];
+	int i, fd, err;
+
+	memset(ept, 0, sizeof(*ept));
+	ept->fd = -1;
+	ept->src = src;
+	ept->dst = ctx->dst;
+
+	for (i = 0; i < ctx->num_epts; i++) {
+		if (!strcmp(ctx->epts[i].name, name) && ctx->epts[i].src == src &&
+		    ept_matches(ctx, ctx->epts[i].dev_name, name, src)) {
+			snprintf(ept->dev_name, sizeof(ept->dev_name), "%s",
+				 ctx->epts[i].dev_name);
+			ept->origin = RPMSG_EPT_CACHED;
+			goto open;
+		}
+	}
+
+	if (!find_ept(ctx, name, src, ept->dev_name, sizeof(ept->dev_name))) {
+		ept->origin = RPMSG_EPT_REUSED;
+		goto open;
+	}
+
+	if (ctx->ctrl_fd < 0) {
+		snprintf(path, sizeof(path), "/dev/%s", ctx->ctrl_name);
+		ctx->ctrl_fd = open(path, O_RDWR | O_NONBLOCK);
+		if (ctx->ctrl_fd < 0) {
+			err = errno;
+			fprintf(stderr, "open %s, %s\n", path, strerror(err));
+			return -err;
+		}
+	}
+
+	memset(&info, 0, sizeof(info));
+	snprintf(info.name, sizeof(info.name), "%s", name);
+	info.src = src;
+	info.dst = ctx->dst;
+	if (ioctl(ctx->ctrl_fd, RPMSG_CREATE_EPT_IOCTL, &info)) {
+		err = errno;
+		fprintf(stderr, "Failed to create endpoint %s: %s\n", name,
+			strerror(err));
+		return -err;
+	}
+	if (find_ept(ctx, name, src, ept->dev_name, sizeof(ept->dev_name))) {
+		fprintf(stderr, "No endpoint device for %s:%s\n", ctx->ctrl_name, name);
+		return -ENOENT;
+	}
+	ept->origin = RPMSG_EPT_CREATED;
+
+open:
+	fd = open_dev(ept->dev_name);
+	if (fd < 0) {
+		fprintf(stderr, "open /dev/%s, %s\n", ept->dev_name, strerror(-fd));
+		return fd;
+	}
+	ept->fd = fd;
+	cache_add(ctx, ept->dev_name, name, src);
+
+	return 0;
+}
+
+void rpmsg_ept_close(struct rpmsg_ept *ept)
+{
+	if (ept->fd >= 0)
+		close(ept->fd);
+	ept->fd = -1;
+}
+
+const char *rpmsg_ept_origin_name(enum rpmsg_ept_origin origin)
+{
+	static const char * const names[] = { "cached", "reused", "created" };
+
+	return names[origin];
+}
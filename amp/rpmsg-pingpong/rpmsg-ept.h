@@ -0,0 +1,65 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/*
+ * RPMsg char endpoint setup with a cached fast path
+ *
+ * Copyright (c) 2026 Microchip Technology, Inc. All rights reserved
+ *
+ * Setting up an endpoint from scratch means finding the channel on the rpmsg
+ * bus, binding it to the rpmsg_chrdev driver, finding its rpmsg_ctrl device,
+ * creating the endpoint and finding the /dev/rpmsgN device it was given.
+ * The resolved channel, control device and endpoint devices are written to
+ * a small cache file, and endpoints are left in place on exit, so a restart
+ * only has to check the cached entries against sysfs and open the device.
+ */
+
+#ifndef __RPMSG_EPT_H
+#define __RPMSG_EPT_H
+
+#include <limits.h>
+
+#define RPMSG_EPT_DEFAULT_CACHE	"/run/rpmsg-ept.cache"
+#define RPMSG_EPT_MAX_CACHED	16
+#define RPMSG_EPT_NAME_LEN	32	/* RPMSG_NAME_SIZE */
+
+struct rpmsg_ept_entry {
+	char dev_name[16];		/* rpmsgN */
+	char name[RPMSG_EPT_NAME_LEN];
+	unsigned int src;
+};
+
+struct rpmsg_ctx {
+	char channel[NAME_MAX + 1];	/* rpmsg bus device of the channel */
+	char ctrl_name[32];		/* rpmsg_ctrlN */
+	int ctrl_fd;			/* opened only to create endpoints */
+	unsigned int dst;		/* remote address, from the channel name */
+	const char *cache_path;		/* NULL disables the cache */
+	int cached;			/* channel and ctrl came from the cache */
+	int verbose;
+	struct rpmsg_ept_entry epts[RPMSG_EPT_MAX_CACHED];
+	int num_epts;
+};
+
+enum rpmsg_ept_origin {
+	RPMSG_EPT_CACHED,		/* cached device checked and opened */
+	RPMSG_EPT_REUSED,		/* existing endpoint found in sysfs */
+	RPMSG_EPT_CREATED,		/* created with RPMSG_CREATE_EPT_IOCTL */
+};
+
+struct rpmsg_ept {
+	int fd;
+	char dev_name[16];
+	unsigned int src;
+	unsigned int dst;
+	enum rpmsg_ept_origin origin;
+};
+
+int rpmsg_ctx_open(struct rpmsg_ctx *ctx, const char *channel,
+		   const char *service, const char *default_channel,
+		   const char *cache_path, int verbose);
+void rpmsg_ctx_close(struct rpmsg_ctx *ctx);
+int rpmsg_ept_open(struct rpmsg_ctx *ctx, const char *name, unsigned int src,
+		   struct rpmsg_ept *ept);
+void rpmsg_ept_close(struct rpmsg_ept *ept);
+const char *rpmsg_ept_origin_name(enum rpmsg_ept_origin origin);
+
+#endif /* __RPMSG_EPT_H */
@@ -0,0 +1,233 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Message fragmentation, reassembly and batching on an RPMsg endpoint
+ *
+ * Copyright (c) 2026 Microchip Technology, Inc. All rights reserved
+ */
+
+#include <errno.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "rpmsg-frag.h"
+
+#define HDR_SIZE		sizeof(struct rpmsg_frag_hdr)
+#define TX_TIMEOUT_MS		2000
+
+/*
+ * 'frame_size' is the largest write the remote side accepts, 'max_msg' the
+ * largest message that will be reassembled.
+ */
+int rpmsg_frag_init(struct rpmsg_frag *frag, int fd, size_t frame_size,
+		    size_t max_msg)
+{
+	if (frame_size <= HDR_SIZE || frame_size > RPMSG_FRAG_MAX_FRAME)
+		return -EINVAL;
+
+	memset(frag, 0, sizeof(*frag));
+	frag->rx_msg = malloc(max_msg ? max_msg : 1);
+	if (!frag->rx_msg)
+		return -ENOMEM;
+	frag->fd = fd;
+	frag->frame_size = frame_size;
+	frag->rx_msg_max = max_msg;
+
+	return 0;
+}
+
+void rpmsg_frag_free(struct rpmsg_frag *frag)
+{
+	free(frag->rx_msg);
+	frag->rx_msg = NULL;
+}
+
+/* The endpoint is non-blocking: wait for a free transmit buffer if needed */
+int rpmsg_frag_flush(struct rpmsg_frag *frag)
+{
+	struct pollfd pfd = { .fd = frag->fd, .events = POLLOUT };
+	ssize_t ret;
+
+	if (!frag->tx_len)
+		return 0;
+
+	for (;;) {
+		ret = write(frag->fd, frag->tx_frame, frag->tx_len);
+		if (ret == frag->tx_len)
+			break;
+		if (ret >= 0)
+			return -EIO;
+		if (errno != EAGAIN && errno != ENOMEM && errno != EINTR)
+			return -errno;
+
+		ret = poll(&pfd, 1, TX_TIMEOUT_MS);
+		if (ret == 0)
+			return -ETIMEDOUT;
+		if (ret < 0 && errno != EINTR)
+			return -errno;
+	}
+
+	frag->frames_sent++;
+	frag->tx_len = 0;
+	return 0;
+}
+
+/*
+ * Queue 'msg' and write the frame unless 'more' is set and there is room
+ * left for another record. A message that fits in a frame is never split:
+ * the pending frame is flushed first if needed. Larger messages fill the
+ * pending frame and then as many whole frames as they need.
+ */
+int rpmsg_frag_send(struct rpmsg_frag *frag, const void *msg, size_t len, int more)
+{
+	const uint8_t *data = msg;
+	struct rpmsg_frag_hdr hdr;
+	uint8_t flags = RPMSG_FRAG_FIRST;
+	size_t chunk;
+	int ret;
+
+	if (len > UINT32_MAX)
+		return -EMSGSIZE;
+
+	if (len + HDR_SIZE <= frag->frame_size &&
+	    frag->tx_len + HDR_SIZE + len > frag->frame_size) {
+		ret = rpmsg_frag_flush(frag);
+		if (ret)
+			return ret;
+	}
+
+	for (;;) {
+		if (frag->frame_size - frag->tx_len <= HDR_SIZE) {
+			ret = rpmsg_frag_flush(frag);
+			if (ret)
+				return ret;
+		}
+
+		chunk = frag->frame_size - frag->tx_len - HDR_SIZE;
+		if (chunk >= len)
+			chunk = len;
+		hdr.len = chunk;
+		hdr.flags = flags | (chunk == len ? RPMSG_FRAG_LAST : 0);
+		hdr.seq = frag->tx_seq++;
+		hdr.total = len;
+		memcpy(frag->tx_frame + frag->tx_len, &hdr, HDR_SIZE);
+		memcpy(frag->tx_frame + frag->tx_len + HDR_SIZE, data, chunk);
+		frag->tx_len += HDR_SIZE + chunk;
+
+		data += chunk;
+		len -= chunk;
+		flags = 0;
+		if (!len)
+			break;
+	}
+
+	frag->msgs_sent++;
+	if (!more || frag->frame_size - frag->tx_len <= HDR_SIZE)
+		return rpmsg_frag_flush(frag);
+	return 0;
+}
+
+/* Count the message in progress as lost and skip its remaining records */
+static void rx_drop(struct rpmsg_frag *frag)
+{
+	frag->rx_errors++;
+	frag->rx_active = 0;
+	frag->rx_discard = 1;
+}
+
+/*
+ * Returns the length of the next complete message, copied to 'buf', or
+ * -EAGAIN when the endpoint has no more frames. A message longer than 'len'
+ * is dropped and reported as -EMSGSIZE. Damaged or incomplete messages are
+ * dropped and counted in 'rx_errors', once per message.
+ */
+ssize_t rpmsg_frag_recv(struct rpmsg_frag *frag, void *buf, size_t len)
+{
+	struct rpmsg_frag_hdr hdr;
+	const uint8_t *data;
+	ssize_t ret;
+
+	for (;;) {
+		if (frag->rx_pos >= frag->rx_len) {
+			ret = read(frag->fd, frag->rx_frame, sizeof(frag->rx_frame));
+			if (ret < 0)
+				return errno == EINTR ? -EAGAIN : -errno;
+			if (ret == 0)
+				return -EAGAIN;
+			frag->rx_len = ret;
+			frag->rx_pos = 0;
+			frag->frames_received++;
+		}
+
+		if (frag->rx_len - frag->rx_pos < HDR_SIZE) {
+			frag->rx_pos = frag->rx_len;
+			rx_drop(frag);
+			continue;
+		}
+		memcpy(&hdr, frag->rx_frame + frag->rx_pos, HDR_SIZE);
+		frag->rx_pos += HDR_SIZE;
+		if (hdr.len > frag->rx_len - frag->rx_pos) {
+			frag->rx_pos = frag->rx_len;
+			rx_drop(frag);
+			continue;
+		}
+		data = frag->rx_frame + frag->rx_pos;
+		frag->rx_pos += hdr.len;
+
+		/* a gap in the record sequence loses the message in progress */
+		if (hdr.seq != frag->rx_seq && frag->rx_active)
+			rx_drop(frag);
+		frag->rx_seq = hdr.seq + 1;
+
+		if (hdr.flags & RPMSG_FRAG_FIRST) {
+			if (frag->rx_active)
+				rx_drop(frag);
+			frag->rx_discard = 0;
+
+			/* the common case, a whole message in one record */
+			if ((hdr.flags & RPMSG_FRAG_LAST) && hdr.len == hdr.total) {
+				frag->msgs_received++;
+				if (hdr.len > len)
+					return -EMSGSIZE;
+				memcpy(buf, data, hdr.len);
+				return hdr.len;
+			}
+
+			if (hdr.total > frag->rx_msg_max) {
+				rx_drop(frag);
+				continue;
+			}
+			frag->rx_active = 1;
+			frag->rx_msg_len = 0;
+			frag->rx_msg_total = hdr.total;
+		} else if (!frag->rx_active) {
+			/* the start was lost, count the message once */
+			if (!frag->rx_discard)
+				rx_drop(frag);
+			frag->rx_discard = !(hdr.flags & RPMSG_FRAG_LAST);
+			continue;
+		}
+
+		if (hdr.len > frag->rx_msg_total - frag->rx_msg_len) {
+			rx_drop(frag);
+			continue;
+		}
+		memcpy(frag->rx_msg + frag->rx_msg_len, data, hdr.len);
+		frag->rx_msg_len += hdr.len;
+
+		if (!(hdr.flags & RPMSG_FRAG_LAST))
+			continue;
+		frag->rx_active = 0;
+		if (frag->rx_msg_len != frag->rx_msg_total) {
+			frag->rx_errors++;
+			continue;
+		}
+
+		frag->msgs_received++;
+		if (frag->rx_msg_len > len)
+			return -EMSGSIZE;
+		memcpy(buf, frag->rx_msg, frag->rx_msg_len);
+		return frag->rx_msg_len;
+	}
+}
@@ -0,0 +1,71 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/*
+ * Message fragmentation, reassembly and batching on an RPMsg endpoint
+ *
+ * Copyright (c) 2026 Microchip Technology, Inc. All rights reserved
+ *
+ * Every frame written to the endpoint holds one or more records, each an
+ * 8 byte header followed by up to a frame's worth of message data:
+ *
+ *   | len (16) | flags (8) | seq (8) | total (32) | data ... |
+ *
+ * A message that fits in one record is sent with both FIRST and LAST set.
+ * Larger messages are cut into records that fill whole frames; 'total'
+ * carries the message length in the FIRST record. Small messages sent with
+ * 'more' set share a frame until it is full or rpmsg_frag_flush() is called.
+ * 'seq' counts records modulo 256 so a lost frame is detected on receive.
+ */
+
+#ifndef __RPMSG_FRAG_H
+#define __RPMSG_FRAG_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <sys/types.h>
+
+#define RPMSG_FRAG_FIRST	0x01
+#define RPMSG_FRAG_LAST		0x02
+#define RPMSG_FRAG_MAX_FRAME	256
+
+struct rpmsg_frag_hdr {
+	uint16_t len;
+	uint8_t flags;
+	uint8_t seq;
+	uint32_t total;
+};
+
+struct rpmsg_frag {
+	int fd;
+	size_t frame_size;
+
+	uint8_t tx_frame[RPMSG_FRAG_MAX_FRAME];
+	size_t tx_len;
+	uint8_t tx_seq;
+
+	uint8_t rx_frame[RPMSG_FRAG_MAX_FRAME];
+	size_t rx_len;
+	size_t rx_pos;
+	uint8_t rx_seq;
+	uint8_t *rx_msg;	/* reassembly buffer */
+	size_t rx_msg_len;
+	size_t rx_msg_total;
+	size_t rx_msg_max;
+	int rx_active;		/* a message is being reassembled */
+	int rx_discard;		/* skipping the rest of a dropped message */
+
+	/* statistics */
+	unsigned long frames_sent;
+	unsigned long frames_received;
+	unsigned long msgs_sent;
+	unsigned long msgs_received;
+	unsigned long rx_errors;
+};
+
+int rpmsg_frag_init(struct rpmsg_frag *frag, int fd, size_t frame_size,
+		    size_t max_msg);
+void rpmsg_frag_free(struct rpmsg_frag *frag);
+int rpmsg_frag_send(struct rpmsg_frag *frag, const void *msg, size_t len, int more);
+int rpmsg_frag_flush(struct rpmsg_frag *frag);
+ssize_t rpmsg_frag_recv(struct rpmsg_frag *frag, void *buf, size_t len);
+
+#endif /* __RPMSG_FRAG_H */
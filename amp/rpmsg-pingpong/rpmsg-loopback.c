@@ -0,0 +1,154 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Userspace loopback stand-in for an RPMsg endpoint
+ *
+ * Copyright (c) 2026 Microchip Technology, Inc. All rights reserved
+ */
+
+#define _GNU_SOURCE
+
+#include <sys/socket.h>
+#include <errno.h>
+#include <poll.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "rpmsg-loopback.h"
+
+struct echo_slot {
+	uint64_t due_ns;
+	size_t len;
+	/* one byte more than allowed, to tell oversize messages apart */
+	uint8_t data[RPMSG_LOOPBACK_MAX_MSG + 1];
+};
+
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/*
+ * Messages are queued in arrival order with the time they are due back,
+ * and the same delay applies to all of them, so the queue stays sorted.
+ * The thread exits when the application closes its end.
+ */
+static void *echo_thread(void *arg)
+{
+	struct rpmsg_loopback *lb = arg;
+	struct pollfd pfd = { .fd = lb->peer };
+	unsigned int head = 0, tail = 0;
+	struct echo_slot *slot;
+	struct timespec ts, *tsp;
+	uint64_t now, wait;
+	struct echo_slot *queue;
+	int blocked = 0;
+	ssize_t ret;
+
+	queue = malloc(RPMSG_LOOPBACK_DEPTH * sizeof(*queue));
+	if (!queue)
+		return NULL;
+
+	for (;;) {
+		pfd.events = 0;
+		if (tail - head < RPMSG_LOOPBACK_DEPTH)
+			pfd.events |= POLLIN;
+		if (blocked)
+			pfd.events |= POLLOUT;
+
+		tsp = NULL;
+		if (head != tail && !blocked) {
+			now = now_ns();
+			slot = &queue[head % RPMSG_LOOPBACK_DEPTH];
+			wait = slot->due_ns > now ? slot->due_ns - now : 0;
+			ts.tv_sec = wait / 1000000000ULL;
+			ts.tv_nsec = wait % 1000000000ULL;
+			tsp = &ts;
+		}
+		if (ppoll(&pfd, 1, tsp, NULL) < 0 && errno != EINTR)
+			goto out;
+		if (pfd.revents & POLLOUT)
+			blocked = 0;
+
+		while (tail - head < RPMSG_LOOPBACK_DEPTH) {
+			slot = &queue[tail % RPMSG_LOOPBACK_DEPTH];
+			ret = recv(lb->peer, slot->data, sizeof(slot->data),
+				   MSG_DONTWAIT | MSG_TRUNC);
+			if (ret == 0)
+				goto out;
+			if (ret < 0) {
+				if (errno != EAGAIN && errno != EINTR)
+					goto out;
+				break;
+			}
+			if (ret > RPMSG_LOOPBACK_MAX_MSG) {
+				lb->oversize++;
+				continue;
+			}
+			slot->len = ret;
+			slot->due_ns = now_ns() + lb->delay_us * 1000ULL;
+			tail++;
+		}
+
+		now = now_ns();
+		while (head != tail && !blocked) {
+			slot = &queue[head % RPMSG_LOOPBACK_DEPTH];
+			if (slot->due_ns > now)
+				break;
+			ret = send(lb->peer, slot->data, slot->len,
+				   MSG_DONTWAIT | MSG_NOSIGNAL);
+			if (ret < 0) {
+				if (errno != EAGAIN && errno != ENOBUFS)
+					goto out;
+				blocked = 1;
+				break;
+			}
+			lb->echoed++;
+			head++;
+		}
+	}
+
+out:
+	free(queue);
+	return NULL;
+}
+
+int rpmsg_loopback_open(struct rpmsg_loopback *lb, unsigned int delay_us)
+{
+	int sv[2];
+	int ret;
+
+	/* the rpmsg char endpoints are opened O_NONBLOCK */
+	memset(lb, 0, sizeof(*lb));
+	if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK, 0, sv))
+		return -errno;
+	lb->fd = sv[0];
+	lb->peer = sv[1];
+	lb->delay_us = delay_us;
+
+	ret = -pthread_create(&lb->thread, NULL, echo_thread, lb);
+	if (ret) {
+		close(lb->fd);
+		close(lb->peer);
+		lb->fd = -1;
+		return ret;
+	}
+
+	return 0;
+}
+
+void rpmsg_loopback_close(struct rpmsg_loopback *lb)
+{
+	if (lb->fd < 0)
+		return;
+	shutdown(lb->fd, SHUT_RDWR);
+	pthread_join(lb->thread, NULL);
+	close(lb->fd);
+	close(lb->peer);
+	lb->fd = -1;
+}
@@ -0,0 +1,42 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/*
+ * Userspace loopback stand-in for an RPMsg endpoint
+ *
+ * Copyright (c) 2026 Microchip Technology, Inc. All rights reserved
+ *
+ * A SOCK_SEQPACKET socketpair keeps message boundaries like the rpmsg char
+ * device does. A thread on the far end plays the remote echo firmware:
+ * every message is written back 'delay_us' after it was read, so several
+ * messages can be in flight at once. Messages larger than an RPMsg buffer
+ * are dropped, as the real endpoint would refuse them.
+ *
+ * The rpmsg char driver queues received messages without limit, so the
+ * remote side never waits for the application to read. The echo thread
+ * holds up to RPMSG_LOOPBACK_DEPTH messages for the same reason, and with
+ * the socket buffers that is more than a vring, so back pressure sets in
+ * later than on the hardware.
+ */
+
+#ifndef __RPMSG_LOOPBACK_H
+#define __RPMSG_LOOPBACK_H
+
+#include <pthread.h>
+
+#define RPMSG_LOOPBACK_MAX_MSG	240	/* MAX_RPMSG_BUFF_SIZE */
+#define RPMSG_LOOPBACK_DEPTH	1024	/* messages held by the echo thread */
+
+struct rpmsg_loopback {
+	int fd;			/* the application's end, non-blocking */
+	int peer;		/* the echo thread's end */
+	unsigned int delay_us;
+	pthread_t thread;
+
+	/* statistics, valid after rpmsg_loopback_close() */
+	unsigned long echoed;
+	unsigned long oversize;
+};
+
+int rpmsg_loopback_open(struct rpmsg_loopback *lb, unsigned int delay_us);
+void rpmsg_loopback_close(struct rpmsg_loopback *lb);
+
+#endif /* __RPMSG_LOOPBACK_H */
@@ -13,17 +13,27 @@
  *
  */
 
-#include <dirent.h>
+#define _GNU_SOURCE
+
 #include <errno.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <limits.h>
 #include <unistd.h>
-#include <sys/ioctl.h>
 #include <time.h>
 #include <fcntl.h>
+#include <poll.h>
 #include <string.h>
-#include <linux/rpmsg.h>
+
+#include "mem-region.h"
+#include "rpmsg-check.h"
+#include "rpmsg-coalesce.h"
+#include "rpmsg-ept.h"
+#include "rpmsg-frag.h"
+#include "rpmsg-loopback.h"
+#include "rpmsg-shm.h"
+#include "rpmsg-stats.h"
 
 struct _payload {
 	unsigned long num;
@@ -31,256 +41,131 @@ struct _payload {
 	char data[];
 };
 
-struct _payload *i_payload;
-struct _payload *r_payload;
+/* per thread, so every endpoint worker has its own buffers */
+__thread struct _payload *i_payload;
+__thread struct _payload *r_payload;
 
 #define RPMSG_HEADER_LEN 16
 #define MAX_RPMSG_BUFF_SIZE (256 - RPMSG_HEADER_LEN)
 #define PAYLOAD_MIN_SIZE	1
 #define PAYLOAD_MAX_SIZE	(MAX_RPMSG_BUFF_SIZE - 24)
 #define NUM_PAYLOADS		(PAYLOAD_MAX_SIZE/PAYLOAD_MIN_SIZE)
+#define PAYLOAD_HDR_SIZE	(2 * sizeof(unsigned long))
+#define ARRAY_SIZE(a)		(sizeof(a) / sizeof((a)[0]))
 
-#define RPMSG_BUS_SYS "/sys/bus/rpmsg"
+#define BENCH_DEFAULT_COUNT	10000
+#define BULK_DEFAULT_COUNT	1000
+#define BULK_WINDOW		16
+#define FRAG_WINDOW		16
+#define FRAG_MAX_MSG		4096
+#define COALESCE_DEFAULT_RATE	10000
+#define COALESCE_DEFAULT_IRQ	"mailbox"
+#define MAX_ENDPOINTS		16
+#define EPT_SRC_BASE		0x400	/* source address of extra endpoints */
+#define BENCH_WARMUP		100
+#define RECV_TIMEOUT_MS		2000
 
-static int app_rpmsg_create_ept(int rpfd, struct rpmsg_endpoint_info *eptinfo)
-{
-	int ret;
+#define DEFAULT_CHANNEL		"virtio0.rpmsg-amp-demo-channel.-1.0"
+#define EPT_NAME		"rpmsg-openamp-demo-channel"
 
-	ret = ioctl(rpfd, RPMSG_CREATE_EPT_IOCTL, eptinfo);
-	if (ret)
-		perror("Failed to create endpoint.\n");
-	return ret;
-}
+/* How to wait for an echo on the non-blocking endpoint */
+enum rpmsg_wait {
+	WAIT_POLL,	/* sleep in poll() until the endpoint is readable */
+	WAIT_BUSY,	/* spin on read(), lowest latency but burns a hart */
+	WAIT_SLEEP,	/* the original 10 ms usleep() loop, for comparison */
+};
 
-static char *get_rpmsg_ept_dev_name(const char *rpmsg_char_name,
-				    const char *ept_name,
-				    char *ept_dev_name)
-{
-	char sys_rpmsg_ept_name_path[64];
-	char svc_name[64];
-	char *sys_rpmsg_path = "/sys/class/rpmsg";
-	FILE *fp;
-	int i;
-	int ept_name_len;
-
-	for (i = 0; i < 128; i++) {
-		sprintf(sys_rpmsg_ept_name_path, "%s/%s/rpmsg%d/name",
-			sys_rpmsg_path, rpmsg_char_name, i);
-		printf("checking %s\n", sys_rpmsg_ept_name_path);
-		if (access(sys_rpmsg_ept_name_path, F_OK) < 0)
-			continue;
-		fp = fopen(sys_rpmsg_ept_name_path, "r");
-		if (!fp) {
-			printf("failed to open %s\n", sys_rpmsg_ept_name_path);
-			break;
-		}
-		fgets(svc_name, sizeof(svc_name), fp);
-		fclose(fp);
-		printf("svc_name: %s.\n",svc_name);
-		ept_name_len = strlen(ept_name);
-		if (ept_name_len > sizeof(svc_name))
-			ept_name_len = sizeof(svc_name);
-		if (!strncmp(svc_name, ept_name, ept_name_len)) {
-			sprintf(ept_dev_name, "rpmsg%d", i);
-			return ept_dev_name;
-		}
-	}
+static const char * const wait_names[] = { "poll", "busy", "sleep" };
+#define NUM_WAIT_MODES	ARRAY_SIZE(wait_names)
+static enum rpmsg_wait wait_mode = WAIT_POLL;
 
-	printf("Not able to RPMsg endpoint file for %s:%s.\n",
-	       rpmsg_char_name, ept_name);
-	return NULL;
-}
+static const int bench_sizes[] = { PAYLOAD_MIN_SIZE, 16, 64, 128, PAYLOAD_MAX_SIZE };
+static const int bench_windows[] = { 1, 2, 4, 8, 16, 32 };
+static const int bulk_sizes[] = { 1024, 4096, 16384, 65536, 262144 };
+/* 0 stands for a mix of sizes, see mixed_size() */
+static const int frag_sizes[] = { 0, 16, 64, 1024, FRAG_MAX_MSG };
+static const int coalesce_deadlines[] = { 0, 20, 50, 100, 200, 500, 1000 };
 
-static int bind_rpmsg_chrdev(const char *rpmsg_dev_name)
-{
-	char fpath[256];
-	char *rpmsg_chdrv = "rpmsg_chrdev";
-	int fd;
-	int ret;
+enum bench_mode {
+	BENCH_NONE,
+	BENCH_LATENCY,		/* one message in flight, round trip time */
+	BENCH_THROUGHPUT,	/* up to 'window' messages in flight */
+	BENCH_BULK,		/* RPMsg chunks against shared memory descriptors */
+	BENCH_FRAG,		/* fragmented and batched messages */
+	BENCH_COALESCE,		/* paced small messages through the coalescing writer */
+};
 
-	/* rpmsg dev overrides path */
-	sprintf(fpath, "%s/devices/%s/driver_override",
-		RPMSG_BUS_SYS, rpmsg_dev_name);
-	fd = open(fpath, O_WRONLY);
-	if (fd < 0) {
-		fprintf(stderr, "Failed to open %s, %s\n",
-			fpath, strerror(errno));
-		return -EINVAL;
-	}
-	ret = write(fd, rpmsg_chdrv, strlen(rpmsg_chdrv) + 1);
-	if (ret < 0) {
-		fprintf(stderr, "Failed to write %s to %s, %s\n",
-			rpmsg_chdrv, fpath, strerror(errno));
-		return -EINVAL;
-	}
-	close(fd);
-
-	/* bind the rpmsg device to rpmsg char driver */
-	sprintf(fpath, "%s/drivers/%s/bind", RPMSG_BUS_SYS, rpmsg_chdrv);
-	fd = open(fpath, O_WRONLY);
-	if (fd < 0) {
-		fprintf(stderr, "Failed to open %s, %s\n",
-			fpath, strerror(errno));
-		return -EINVAL;
-	}
-	ret = write(fd, rpmsg_dev_name, strlen(rpmsg_dev_name) + 1);
-	if (ret < 0) {
-		fprintf(stderr, "Failed to write %s to %s, %s\n",
-			rpmsg_dev_name, fpath, strerror(errno));
-		return -EINVAL;
-	}
-	close(fd);
-	return 0;
-}
+struct bench_config {
+	enum bench_mode mode;
+	const char *label;
+	const char *json_path;
+	int size;		/* 0 for every size in bench_sizes */
+	int count;
+	int window;		/* 0 for every window in bench_windows */
+	const char *shm_spec;	/* shared region for BENCH_BULK */
+	int deadline_us;	/* -1 for every deadline in coalesce_deadlines */
+	int rate;		/* messages per second for BENCH_COALESCE */
+	const char *irq_name;	/* /proc/interrupts line to count */
+	int validate;		/* CRC and sequence check for BENCH_THROUGHPUT */
+};
 
-static int get_rpmsg_chrdev_fd(const char *rpmsg_dev_name,
-			       char *rpmsg_ctrl_name)
+/*
+ * Wait for the endpoint to become readable. '*deadline' is set on the first
+ * call and returns -ETIMEDOUT once 'timeout_ms' (-1 waits forever) is up.
+ */
+static int wait_readable(int fd, uint64_t *deadline, int timeout_ms)
 {
-	char dpath[2*NAME_MAX];
-	char *rpmsg_ctrl_prefix = "rpmsg_ctrl";
-	DIR *dir;
-	struct dirent *ent;
-	int fd;
+	struct pollfd pfd = { .fd = fd, .events = POLLIN };
+	uint64_t now;
 
-	sprintf(dpath, "%s/devices/%s/rpmsg", RPMSG_BUS_SYS, rpmsg_dev_name);
-	dir = opendir(dpath);
-	if (dir == NULL) {
-		fprintf(stderr, "Failed to open dir %s\n", dpath);
-		return -EINVAL;
-	}
-	while ((ent = readdir(dir)) != NULL) {
-		if (!strncmp(ent->d_name, rpmsg_ctrl_prefix, strlen(rpmsg_ctrl_prefix))) {
-			sprintf(dpath, "/dev/%s", ent->d_name);
-			closedir(dir);
-			fd = open(dpath, O_RDWR | O_NONBLOCK);
-			if (fd < 0) {
-				fprintf(stderr, "open %s, %s\n",
-					dpath, strerror(errno));
-				return fd;
-			}
-			sprintf(rpmsg_ctrl_name, "%s", ent->d_name);
-			return fd;
-		}
+	if (timeout_ms >= 0) {
+		now = rpmsg_now_ns();
+		if (!*deadline)
+			*deadline = now + timeout_ms * 1000000ULL;
+		else if (now >= *deadline)
+			return -ETIMEDOUT;
 	}
 
-	fprintf(stderr, "No rpmsg_ctrl file found in %s\n", dpath);
-	closedir(dir);
-	return -EINVAL;
-}
-
-static void set_src_dst(char *out, struct rpmsg_endpoint_info *pep)
-{
-	long dst = 0;
-	char *lastdot = strrchr(out, '.');
-
-	if (lastdot == NULL)
-		return;
-	dst = strtol(lastdot + 1, NULL, 10);
-	if ((errno == ERANGE && (dst == LONG_MAX || dst == LONG_MIN))
-	    || (errno != 0 && dst == 0)) {
-		return;
+	switch (wait_mode) {
+	case WAIT_POLL:
+		if (poll(&pfd, 1, timeout_ms) < 0 && errno != EINTR)
+			return -errno;
+		break;
+	case WAIT_BUSY:
+		break;
+	case WAIT_SLEEP:
+		usleep(10000);
+		break;
 	}
-	pep->dst = (unsigned int)dst;
+	return 0;
 }
 
-static void lookup_channel(char *out, struct rpmsg_endpoint_info *pep)
+/*
+ * Returns the number of bytes received, -ETIMEDOUT when nothing arrived
+ * within 'timeout_ms' (-1 waits forever) or -errno.
+ */
+static int recv_payload(int fd, struct _payload *payload, int timeout_ms)
 {
-	char dpath[] = RPMSG_BUS_SYS "/devices";
-	struct dirent *ent;
-	DIR *dir = opendir(dpath);
+	uint64_t deadline = 0;
+	int bytes_rcvd, ret;
 
-	if (dir == NULL) {
-		fprintf(stderr, "opendir %s, %s\n", dpath, strerror(errno));
-		return;
-	}
-	while ((ent = readdir(dir)) != NULL) {
-		if (strstr(ent->d_name, pep->name)) {
-			strncpy(out, ent->d_name, NAME_MAX);
-			set_src_dst(out, pep);
-			closedir(dir);
-			return;
-		}
+	for (;;) {
+		bytes_rcvd = read(fd, payload, MAX_RPMSG_BUFF_SIZE);
+		if (bytes_rcvd > 0)
+			return bytes_rcvd;
+		if (bytes_rcvd < 0 && errno != EAGAIN && errno != EINTR)
+			return -errno;
+
+		ret = wait_readable(fd, &deadline, timeout_ms);
+		if (ret)
+			return ret;
 	}
-	closedir(dir);
-	fprintf(stderr, "No dev file for %s in %s\n", pep->name, dpath);
 }
 
-int main(int argc, char *argv[])
+static int echo_test(int fd, int ntimes)
 {
-	int ret, i, j;
+	int i, j;
 	int size, bytes_rcvd, bytes_sent, err_cnt = 0;
-	int opt, charfd, fd;
-	int ntimes = 1;
-	char *rpmsg_dev="virtio0.rpmsg-amp-demo-channel.-1.0";
-	char rpmsg_ctrl_dev_name[NAME_MAX] = "virtio0.rpmsg_ctrl.0.0";
-	char rpmsg_char_name[16];
-	char fpath[2*NAME_MAX];
-	struct rpmsg_endpoint_info eptinfo = {
-		.name = "rpmsg-openamp-demo-channel", .src = 0, .dst = 0
-	};
-	char ept_dev_name[16];
-	char ept_dev_path[32];
-
-	printf("\r\n Echo test start \r\n");
-	lookup_channel(rpmsg_dev, &eptinfo);
-
-	while ((opt = getopt(argc, argv, "d:n:")) != -1) {
-		switch (opt) {
-		case 'd':
-			rpmsg_dev = optarg;
-			break;
-		case 'n':
-			ntimes = atoi(optarg);
-			break;
-		default:
-			printf("getopt return unsupported option: -%c\n",opt);
-			break;
-		}
-	}
-
-	sprintf(fpath, RPMSG_BUS_SYS "/devices/%s", rpmsg_dev);
-	if (access(fpath, F_OK)) {
-		fprintf(stderr, "access(%s): %s\n", fpath, strerror(errno));
-		return -EINVAL;
-	}
-	ret = bind_rpmsg_chrdev(rpmsg_dev);
-	if (ret < 0)
-		return ret;
-
-	/* kernel >= 6.0 has new path for rpmsg_ctrl device */
-	charfd = get_rpmsg_chrdev_fd(rpmsg_ctrl_dev_name, rpmsg_char_name);
-	if (charfd < 0) {
-		/* may be kernel is < 6.0 try previous path */
-		charfd = get_rpmsg_chrdev_fd(rpmsg_dev, rpmsg_char_name);
-		if (charfd < 0)
-			return charfd;
-	}
-
-	ret = app_rpmsg_create_ept(charfd, &eptinfo);
-	if (ret) {
-		fprintf(stderr, "app_rpmsg_create_ept %s\n", strerror(errno));
-		return -EINVAL;
-	}
-	if (!get_rpmsg_ept_dev_name(rpmsg_char_name, eptinfo.name,
-				    ept_dev_name))
-		return -EINVAL;
-	sprintf(ept_dev_path, "/dev/%s", ept_dev_name);
-
-	printf("open %s\n", ept_dev_path);
-	fd = open(ept_dev_path, O_RDWR | O_NONBLOCK);
-	if (fd < 0) {
-		perror(ept_dev_path);
-		close(charfd);
-		return -1;
-	}
-
-	i_payload = (struct _payload *)malloc(2 * sizeof(unsigned long) + PAYLOAD_MAX_SIZE);
-	r_payload = (struct _payload *)malloc(2 * sizeof(unsigned long) + PAYLOAD_MAX_SIZE);
-
-	if (i_payload == 0 || r_payload == 0) {
-		printf("ERROR: Failed to allocate memory for payload.\n");
-		return -1;
-	}
 
 	for (j=0; j < ntimes; j++){
 		printf("\r\n **********************************");
@@ -300,10 +185,10 @@ int main(int argc, char *argv[])
 
 			printf("\r\n sending payload number");
 			printf(" %lu of size %lu\r\n", i_payload->num,
-			(2 * sizeof(unsigned long)) + size);
+			PAYLOAD_HDR_SIZE + size);
 
 			bytes_sent = write(fd, i_payload,
-			(2 * sizeof(unsigned long)) + size);
+			PAYLOAD_HDR_SIZE + size);
 
 			if (bytes_sent <= 0) {
 				printf("\r\n Error sending data");
@@ -313,12 +198,12 @@ int main(int argc, char *argv[])
 			printf("echo test: sent : %d\n", bytes_sent);
 
 			r_payload->num = 0;
-			bytes_rcvd = read(fd, r_payload,
-					(2 * sizeof(unsigned long)) + PAYLOAD_MAX_SIZE);
-			while (bytes_rcvd <= 0) {
-				usleep(10000);
-				bytes_rcvd = read(fd, r_payload,
-					(2 * sizeof(unsigned long)) + PAYLOAD_MAX_SIZE);
+			bytes_rcvd = recv_payload(fd, r_payload, -1);
+			if (bytes_rcvd < 0) {
+				printf("\r\n Error receiving data: %s\r\n",
+				strerror(-bytes_rcvd));
+				err_cnt++;
+				break;
 			}
 			printf(" received payload number ");
 			printf("%ld of size %d\r\n", r_payload->num, bytes_rcvd);
@@ -326,7 +211,7 @@ int main(int argc, char *argv[])
 			/* Validate data buffer integrity. */
 			for (k = 0; k < r_payload->size; k++) {
 
-				if (r_payload->data[k] != 0xA5) {
+				if ((unsigned char)r_payload->data[k] != 0xA5) {
 					printf(" \r\n Data corruption");
 					printf(" at index %d \r\n", k);
 					err_cnt++;
@@ -343,11 +228,1159 @@ int main(int argc, char *argv[])
 		printf("****\r\n");
 	}
 
+	return err_cnt;
+}
+
+/*
+ * Time 'count' round trips of 'size' byte payloads, after a short warm-up.
+ * Nothing is printed in the timed loop; an echo with the wrong sequence
+ * number or length counts as an error.
+ */
+static int bench_latency(int fd, int size, int count, struct rpmsg_stats *stats,
+			 uint64_t *elapsed_ns, unsigned long *errors)
+{
+	int len = PAYLOAD_HDR_SIZE + size;
+	uint64_t start = 0, t0;
+	int n, bytes_rcvd;
+
+	i_payload->size = size;
+	memset(&(i_payload->data[0]), 0xA5, size);
+	rpmsg_stats_reset(stats);
+	*errors = 0;
+
+	for (n = -BENCH_WARMUP; n < count; n++) {
+		if (n == 0)
+			start = rpmsg_now_ns();
+
+		i_payload->num = (unsigned long)n;
+		t0 = rpmsg_now_ns();
+		if (write(fd, i_payload, len) != len) {
+			perror("write");
+			return -errno;
+		}
+		bytes_rcvd = recv_payload(fd, r_payload, RECV_TIMEOUT_MS);
+		if (bytes_rcvd < 0) {
+			fprintf(stderr, "read: %s\n", strerror(-bytes_rcvd));
+			return bytes_rcvd;
+		}
+		if (n >= 0)
+			rpmsg_stats_add(stats, rpmsg_now_ns() - t0);
+
+		if (bytes_rcvd != len || r_payload->num != i_payload->num)
+			(*errors)++;
+	}
+
+	*elapsed_ns = rpmsg_now_ns() - start;
+	return 0;
+}
+
+/*
+ * Keep up to 'window' messages in flight. Each message carries its sequence
+ * number in 'num', so an echo is matched to its send time. The remote side
+ * echoes in order: a gap in the sequence counts the skipped messages as
+ * lost, as does an echo that does not arrive within RECV_TIMEOUT_MS.
+ *
+ * With 'check' set every message carries a CRC32C after the payload and
+ * the echoes go through the sequence tracker, which tells loss, duplicates
+ * and reordering apart. Otherwise an unexpected echo only counts as an error.
+ */
+static int bench_window(int fd, int size, int count, int window,
+			struct rpmsg_stats *stats, uint64_t *elapsed_ns,
+			unsigned long *lost, unsigned long *errors,
+			struct rpmsg_seq *check)
+{
+	int len = PAYLOAD_HDR_SIZE + size + (check ? RPMSG_CRC_SIZE : 0);
+	unsigned long sent = 0, done = 0, seq;
+	uint64_t *sent_ns, start;
+	enum rpmsg_seq_result res;
+	int bytes, ret = 0;
+	uint32_t crc;
+
+	sent_ns = calloc(window, sizeof(*sent_ns));
+	if (!sent_ns)
+		return -ENOMEM;
+
+	i_payload->size = size;
+	memset(&(i_payload->data[0]), 0xA5, size);
+	rpmsg_stats_reset(stats);
+	*lost = *errors = 0;
+	if (check)
+		rpmsg_seq_reset(check);
+
+	start = rpmsg_now_ns();
+	while (done < count) {
+		while (sent < count && sent - done < window) {
+			i_payload->num = sent;
+			if (check) {
+				crc = rpmsg_crc32c(0, i_payload, PAYLOAD_HDR_SIZE + size);
+				memcpy(&i_payload->data[size], &crc, sizeof(crc));
+			}
+			sent_ns[sent % window] = rpmsg_now_ns();
+			bytes = write(fd, i_payload, len);
+			/* no free transmit buffer, collect echoes first */
+			if (bytes < 0 && (errno == EAGAIN || errno == ENOMEM))
+				break;
+			if (bytes != len) {
+				perror("write");
+				ret = -errno;
+				goto out;
+			}
+			sent++;
+		}
+
+		bytes = recv_payload(fd, r_payload, RECV_TIMEOUT_MS);
+		if (bytes == -ETIMEDOUT) {
+			if (check)
+				rpmsg_seq_skip(check, sent);
+			*lost += sent - done;
+			done = sent;
+			continue;
+		}
+		if (bytes < 0) {
+			fprintf(stderr, "read: %s\n", strerror(-bytes));
+			ret = bytes;
+			goto out;
+		}
+
+		seq = r_payload->num;
+		if (check) {
+			if (bytes == len)
+				memcpy(&crc, &r_payload->data[size], sizeof(crc));
+			if (bytes != len || seq >= sent ||
+			    crc != rpmsg_crc32c(0, r_payload, PAYLOAD_HDR_SIZE + size)) {
+				check->corrupt++;
+				continue;
+			}
+			res = rpmsg_seq_rx(check, seq);
+			/* a late echo's send time may be overwritten already */
+			if ((res == RPMSG_SEQ_NEW || res == RPMSG_SEQ_REORDERED) &&
+			    sent - seq <= window)
+				rpmsg_stats_add(stats, rpmsg_now_ns() -
+						sent_ns[seq % window]);
+			done = check->next;
+			continue;
+		}
+
+		if (bytes != len || seq < done || seq >= sent) {
+			(*errors)++;
+			continue;
+		}
+		rpmsg_stats_add(stats, rpmsg_now_ns() - sent_ns[seq % window]);
+		*lost += seq - done;
+		done = seq + 1;
+	}
+	*elapsed_ns = rpmsg_now_ns() - start;
+	if (check) {
+		*lost = check->missing;
+		*errors = check->duplicates + check->late + check->corrupt;
+	}
+
+out:
+	free(sent_ns);
+	return ret;
+}
+
+/*
+ * Move 'len' bytes through the endpoint the only way plain RPMsg can, in
+ * PAYLOAD_MAX_SIZE chunks, with up to BULK_WINDOW chunks in flight.
+ */
+static int bulk_rpmsg(int fd, const uint8_t *src, size_t len)
+{
+	size_t chunks = (len + PAYLOAD_MAX_SIZE - 1) / PAYLOAD_MAX_SIZE;
+	size_t sent = 0, done = 0, n;
+	int bytes;
+
+	while (done < chunks) {
+		while (sent < chunks && sent - done < BULK_WINDOW) {
+			n = len - sent * PAYLOAD_MAX_SIZE;
+			if (n > PAYLOAD_MAX_SIZE)
+				n = PAYLOAD_MAX_SIZE;
+			i_payload->num = sent;
+			i_payload->size = n;
+			memcpy(&(i_payload->data[0]), src + sent * PAYLOAD_MAX_SIZE, n);
+			bytes = write(fd, i_payload, PAYLOAD_HDR_SIZE + n);
+			if (bytes < 0 && (errno == EAGAIN || errno == ENOMEM))
+				break;
+			if (bytes < 0)
+				return -errno;
+			sent++;
+		}
+
+		bytes = recv_payload(fd, r_payload, RECV_TIMEOUT_MS);
+		if (bytes < 0)
+			return bytes;
+		done++;
+	}
+
+	return 0;
+}
+
+/*
+ * Move 'len' bytes by copying them into the shared region and sending a
+ * single descriptor. The demo firmware echoes the descriptor, which stands
+ * in for the remote side releasing the buffer.
+ */
+static int bulk_shm(int fd, struct rpmsg_shm *shm, const uint8_t *src, size_t len)
+{
+	struct rpmsg_shm_desc desc;
+	volatile void *dst;
+	int bytes, ret;
+
+	dst = rpmsg_shm_alloc(shm, len, &desc);
+	if (!dst)
+		return -ENOSPC;
+	rpmsg_shm_copy_in(dst, src, len);
+
+	ret = rpmsg_shm_send(fd, &desc);
+	if (ret)
+		return ret;
+
+	bytes = recv_payload(fd, r_payload, RECV_TIMEOUT_MS);
+	if (bytes < 0)
+		return bytes;
+	return rpmsg_shm_complete(shm, r_payload, bytes);
+}
+
+static int bench_bulk(int fd, struct rpmsg_shm *shm, size_t size, int count,
+		      struct rpmsg_stats *stats, uint64_t *elapsed_ns,
+		      unsigned long *errors)
+{
+	uint64_t start, t0;
+	uint8_t *src;
+	int n, ret = 0;
+
+	src = malloc(size);
+	if (!src)
+		return -ENOMEM;
+	memset(src, 0xA5, size);
+	rpmsg_stats_reset(stats);
+	*errors = 0;
+
+	start = rpmsg_now_ns();
+	for (n = 0; n < count; n++) {
+		t0 = rpmsg_now_ns();
+		ret = shm ? bulk_shm(fd, shm, src, size) : bulk_rpmsg(fd, src, size);
+		if (ret == -ETIMEDOUT || ret == -EINVAL) {
+			(*errors)++;
+			continue;
+		}
+		if (ret) {
+			fprintf(stderr, "bulk transfer: %s\n", strerror(-ret));
+			break;
+		}
+		rpmsg_stats_add(stats, rpmsg_now_ns() - t0);
+	}
+	*elapsed_ns = rpmsg_now_ns() - start;
+
+	free(src);
+	return ret == -ETIMEDOUT || ret == -EINVAL ? 0 : ret;
+}
+
+static int run_bulk(int fd, const struct bench_config *cfg,
+		    struct rpmsg_stats *stats, struct rpmsg_report *report,
+		    unsigned long *total_errors)
+{
+	const int *sizes = cfg->size ? &cfg->size : bulk_sizes;
+	int num_sizes = cfg->size ? 1 : ARRAY_SIZE(bulk_sizes);
+	struct mem_region region;
+	struct rpmsg_summary sum;
+	struct rpmsg_shm shm;
+	char shm_label[32];
+	unsigned long errors;
+	uint64_t elapsed_ns = 0;
+	int i, ret = 0;
+
+	if (mem_region_open(&region, cfg->shm_spec))
+		return -ENODEV;
+	rpmsg_shm_init(&shm, region.ptr, region.size);
+	rpmsg_report_param(report, "region", region.name);
+	printf("shared region %s, 0x%zx bytes at 0x%llx\n", region.name,
+	       region.size, (unsigned long long)region.phys);
+	snprintf(shm_label, sizeof(shm_label), "%s+shm", cfg->label);
+
+	for (i = 0; i < num_sizes; i++) {
+		if (sizes[i] > shm.size) {
+			printf("skipping %d bytes, larger than the region\n", sizes[i]);
+			continue;
+		}
+
+		ret = bench_bulk(fd, NULL, sizes[i], cfg->count, stats,
+				 &elapsed_ns, &errors);
+		if (ret)
+			break;
+		rpmsg_stats_summarize(stats, &sum);
+		rpmsg_report_latency(report, cfg->label, sizes[i], &sum,
+				     elapsed_ns, errors);
+		*total_errors += errors;
+
+		ret = bench_bulk(fd, &shm, sizes[i], cfg->count, stats,
+				 &elapsed_ns, &errors);
+		if (ret)
+			break;
+		rpmsg_stats_summarize(stats, &sum);
+		rpmsg_report_latency(report, shm_label, sizes[i], &sum,
+				     elapsed_ns, errors);
+		*total_errors += errors;
+	}
+
+	mem_region_close(&region);
+	return ret;
+}
+
+/*
+ * Telemetry-like mix: 60% of messages are 8 to 32 bytes, 30% up to a full
+ * RPMsg payload and 10% need fragmenting.
+ */
+static size_t mixed_size(uint32_t *state)
+{
+	uint32_t r;
+
+	*state ^= *state << 13;
+	*state ^= *state >> 17;
+	*state ^= *state << 5;
+	r = *state;
+
+	if (r % 100 < 60)
+		return 8 + (r >> 8) % 25;
+	if (r % 100 < 90)
+		return 33 + (r >> 8) % (PAYLOAD_MAX_SIZE - 32);
+	return PAYLOAD_MAX_SIZE + 1 + (r >> 8) % (FRAG_MAX_MSG - PAYLOAD_MAX_SIZE);
+}
+
+struct frag_msg_hdr {
+	uint32_t seq;
+	uint32_t len;
+};
+
+/*
+ * Windowed throughput through the fragmentation layer. Every echo already
+ * received is taken before the window is refilled, and messages are queued
+ * with 'more' set while the window has room, so small ones share frames.
+ * Each message starts with its sequence number and length.
+ */
+static int bench_frag(int fd, int size, int count, int window,
+		      struct rpmsg_stats *stats, uint64_t *elapsed_ns,
+		      unsigned long *bytes, unsigned long *frames,
+		      unsigned long *lost, unsigned long *errors)
+{
+	struct frag_msg_hdr hdr;
+	struct rpmsg_frag frag;
+	unsigned long sent = 0, done = 0;
+	uint64_t *sent_ns, start, deadline = 0;
+	uint8_t *tx = NULL, *rx = NULL;
+	uint32_t rng = 0x12345678;
+	ssize_t n;
+	size_t len;
+	int more, received, ret;
+
+	ret = rpmsg_frag_init(&frag, fd, PAYLOAD_HDR_SIZE + PAYLOAD_MAX_SIZE,
+			      FRAG_MAX_MSG);
+	if (ret)
+		return ret;
+	sent_ns = calloc(window, sizeof(*sent_ns));
+	tx = malloc(FRAG_MAX_MSG);
+	rx = malloc(FRAG_MAX_MSG);
+	if (!sent_ns || !tx || !rx) {
+		ret = -ENOMEM;
+		goto out;
+	}
+	memset(tx, 0xA5, FRAG_MAX_MSG);
+	rpmsg_stats_reset(stats);
+	*bytes = *lost = *errors = 0;
+
+	start = rpmsg_now_ns();
+	while (done < count) {
+		while (sent < count && sent - done < window) {
+			len = size ? size : mixed_size(&rng);
+			hdr.seq = sent;
+			hdr.len = len;
+			memcpy(tx, &hdr, sizeof(hdr));
+			more = sent + 1 < count && sent + 1 - done < window;
+			sent_ns[sent % window] = rpmsg_now_ns();
+			ret = rpmsg_frag_send(&frag, tx, len, more);
+			if (ret) {
+				fprintf(stderr, "send: %s\n", strerror(-ret));
+				goto out;
+			}
+			sent++;
+			*bytes += len;
+		}
+
+		/* take every echo already queued, so the refill is batched */
+		received = 0;
+		while ((n = rpmsg_frag_recv(&frag, rx, FRAG_MAX_MSG)) != -EAGAIN) {
+			received = 1;
+			if (n < 0 && n != -EMSGSIZE) {
+				ret = n;
+				goto out;
+			}
+
+			if (n >= (ssize_t)sizeof(hdr))
+				memcpy(&hdr, rx, sizeof(hdr));
+			if (n < (ssize_t)sizeof(hdr) || hdr.len != n ||
+			    hdr.seq < done || hdr.seq >= sent) {
+				(*errors)++;
+				continue;
+			}
+			rpmsg_stats_add(stats, rpmsg_now_ns() - sent_ns[hdr.seq % window]);
+			*lost += hdr.seq - done;
+			done = hdr.seq + 1;
+		}
+		if (received) {
+			deadline = 0;
+			continue;
+		}
+
+		ret = wait_readable(fd, &deadline, RECV_TIMEOUT_MS);
+		if (ret == -ETIMEDOUT) {
+			*lost += sent - done;
+			done = sent;
+			deadline = 0;
+		} else if (ret) {
+			goto out;
+		}
+	}
+	*elapsed_ns = rpmsg_now_ns() - start;
+	*frames = frag.frames_sent;
+	*errors += frag.rx_errors;
+	ret = 0;
+
+out:
+	free(rx);
+	free(tx);
+	free(sent_ns);
+	rpmsg_frag_free(&frag);
+	return ret;
+}
+
+static int run_frag(int fd, const struct bench_config *cfg,
+		    struct rpmsg_stats *stats, struct rpmsg_report *report,
+		    unsigned long *total_errors)
+{
+	const int *sizes = cfg->size ? &cfg->size : frag_sizes;
+	int num_sizes = cfg->size ? 1 : ARRAY_SIZE(frag_sizes);
+	int window = cfg->window ? cfg->window : FRAG_WINDOW;
+	unsigned long bytes, frames[ARRAY_SIZE(frag_sizes)];
+	unsigned long lost, errors;
+	struct rpmsg_summary sum;
+	uint64_t elapsed_ns = 0;
+	char label[32];
+	int i, ret = 0;
+
+	for (i = 0; i < num_sizes; i++) {
+		ret = bench_frag(fd, sizes[i], cfg->count, window, stats,
+				 &elapsed_ns, &bytes, &frames[i], &lost, &errors);
+		if (ret)
+			return ret;
+
+		/* the mixed run reports its mean message size */
+		snprintf(label, sizeof(label), "%s+%s", cfg->label,
+			 sizes[i] ? "frag" : "mix");
+		rpmsg_stats_summarize(stats, &sum);
+		rpmsg_report_throughput(report, label, window,
+					bytes / cfg->count, &sum, elapsed_ns,
+					lost, errors);
+		*total_errors += lost + errors;
+	}
+
+	printf("\n");
+	for (i = 0; i < num_sizes; i++)
+		printf("%s: %d messages in %lu frames\n",
+		       sizes[i] ? "fixed size" : "mixed sizes", cfg->count, frames[i]);
+
+	return 0;
+}
+
+/* Sum of the counts on every /proc/interrupts line naming 'name', or -1 */
+static long long read_irq_count(const char *name)
+{
+	char line[1024], *p, *end;
+	long long total = -1, count;
+	FILE *fp;
+
+	fp = fopen("/proc/interrupts", "r");
+	if (!fp)
+		return -1;
+	while (fgets(line, sizeof(line), fp)) {
+		if (!strstr(line, name) || !(p = strchr(line, ':')))
+			continue;
+		if (total < 0)
+			total = 0;
+		for (p++; ; p = end) {
+			count = strtoll(p, &end, 10);
+			if (end == p)
+				break;
+			total += count;
+		}
+	}
+	fclose(fp);
+	return total;
+}
+
+struct coalesce_msg {
+	uint32_t seq;
+	uint32_t len;
+	uint64_t created_ns;
+};
+
+/*
+ * Produce 'count' messages of 16 to 32 bytes at 'rate' per second through a
+ * coalescing writer, and time each one from its creation to its echo.
+ */
+static int bench_coalesce(int fd, int count, int rate, int deadline_us,
+			  struct rpmsg_stats *stats, unsigned long *frames,
+			  unsigned long *lost, unsigned long *errors)
+{
+	struct pollfd pfd = { .fd = fd, .events = POLLIN };
+	uint64_t period = 1000000000ULL / rate;
+	uint64_t now, next, last_rx, wait;
+	struct rpmsg_coalesce co;
+	struct rpmsg_frag frag;
+	struct coalesce_msg msg;
+	struct timespec ts;
+	uint8_t tx[32], rx[FRAG_MAX_MSG];
+	unsigned long sent = 0, done = 0;
+	int64_t due;
+	ssize_t n;
+	int ret;
+
+	ret = rpmsg_frag_init(&frag, fd, PAYLOAD_HDR_SIZE + PAYLOAD_MAX_SIZE,
+			      FRAG_MAX_MSG);
+	if (ret)
+		return ret;
+	rpmsg_coalesce_init(&co, &frag, deadline_us);
+	rpmsg_stats_reset(stats);
+	memset(tx, 0xA5, sizeof(tx));
+	*lost = *errors = 0;
+
+	next = last_rx = rpmsg_now_ns();
+	while (done < count) {
+		now = rpmsg_now_ns();
+		if (sent < count && now >= next) {
+			msg.seq = sent;
+			msg.len = sizeof(msg) + sent % (sizeof(tx) - sizeof(msg) + 1);
+			msg.created_ns = now;
+			memcpy(tx, &msg, sizeof(msg));
+			ret = rpmsg_coalesce_write(&co, tx, msg.len);
+			if (ret)
+				break;
+			sent++;
+			next += period;
+			if (sent == count)
+				ret = rpmsg_coalesce_flush(&co);
+		} else {
+			ret = rpmsg_coalesce_poll(&co);
+		}
+		if (ret)
+			break;
+
+		while ((n = rpmsg_frag_recv(&frag, rx, sizeof(rx))) != -EAGAIN) {
+			if (n < 0 && n != -EMSGSIZE) {
+				ret = n;
+				goto out;
+			}
+			if (n < (ssize_t)sizeof(msg)) {
+				(*errors)++;
+				continue;
+			}
+			memcpy(&msg, rx, sizeof(msg));
+			if (msg.len != n || msg.seq < done || msg.seq >= sent) {
+				(*errors)++;
+				continue;
+			}
+			last_rx = rpmsg_now_ns();
+			rpmsg_stats_add(stats, last_rx - msg.created_ns);
+			*lost += msg.seq - done;
+			done = msg.seq + 1;
+		}
+
+		now = rpmsg_now_ns();
+		if (sent == count && now - last_rx > RECV_TIMEOUT_MS * 1000000ULL) {
+			*lost += sent - done;
+			break;
+		}
+		if (wait_mode == WAIT_BUSY)
+			continue;
+
+		/* sleep until the next message, frame deadline or echo */
+		wait = sent < count ? (next > now ? next - now : 0) :
+				      RECV_TIMEOUT_MS * 1000000ULL;
+		due = rpmsg_coalesce_remaining_ns(&co);
+		if (due >= 0 && due < wait)
+			wait = due;
+		ts.tv_sec = wait / 1000000000ULL;
+		ts.tv_nsec = wait % 1000000000ULL;
+		if (ppoll(&pfd, 1, &ts, NULL) < 0 && errno != EINTR) {
+			ret = -errno;
+			break;
+		}
+	}
+
+out:
+	*frames = frag.frames_sent;
+	*errors += frag.rx_errors;
+	rpmsg_frag_free(&frag);
+	return ret;
+}
+
+static int run_coalesce(int fd, const struct bench_config *cfg,
+			struct rpmsg_stats *stats, struct rpmsg_report *report,
+			unsigned long *total_errors)
+{
+	const int *deadlines = cfg->deadline_us >= 0 ? &cfg->deadline_us :
+						       coalesce_deadlines;
+	int num_deadlines = cfg->deadline_us >= 0 ? 1 : ARRAY_SIZE(coalesce_deadlines);
+	unsigned long frames, lost, errors;
+	long long irqs_before, irqs_after;
+	struct rpmsg_summary sum;
+	char rate[16];
+	int i, ret;
+
+	snprintf(rate, sizeof(rate), "%d", cfg->rate);
+	rpmsg_report_param(report, "rate", rate);
+	printf("%d messages of 16 to 32 bytes at %d per second\n",
+	       cfg->count, cfg->rate);
+	if (read_irq_count(cfg->irq_name) < 0)
+		printf("no \"%s\" interrupt in /proc/interrupts, counting frames only\n",
+		       cfg->irq_name);
+
+	for (i = 0; i < num_deadlines; i++) {
+		irqs_before = read_irq_count(cfg->irq_name);
+		ret = bench_coalesce(fd, cfg->count, cfg->rate, deadlines[i],
+				     stats, &frames, &lost, &errors);
+		irqs_after = read_irq_count(cfg->irq_name);
+		if (ret)
+			return ret;
+
+		rpmsg_stats_summarize(stats, &sum);
+		rpmsg_report_coalesce(report, cfg->label, deadlines[i], cfg->count,
+				      frames, irqs_before < 0 ? -1 : irqs_after - irqs_before,
+				      &sum, lost, errors);
+		*total_errors += lost + errors;
+	}
+
+	return 0;
+}
+
+static int alloc_payloads(void)
+{
+	/* room for a CRC after the largest payload when validating */
+	i_payload = malloc(MAX_RPMSG_BUFF_SIZE);
+	r_payload = malloc(MAX_RPMSG_BUFF_SIZE);
+	return i_payload && r_payload ? 0 : -ENOMEM;
+}
+
+static void free_payloads(void)
+{
 	free(i_payload);
 	free(r_payload);
+}
+
+/* One thread per endpoint, all started together for each run */
+struct ept_worker {
+	pthread_t thread;
+	pthread_mutex_t *gate;		/* held while the run is set up */
+	const int *aborted;		/* not every worker could be started */
+	pthread_barrier_t *start;
+	const struct bench_config *cfg;
+	int fd;
+	const char *name;
+	int size;
+	int window;
+	struct rpmsg_stats stats;
+	uint64_t elapsed_ns;
+	unsigned long lost;
+	unsigned long errors;
+	struct rpmsg_seq seq;
+	int ret;
+};
+
+static void *ept_worker_run(void *arg)
+{
+	struct ept_worker *w = arg;
+
+	w->ret = alloc_payloads();
+	pthread_mutex_lock(w->gate);
+	pthread_mutex_unlock(w->gate);
+	if (*w->aborted)
+		goto out;
+	pthread_barrier_wait(w->start);
+	if (w->ret)
+		goto out;
+
+	w->lost = 0;
+	if (w->cfg->mode == BENCH_LATENCY)
+		w->ret = bench_latency(w->fd, w->size, w->cfg->count, &w->stats,
+				       &w->elapsed_ns, &w->errors);
+	else
+		w->ret = bench_window(w->fd, w->size, w->cfg->count, w->window,
+				      &w->stats, &w->elapsed_ns, &w->lost,
+				      &w->errors, w->cfg->validate ? &w->seq : NULL);
+out:
+	free_payloads();
+	return NULL;
+}
+
+static void report_run(struct rpmsg_report *report, const struct bench_config *cfg,
+		       const char *label, int size, int window,
+		       struct rpmsg_stats *stats, uint64_t elapsed_ns,
+		       unsigned long lost, unsigned long errors,
+		       const struct rpmsg_seq *seq)
+{
+	struct rpmsg_summary sum;
+
+	rpmsg_stats_summarize(stats, &sum);
+	if (cfg->mode == BENCH_LATENCY)
+		rpmsg_report_latency(report, label, size, &sum, elapsed_ns, errors);
+	else if (cfg->validate)
+		rpmsg_report_validate(report, label, window, size, &sum,
+				      elapsed_ns, seq);
+	else
+		rpmsg_report_throughput(report, label, window, size, &sum,
+					elapsed_ns, lost, errors);
+}
+
+/*
+ * Run the latency or throughput benchmark on every endpoint at once. Each
+ * endpoint gets a row and, with several endpoints, an "all" row merges the
+ * samples of every endpoint over the longest run, giving the aggregate rate.
+ */
+static int run_multi(const int *fds, char names[][16], int num_epts,
+		     const struct bench_config *cfg, struct rpmsg_report *report,
+		     unsigned long *total_errors)
+{
+	const int *sizes = cfg->size ? &cfg->size : bench_sizes;
+	const int *windows = cfg->window ? &cfg->window : bench_windows;
+	int num_sizes = cfg->size ? 1 : ARRAY_SIZE(bench_sizes);
+	int num_windows = cfg->window && cfg->mode == BENCH_THROUGHPUT ? 1 :
+			  ARRAY_SIZE(bench_windows);
+	struct ept_worker workers[MAX_ENDPOINTS];
+	struct rpmsg_stats all;
+	struct rpmsg_seq all_seq;
+	pthread_mutex_t gate = PTHREAD_MUTEX_INITIALIZER;
+	pthread_barrier_t start;
+	unsigned long lost, errors;
+	uint64_t elapsed_ns;
+	int i, w, k, j, started, aborted, ret = 0;
+
+	if (cfg->mode == BENCH_LATENCY)
+		num_windows = 1;
+	if (rpmsg_stats_init(&all, (size_t)cfg->count * num_epts))
+		return -ENOMEM;
+	memset(workers, 0, sizeof(workers));
+	for (k = 0; k < num_epts; k++) {
+		if (rpmsg_stats_init(&workers[k].stats, cfg->count)) {
+			ret = -ENOMEM;
+			goto out;
+		}
+	}
+
+	for (i = 0; i < num_sizes && !ret; i++) {
+		for (w = 0; w < num_windows && !ret; w++) {
+			/*
+			 * The workers wait at the gate until the barrier is set up
+			 * for the threads actually started. If any could not be
+			 * started the run is aborted.
+			 */
+			pthread_mutex_lock(&gate);
+			for (started = 0; started < num_epts; started++) {
+				workers[started].gate = &gate;
+				workers[started].aborted = &aborted;
+				workers[started].start = &start;
+				workers[started].cfg = cfg;
+				workers[started].fd = fds[started];
+				workers[started].name = names[started];
+				workers[started].size = sizes[i];
+				workers[started].window = windows[w];
+				ret = -pthread_create(&workers[started].thread, NULL,
+						      ept_worker_run, &workers[started]);
+				if (ret) {
+					fprintf(stderr, "cannot start a thread for %s: %s\n",
+						names[started], strerror(-ret));
+					break;
+				}
+			}
+			aborted = started < num_epts;
+			if (started)
+				pthread_barrier_init(&start, NULL, started);
+			pthread_mutex_unlock(&gate);
+
+			rpmsg_stats_reset(&all);
+			rpmsg_seq_reset(&all_seq);
+			elapsed_ns = 0;
+			lost = errors = 0;
+			for (k = 0; k < started; k++) {
+				pthread_join(workers[k].thread, NULL);
+				if (workers[k].ret && !ret)
+					ret = workers[k].ret;
+				for (j = 0; j < workers[k].stats.count; j++)
+					rpmsg_stats_add(&all, workers[k].stats.samples[j]);
+				if (workers[k].elapsed_ns > elapsed_ns)
+					elapsed_ns = workers[k].elapsed_ns;
+				lost += workers[k].lost;
+				errors += workers[k].errors;
+				rpmsg_seq_merge(&all_seq, &workers[k].seq);
+			}
+			if (started)
+				pthread_barrier_destroy(&start);
+			if (ret)
+				break;
+
+			for (k = 0; k < num_epts; k++)
+				report_run(report, cfg, workers[k].name, sizes[i],
+					   windows[w], &workers[k].stats,
+					   workers[k].elapsed_ns, workers[k].lost,
+					   workers[k].errors, &workers[k].seq);
+			if (num_epts > 1)
+				report_run(report, cfg, "all", sizes[i], windows[w],
+					   &all, elapsed_ns, lost, errors, &all_seq);
+			*total_errors += lost + errors;
+		}
+	}
+
+out:
+	for (k = 0; k < num_epts; k++)
+		rpmsg_stats_free(&workers[k].stats);
+	rpmsg_stats_free(&all);
+	return ret;
+}
+
+/*
+ * Check the CRC32C against the standard check value and time it over a
+ * megabyte, to show the check keeps up with the transport.
+ */
+static int crc32c_check(struct rpmsg_report *report)
+{
+	const size_t len = 1 << 20;
+	uint64_t start, ns;
+	volatile uint32_t crc;
+	char rate[16];
+	uint8_t *buf;
+
+	if (rpmsg_crc32c_selftest()) {
+		fprintf(stderr, "crc32c: wrong check value\n");
+		return -EINVAL;
+	}
+	buf = malloc(len);
+	if (!buf)
+		return -ENOMEM;
+	memset(buf, 0xA5, len);
+
+	start = rpmsg_now_ns();
+	crc = rpmsg_crc32c(0, buf, len);
+	ns = rpmsg_now_ns() - start;
+	free(buf);
+	(void)crc;
 
-	close(fd);
-	if (charfd >= 0)
-		close(charfd);
+	snprintf(rate, sizeof(rate), "%.0f", ns ? len * 1e3 / ns : 0);
+	printf("crc32c: %s MB/s\n", rate);
+	rpmsg_report_param(report, "crc32c_mb_s", rate);
 	return 0;
 }
+
+static int run_benchmark(const int *fds, char names[][16], int num_epts,
+			 const struct bench_config *cfg)
+{
+	static const char * const mode_names[] = {
+		"", "latency", "throughput", "bulk", "frag", "coalesce"
+	};
+	struct rpmsg_report report;
+	struct rpmsg_stats stats;
+	unsigned long total_errors = 0;
+	char epts[8];
+	int ret = 0;
+
+	if (rpmsg_stats_init(&stats, cfg->count))
+		return -ENOMEM;
+	if (rpmsg_report_begin(&report, cfg->json_path, mode_names[cfg->mode])) {
+		rpmsg_stats_free(&stats);
+		return -EINVAL;
+	}
+	rpmsg_report_param(&report, "wait", wait_names[wait_mode]);
+	snprintf(epts, sizeof(epts), "%d", num_epts);
+	rpmsg_report_param(&report, "endpoints", epts);
+	printf("waiting for echoes with %s\n", wait_names[wait_mode]);
+	if (cfg->validate) {
+		ret = crc32c_check(&report);
+		if (ret)
+			goto out;
+	}
+
+	if (cfg->mode == BENCH_BULK)
+		ret = run_bulk(fds[0], cfg, &stats, &report, &total_errors);
+	else if (cfg->mode == BENCH_FRAG)
+		ret = run_frag(fds[0], cfg, &stats, &report, &total_errors);
+	else if (cfg->mode == BENCH_COALESCE)
+		ret = run_coalesce(fds[0], cfg, &stats, &report, &total_errors);
+	else
+		ret = run_multi(fds, names, num_epts, cfg, &report, &total_errors);
+
+out:
+	rpmsg_report_end(&report);
+	rpmsg_stats_free(&stats);
+	return ret ? ret : (total_errors ? -EIO : 0);
+}
+
+/*
+ * Open 'num_epts' endpoints on the channel. Extra endpoints get their own
+ * source address, the remote echoes to it.
+ */
+static int open_epts(struct rpmsg_ept *epts, int num_epts, const char *rpmsg_dev,
+		     const char *cache_path, int verbose, int *fds, char names[][16])
+{
+	struct rpmsg_ctx ctx;
+	uint64_t start;
+	int k, ret;
+
+	start = rpmsg_now_ns();
+	ret = rpmsg_ctx_open(&ctx, rpmsg_dev, EPT_NAME, DEFAULT_CHANNEL,
+			     cache_path, verbose);
+	if (ret)
+		return ret;
+	if (verbose)
+		printf("channel %s, %s%s\n", ctx.channel, ctx.ctrl_name,
+		       ctx.cached ? " (cached)" : "");
+
+	for (k = 0; k < num_epts; k++) {
+		ret = rpmsg_ept_open(&ctx, EPT_NAME, k ? EPT_SRC_BASE + k : 0,
+				     &epts[k]);
+		if (ret) {
+			while (k--)
+				rpmsg_ept_close(&epts[k]);
+			break;
+		}
+		fds[k] = epts[k].fd;
+		snprintf(names[k], sizeof(names[k]), "%s", epts[k].dev_name);
+		printf("endpoint %s (%s) in %.1f ms\n", epts[k].dev_name,
+		       rpmsg_ept_origin_name(epts[k].origin),
+		       (rpmsg_now_ns() - start) / 1e6);
+	}
+
+	/* only creating endpoints needs the control device */
+	rpmsg_ctx_close(&ctx);
+	return ret;
+}
+
+/* Stand-ins echoing from a thread, for running without a remote core */
+static int open_loopbacks(struct rpmsg_loopback *loops, int num_epts,
+			  int delay_us, int *fds, char names[][16])
+{
+	int k, ret;
+
+	for (k = 0; k < num_epts; k++) {
+		ret = rpmsg_loopback_open(&loops[k], delay_us);
+		if (ret) {
+			fprintf(stderr, "loopback: %s\n", strerror(-ret));
+			while (k--)
+				rpmsg_loopback_close(&loops[k]);
+			return ret;
+		}
+		fds[k] = loops[k].fd;
+		snprintf(names[k], sizeof(names[k]), "loop%d", k);
+	}
+	printf("%d loopback endpoint%s, echo delay %d us\n", num_epts,
+	       num_epts > 1 ? "s" : "", delay_us);
+
+	return 0;
+}
+
+static void usage(const char *prog)
+{
+	printf("usage: %s [-d rpmsg_dev | -L delay] [-x cache] [-v] [-n rounds]\n"
+	       "\t[-k endpoints] [-w wait] [-b | -t [-V] | -f | -C | -z region]\n"
+	       "\t[-W window] [-D deadline] [-R rate] [-I irq] [-c count] [-s size]\n"
+	       "\t[-j file]\n",
+	       prog);
+	printf("\t-d rpmsg_dev  rpmsg channel device\n");
+	printf("\t-x cache      endpoint cache file, none to disable (default %s)\n",
+	       RPMSG_EPT_DEFAULT_CACHE);
+	printf("\t-v            print the endpoint setup steps\n");
+	printf("\t-L delay      use a local loopback instead of the remote core,\n"
+	       "\t              echoing each message after delay us\n");
+	printf("\t-n rounds     echo test rounds (default 1)\n");
+	printf("\t-k endpoints  run -b or -t on this many endpoints at once, one\n"
+	       "\t              thread each (default 1, up to %d)\n", MAX_ENDPOINTS);
+	printf("\t-w wait       poll (default), busy or sleep (10 ms usleep loop)\n");
+	printf("\t-b            benchmark round trip time instead of the echo test\n");
+	printf("\t-t            benchmark throughput with several messages in flight\n");
+	printf("\t-V            with -t, check a CRC32C and sequence number on every\n"
+	       "\t              echo and count lost, duplicate and reordered messages\n");
+	printf("\t-W window     messages in flight for -t (default 1 to 32) or -f\n"
+	       "\t              (default %d)\n", FRAG_WINDOW);
+	printf("\t-f            benchmark throughput of fragmented and batched\n"
+	       "\t              messages, including a mix of sizes\n");
+	printf("\t-C            benchmark the coalescing writer with paced small\n"
+	       "\t              messages\n");
+	printf("\t-z region     compare bulk transfers through the shared region with\n"
+	       "\t              plain RPMsg; udmabuf:<device> or mem:<phys>:<size>\n");
+	printf("\t-D deadline   coalescing deadline in us for -C (default 0 to 1000)\n");
+	printf("\t-R rate       messages per second for -C (default %d)\n",
+	       COALESCE_DEFAULT_RATE);
+	printf("\t-I irq        /proc/interrupts name to count for -C (default %s)\n",
+	       COALESCE_DEFAULT_IRQ);
+	printf("\t-c count      messages per payload size and window (default %d,\n"
+	       "\t              %d transfers for -z)\n",
+	       BENCH_DEFAULT_COUNT, BULK_DEFAULT_COUNT);
+	printf("\t-s size       benchmark only payloads of size bytes (%d-%d, up to\n"
+	       "\t              %d for -f, any size for -z)\n", PAYLOAD_MIN_SIZE,
+	       PAYLOAD_MAX_SIZE, FRAG_MAX_MSG);
+	printf("\t-j file       also write the benchmark results to file as JSON\n");
+}
+
+int main(int argc, char *argv[])
+{
+	int ret;
+	int opt, fd;
+	int ntimes = 1;
+	int wait, k;
+	int num_epts = 1;
+	int verbose = 0;
+	int loopback_us = -1;
+	int fds[MAX_ENDPOINTS];
+	struct bench_config bench = {
+		.deadline_us = -1,
+		.rate = COALESCE_DEFAULT_RATE,
+		.irq_name = COALESCE_DEFAULT_IRQ,
+	};
+	const char *rpmsg_dev = NULL;
+	const char *cache_path = RPMSG_EPT_DEFAULT_CACHE;
+	struct rpmsg_ept epts[MAX_ENDPOINTS];
+	struct rpmsg_loopback loops[MAX_ENDPOINTS];
+	char ept_dev_names[MAX_ENDPOINTS][16];
+
+	printf("\r\n Echo test start \r\n");
+
+	while ((opt = getopt(argc, argv, "d:x:vL:n:w:k:btVfCz:W:D:R:I:c:s:j:h")) != -1) {
+		switch (opt) {
+		case 'd':
+			rpmsg_dev = optarg;
+			break;
+		case 'x':
+			cache_path = strcmp(optarg, "none") ? optarg : NULL;
+			break;
+		case 'v':
+			verbose = 1;
+			break;
+		case 'L':
+			loopback_us = atoi(optarg);
+			if (loopback_us < 0) {
+				usage(argv[0]);
+				return -EINVAL;
+			}
+			break;
+		case 'n':
+			ntimes = atoi(optarg);
+			break;
+		case 'w':
+			for (wait = 0; wait < NUM_WAIT_MODES; wait++)
+				if (!strcmp(optarg, wait_names[wait]))
+					break;
+			if (wait == NUM_WAIT_MODES) {
+				usage(argv[0]);
+				return -EINVAL;
+			}
+			wait_mode = wait;
+			break;
+		case 'k':
+			num_epts = atoi(optarg);
+			break;
+		case 'b':
+			bench.mode = BENCH_LATENCY;
+			break;
+		case 't':
+			bench.mode = BENCH_THROUGHPUT;
+			break;
+		case 'V':
+			bench.validate = 1;
+			break;
+		case 'f':
+			bench.mode = BENCH_FRAG;
+			break;
+		case 'C':
+			bench.mode = BENCH_COALESCE;
+			break;
+		case 'D':
+			bench.deadline_us = atoi(optarg);
+			break;
+		case 'R':
+			bench.rate = atoi(optarg);
+			break;
+		case 'I':
+			bench.irq_name = optarg;
+			break;
+		case 'z':
+			bench.mode = BENCH_BULK;
+			bench.shm_spec = optarg;
+			break;
+		case 'W':
+			bench.window = atoi(optarg);
+			break;
+		case 'c':
+			bench.count = atoi(optarg);
+			break;
+		case 's':
+			bench.size = atoi(optarg);
+			break;
+		case 'j':
+			bench.json_path = optarg;
+			break;
+		case 'h':
+			usage(argv[0]);
+			return 0;
+		default:
+			printf("getopt return unsupported option: -%c\n",opt);
+			break;
+		}
+	}
+
+	if (!bench.count)
+		bench.count = bench.mode == BENCH_BULK ? BULK_DEFAULT_COUNT :
+							 BENCH_DEFAULT_COUNT;
+	if (num_epts < 1 || num_epts > MAX_ENDPOINTS ||
+	    (num_epts > 1 && bench.mode != BENCH_LATENCY &&
+	     bench.mode != BENCH_THROUGHPUT) ||
+	    (bench.validate && bench.mode != BENCH_THROUGHPUT) ||
+	    bench.count < 0 || bench.size < 0 || bench.window < 0 || bench.rate <= 0 ||
+	    (bench.size > PAYLOAD_MAX_SIZE && bench.mode != BENCH_BULK &&
+	     bench.mode != BENCH_FRAG) ||
+	    (bench.mode == BENCH_FRAG && bench.size &&
+	     (bench.size < sizeof(struct frag_msg_hdr) || bench.size > FRAG_MAX_MSG))) {
+		usage(argv[0]);
+		return -EINVAL;
+	}
+
+	if (loopback_us >= 0)
+		ret = open_loopbacks(loops, num_epts, loopback_us, fds, ept_dev_names);
+	else
+		ret = open_epts(epts, num_epts, rpmsg_dev, cache_path, verbose, fds,
+				ept_dev_names);
+	if (ret)
+		return ret;
+	fd = fds[0];
+
+	if (alloc_payloads()) {
+		printf("ERROR: Failed to allocate memory for payload.\n");
+		return -1;
+	}
+
+	bench.label = ept_dev_names[0];
+	if (bench.mode != BENCH_NONE)
+		ret = run_benchmark(fds, ept_dev_names, num_epts, &bench);
+	else
+		ret = echo_test(fd, ntimes) ? -EIO : 0;
+
+	free_payloads();
+
+	for (k = 0; k < num_epts; k++) {
+		if (loopback_us < 0) {
+			rpmsg_ept_close(&epts[k]);
+			continue;
+		}
+		rpmsg_loopback_close(&loops[k]);
+		if (loops[k].oversize)
+			printf("%s: dropped %lu messages over %d bytes\n",
+			       ept_dev_names[k], loops[k].oversize,
+			       RPMSG_LOOPBACK_MAX_MSG);
+	}
+	return ret;
+}
@@ -0,0 +1,105 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Bulk transfers through shared memory, with RPMsg as the doorbell
+ *
+ * Copyright (c) 2026 Microchip Technology, Inc. All rights reserved
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "rpmsg-shm.h"
+
+void rpmsg_shm_init(struct rpmsg_shm *shm, volatile void *base, size_t size)
+{
+	shm->base = base;
+	shm->size = size & ~(size_t)(RPMSG_SHM_ALIGN - 1);
+	shm->head = 0;
+	shm->tail = 0;
+	shm->seq = 0;
+}
+
+/*
+ * Reserve 'len' bytes at the head of the ring and fill in the descriptor
+ * that hands them to the remote side. A chunk never wraps: when it does not
+ * fit before the end of the buffer the remainder is skipped. Returns NULL
+ * when the ring is too full.
+ */
+volatile void *rpmsg_shm_alloc(struct rpmsg_shm *shm, size_t len,
+			       struct rpmsg_shm_desc *desc)
+{
+	size_t alen = (len + RPMSG_SHM_ALIGN - 1) & ~(size_t)(RPMSG_SHM_ALIGN - 1);
+	size_t pos = shm->head % shm->size;
+	size_t pad = pos + alen > shm->size ? shm->size - pos : 0;
+
+	if (!len || alen > shm->size || shm->head + pad + alen - shm->tail > shm->size)
+		return NULL;
+
+	shm->head += pad;
+	pos = shm->head % shm->size;
+	shm->head += alen;
+
+	desc->magic = RPMSG_SHM_MAGIC;
+	desc->seq = shm->seq++;
+	desc->offset = pos;
+	desc->length = len;
+	desc->cookie = shm->head;
+
+	return shm->base + pos;
+}
+
+/*
+ * Fabric and uncached memory trap on misaligned accesses, which library
+ * memcpy() may issue, so copy with aligned 64 bit stores.
+ */
+void rpmsg_shm_copy_in(volatile void *dst, const void *src, size_t len)
+{
+	volatile uint64_t *d = dst;
+	const uint8_t *s = src;
+	uint64_t word;
+
+	for (; len >= sizeof(word); len -= sizeof(word), s += sizeof(word)) {
+		memcpy(&word, s, sizeof(word));
+		*d++ = word;
+	}
+	if (len) {
+		word = 0;
+		memcpy(&word, s, len);
+		*d = word;
+	}
+}
+
+/*
+ * The write() to the endpoint goes through the virtio ring, whose barriers
+ * order it after the stores to the shared buffer.
+ */
+int rpmsg_shm_send(int fd, const struct rpmsg_shm_desc *desc)
+{
+	ssize_t ret;
+
+	ret = write(fd, desc, sizeof(*desc));
+	if (ret < 0)
+		return -errno;
+	return ret == sizeof(*desc) ? 0 : -EIO;
+}
+
+/*
+ * Called with each message received from the remote side. Returns 0 when it
+ * is a descriptor coming back, in which case its chunk and every chunk
+ * before it is released, or -EINVAL.
+ */
+int rpmsg_shm_complete(struct rpmsg_shm *shm, const void *msg, size_t len)
+{
+	struct rpmsg_shm_desc desc;
+
+	if (len != sizeof(desc))
+		return -EINVAL;
+	memcpy(&desc, msg, sizeof(desc));
+	if (desc.magic != RPMSG_SHM_MAGIC ||
+	    desc.cookie <= shm->tail || desc.cookie > shm->head)
+		return -EINVAL;
+
+	shm->tail = desc.cookie;
+	return 0;
+}
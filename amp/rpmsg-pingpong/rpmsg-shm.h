@@ -0,0 +1,51 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/*
+ * Bulk transfers through shared memory, with RPMsg as the doorbell
+ *
+ * Copyright (c) 2026 Microchip Technology, Inc. All rights reserved
+ *
+ * RPMsg buffers carry at most MAX_RPMSG_BUFF_SIZE bytes, so bulk data is
+ * placed in a physically contiguous buffer shared with the remote context
+ * (a reserved memory or u-dma-buf region) and only a small descriptor is
+ * sent over the endpoint. The remote side finds the data at 'offset' from
+ * the base of the region it has been configured with, and returns the
+ * descriptor once it has finished with the data.
+ *
+ * The buffer is used as a byte ring: chunks are allocated at the head and
+ * released in order as their descriptors come back.
+ */
+
+#ifndef __RPMSG_SHM_H
+#define __RPMSG_SHM_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define RPMSG_SHM_MAGIC		0x4d485352U	/* "RSHM" */
+#define RPMSG_SHM_ALIGN		64
+
+/* Sent over the endpoint in place of the data, little endian */
+struct rpmsg_shm_desc {
+	uint32_t magic;
+	uint32_t seq;
+	uint32_t offset;	/* from the base of the shared region */
+	uint32_t length;
+	uint64_t cookie;	/* opaque to the remote, echoed back unchanged */
+};
+
+struct rpmsg_shm {
+	volatile uint8_t *base;
+	size_t size;
+	uint64_t head;		/* free running byte counters */
+	uint64_t tail;
+	uint32_t seq;
+};
+
+void rpmsg_shm_init(struct rpmsg_shm *shm, volatile void *base, size_t size);
+volatile void *rpmsg_shm_alloc(struct rpmsg_shm *shm, size_t len,
+			       struct rpmsg_shm_desc *desc);
+void rpmsg_shm_copy_in(volatile void *dst, const void *src, size_t len);
+int rpmsg_shm_send(int fd, const struct rpmsg_shm_desc *desc);
+int rpmsg_shm_complete(struct rpmsg_shm *shm, const void *msg, size_t len);
+
+#endif /* __RPMSG_SHM_H */
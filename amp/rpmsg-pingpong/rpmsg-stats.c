@@ -0,0 +1,325 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Latency and throughput statistics for the RPMsg benchmarks
+ *
+ * Copyright (c) 2026 Microchip Technology, Inc. All rights reserved
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "rpmsg-stats.h"
+
+uint64_t rpmsg_now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+int rpmsg_stats_init(struct rpmsg_stats *stats, size_t cap)
+{
+	stats->samples = malloc(cap * sizeof(*stats->samples));
+	if (!stats->samples)
+		return -ENOMEM;
+	stats->count = 0;
+	stats->cap = cap;
+	return 0;
+}
+
+void rpmsg_stats_reset(struct rpmsg_stats *stats)
+{
+	stats->count = 0;
+}
+
+/* Samples beyond the capacity are dropped */
+void rpmsg_stats_add(struct rpmsg_stats *stats, uint64_t ns)
+{
+	if (stats->count < stats->cap)
+		stats->samples[stats->count++] = ns;
+}
+
+static int compare_u64(const void *a, const void *b)
+{
+	uint64_t x = *(const uint64_t *)a;
+	uint64_t y = *(const uint64_t *)b;
+
+	return x < y ? -1 : x > y;
+}
+
+/* Nearest-rank percentile, 'permille' in 1/1000 so p99.9 is exact */
+static uint64_t percentile(const uint64_t *sorted, size_t count, unsigned int permille)
+{
+	size_t rank = (count * permille + 999) / 1000;
+
+	return sorted[rank ? rank - 1 : 0];
+}
+
+/* Sorts the samples in place */
+void rpmsg_stats_summarize(struct rpmsg_stats *stats, struct rpmsg_summary *sum)
+{
+	double total = 0;
+	size_t i;
+
+	memset(sum, 0, sizeof(*sum));
+	if (!stats->count)
+		return;
+
+	qsort(stats->samples, stats->count, sizeof(*stats->samples), compare_u64);
+	for (i = 0; i < stats->count; i++)
+		total += stats->samples[i];
+
+	sum->count = stats->count;
+	sum->min = stats->samples[0];
+	sum->p50 = percentile(stats->samples, stats->count, 500);
+	sum->p90 = percentile(stats->samples, stats->count, 900);
+	sum->p99 = percentile(stats->samples, stats->count, 990);
+	sum->p999 = percentile(stats->samples, stats->count, 999);
+	sum->max = stats->samples[stats->count - 1];
+	sum->mean = total / stats->count;
+}
+
+void rpmsg_stats_free(struct rpmsg_stats *stats)
+{
+	free(stats->samples);
+	stats->samples = NULL;
+	stats->count = stats->cap = 0;
+}
+
+/* Write 's' as a JSON string, quoted and escaped */
+static void json_string(FILE *json, const char *s)
+{
+	fputc('"', json);
+	for (; *s; s++) {
+		if (*s == '"' || *s == '\\')
+			fprintf(json, "\\%c", *s);
+		else if ((unsigned char)*s < 0x20)
+			fprintf(json, "\\u%04x", *s);
+		else
+			fputc(*s, json);
+	}
+	fputc('"', json);
+}
+
+/* 'json_path' may be NULL for no JSON output */
+int rpmsg_report_begin(struct rpmsg_report *report, const char *json_path,
+		       const char *mode)
+{
+	int err;
+
+	report->json = NULL;
+	report->entries = 0;
+
+	if (json_path) {
+		report->json = fopen(json_path, "w");
+		if (!report->json) {
+			err = errno;
+			fprintf(stderr, "open %s, %s\n", json_path, strerror(err));
+			return -err;
+		}
+		fprintf(report->json, "{\n  \"mode\": ");
+		json_string(report->json, mode);
+		fprintf(report->json, ",\n  \"clock\": \"CLOCK_MONOTONIC_RAW\"");
+	}
+
+	return 0;
+}
+
+/* Record a run parameter, before the first result */
+void rpmsg_report_param(struct rpmsg_report *report, const char *key,
+			const char *value)
+{
+	if (report->json && !report->entries) {
+		fprintf(report->json, ",\n  ");
+		json_string(report->json, key);
+		fprintf(report->json, ": ");
+		json_string(report->json, value);
+	}
+}
+
+static void report_json_entry(struct rpmsg_report *report)
+{
+	fprintf(report->json, "%s\n    ",
+		report->entries ? "," : ",\n  \"results\": [");
+}
+
+void rpmsg_report_latency(struct rpmsg_report *report, const char *label,
+			  size_t payload, const struct rpmsg_summary *sum,
+			  uint64_t elapsed_ns, unsigned long errors)
+{
+	double secs = elapsed_ns / 1e9;
+	double msgs_per_sec = secs > 0 ? sum->count / secs : 0;
+	double mb_per_sec = msgs_per_sec * payload / 1e6;
+
+	if (!report->entries) {
+		printf("\nround trip time in us\n");
+		printf("%-12s %7s %8s %8s %8s %8s %8s %8s %8s %10s %8s %6s\n",
+		       "endpoint", "payload", "count", "min", "p50", "p90",
+		       "p99", "p99.9", "max", "msgs/s", "MB/s", "errors");
+	}
+
+	printf("%-12s %7zu %8zu %8.1f %8.1f %8.1f %8.1f %8.1f %8.1f %10.0f %8.3f %6lu\n",
+	       label, payload, sum->count, sum->min / 1e3, sum->p50 / 1e3,
+	       sum->p90 / 1e3, sum->p99 / 1e3, sum->p999 / 1e3, sum->max / 1e3,
+	       msgs_per_sec, mb_per_sec, errors);
+
+	if (report->json) {
+		report_json_entry(report);
+		fprintf(report->json, "{\"endpoint\": ");
+		json_string(report->json, label);
+		fprintf(report->json, ", \"payload\": %zu, "
+			"\"count\": %zu, \"errors\": %lu, \"elapsed_ns\": %llu, "
+			"\"msgs_per_sec\": %.1f, \"bytes_per_sec\": %.1f,\n"
+			"     \"rtt_ns\": {\"min\": %llu, \"p50\": %llu, \"p90\": %llu, "
+			"\"p99\": %llu, \"p99_9\": %llu, \"max\": %llu, \"mean\": %.1f}}",
+			payload, sum->count, errors,
+			(unsigned long long)elapsed_ns, msgs_per_sec, mb_per_sec * 1e6,
+			(unsigned long long)sum->min, (unsigned long long)sum->p50,
+			(unsigned long long)sum->p90, (unsigned long long)sum->p99,
+			(unsigned long long)sum->p999, (unsigned long long)sum->max,
+			sum->mean);
+	}
+
+	report->entries++;
+}
+
+void rpmsg_report_throughput(struct rpmsg_report *report, const char *label,
+			     unsigned int window, size_t payload,
+			     const struct rpmsg_summary *sum, uint64_t elapsed_ns,
+			     unsigned long lost, unsigned long errors)
+{
+	double secs = elapsed_ns / 1e9;
+	double msgs_per_sec = secs > 0 ? sum->count / secs : 0;
+	double mb_per_sec = msgs_per_sec * payload / 1e6;
+
+	if (!report->entries) {
+		printf("\nsustained throughput, round trip time in us\n");
+		printf("%-12s %6s %7s %8s %10s %8s %8s %8s %8s %6s %6s\n",
+		       "endpoint", "window", "payload", "count", "msgs/s", "MB/s",
+		       "p50", "p99", "max", "lost", "errors");
+	}
+
+	printf("%-12s %6u %7zu %8zu %10.0f %8.3f %8.1f %8.1f %8.1f %6lu %6lu\n",
+	       label, window, payload, sum->count, msgs_per_sec, mb_per_sec,
+	       sum->p50 / 1e3, sum->p99 / 1e3, sum->max / 1e3, lost, errors);
+
+	if (report->json) {
+		report_json_entry(report);
+		fprintf(report->json, "{\"endpoint\": ");
+		json_string(report->json, label);
+		fprintf(report->json, ", \"window\": %u, "
+			"\"payload\": %zu, \"count\": %zu, \"lost\": %lu, "
+			"\"errors\": %lu, \"elapsed_ns\": %llu, "
+			"\"msgs_per_sec\": %.1f, \"bytes_per_sec\": %.1f,\n"
+			"     \"rtt_ns\": {\"min\": %llu, \"p50\": %llu, \"p90\": %llu, "
+			"\"p99\": %llu, \"p99_9\": %llu, \"max\": %llu, \"mean\": %.1f}}",
+			window, payload, sum->count, lost, errors,
+			(unsigned long long)elapsed_ns, msgs_per_sec, mb_per_sec * 1e6,
+			(unsigned long long)sum->min, (unsigned long long)sum->p50,
+			(unsigned long long)sum->p90, (unsigned long long)sum->p99,
+			(unsigned long long)sum->p999, (unsigned long long)sum->max,
+			sum->mean);
+	}
+
+	report->entries++;
+}
+
+/* Throughput with every echo checked, 'count' are distinct good messages */
+void rpmsg_report_validate(struct rpmsg_report *report, const char *label,
+			   unsigned int window, size_t payload,
+			   const struct rpmsg_summary *sum, uint64_t elapsed_ns,
+			   const struct rpmsg_seq *seq)
+{
+	double secs = elapsed_ns / 1e9;
+	double msgs_per_sec = secs > 0 ? seq->received / secs : 0;
+	double mb_per_sec = msgs_per_sec * payload / 1e6;
+
+	if (!report->entries) {
+		printf("\nvalidated throughput, round trip time in us\n");
+		printf("%-12s %6s %7s %8s %10s %8s %8s %6s %6s %6s %6s %6s\n",
+		       "endpoint", "window", "payload", "count", "msgs/s", "MB/s",
+		       "p99", "lost", "dup", "reord", "late", "crc");
+	}
+
+	printf("%-12s %6u %7zu %8lu %10.0f %8.3f %8.1f %6lu %6lu %6lu %6lu %6lu\n",
+	       label, window, payload, seq->received, msgs_per_sec, mb_per_sec,
+	       sum->p99 / 1e3, seq->missing, seq->duplicates, seq->reordered,
+	       seq->late, seq->corrupt);
+
+	if (report->json) {
+		report_json_entry(report);
+		fprintf(report->json, "{\"endpoint\": ");
+		json_string(report->json, label);
+		fprintf(report->json, ", \"window\": %u, "
+			"\"payload\": %zu, \"count\": %lu, \"lost\": %lu, "
+			"\"duplicates\": %lu, \"reordered\": %lu, \"late\": %lu, "
+			"\"corrupt\": %lu, \"elapsed_ns\": %llu, "
+			"\"msgs_per_sec\": %.1f, \"bytes_per_sec\": %.1f,\n"
+			"     \"rtt_ns\": {\"min\": %llu, \"p50\": %llu, \"p90\": %llu, "
+			"\"p99\": %llu, \"p99_9\": %llu, \"max\": %llu, \"mean\": %.1f}}",
+			window, payload, seq->received, seq->missing,
+			seq->duplicates, seq->reordered, seq->late, seq->corrupt,
+			(unsigned long long)elapsed_ns, msgs_per_sec, mb_per_sec * 1e6,
+			(unsigned long long)sum->min, (unsigned long long)sum->p50,
+			(unsigned long long)sum->p90, (unsigned long long)sum->p99,
+			(unsigned long long)sum->p999, (unsigned long long)sum->max,
+			sum->mean);
+	}
+
+	report->entries++;
+}
+
+/* 'irqs' is -1 when the interrupt could not be counted */
+void rpmsg_report_coalesce(struct rpmsg_report *report, const char *label,
+			   unsigned int deadline_us, unsigned long msgs,
+			   unsigned long frames, long long irqs,
+			   const struct rpmsg_summary *sum, unsigned long lost,
+			   unsigned long errors)
+{
+	double saved = msgs ? 100.0 * (msgs - frames) / msgs : 0;
+
+	if (!report->entries) {
+		printf("\nmessage creation to echo in us\n");
+		printf("%-12s %8s %8s %8s %10s %7s %8s %8s %8s %6s %6s\n",
+		       "endpoint", "deadline", "msgs", "frames", "interrupts",
+		       "saved", "p50", "p99", "max", "lost", "errors");
+	}
+
+	printf("%-12s %8u %8lu %8lu %10lld %6.1f%% %8.1f %8.1f %8.1f %6lu %6lu\n",
+	       label, deadline_us, msgs, frames, irqs, saved, sum->p50 / 1e3,
+	       sum->p99 / 1e3, sum->max / 1e3, lost, errors);
+
+	if (report->json) {
+		report_json_entry(report);
+		fprintf(report->json, "{\"endpoint\": ");
+		json_string(report->json, label);
+		fprintf(report->json, ", \"deadline_us\": %u, "
+			"\"msgs\": %lu, \"frames\": %lu, \"interrupts\": %lld, "
+			"\"lost\": %lu, \"errors\": %lu,\n"
+			"     \"latency_ns\": {\"min\": %llu, \"p50\": %llu, \"p90\": %llu, "
+			"\"p99\": %llu, \"p99_9\": %llu, \"max\": %llu, \"mean\": %.1f}}",
+			deadline_us, msgs, frames, irqs, lost, errors,
+			(unsigned long long)sum->min, (unsigned long long)sum->p50,
+			(unsigned long long)sum->p90, (unsigned long long)sum->p99,
+			(unsigned long long)sum->p999, (unsigned long long)sum->max,
+			sum->mean);
+	}
+
+	report->entries++;
+}
+
+void rpmsg_report_end(struct rpmsg_report *report)
+{
+	if (!report->json)
+		return;
+
+	if (!report->entries)
+		report_json_entry(report);
+	fprintf(report->json, "\n  ]\n}\n");
+	fclose(report->json);
+	report->json = NULL;
+}
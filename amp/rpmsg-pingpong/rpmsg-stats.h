@@ -0,0 +1,75 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/*
+ * Latency and throughput statistics for the RPMsg benchmarks
+ *
+ * Copyright (c) 2026 Microchip Technology, Inc. All rights reserved
+ */
+
+#ifndef __RPMSG_STATS_H
+#define __RPMSG_STATS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#include "rpmsg-check.h"
+
+/* Raw samples for one run, e.g. one payload size */
+struct rpmsg_stats {
+	uint64_t *samples;
+	size_t count;
+	size_t cap;
+};
+
+struct rpmsg_summary {
+	size_t count;
+	uint64_t min;
+	uint64_t p50;
+	uint64_t p90;
+	uint64_t p99;
+	uint64_t p999;
+	uint64_t max;
+	double mean;
+};
+
+/*
+ * Results are printed as a table and, when 'json' is set, also collected
+ * into a single JSON document written by rpmsg_report_end().
+ */
+struct rpmsg_report {
+	FILE *json;
+	int entries;
+};
+
+/* Timestamps for the benchmarks, immune to NTP/PTP slewing */
+uint64_t rpmsg_now_ns(void);
+
+int rpmsg_stats_init(struct rpmsg_stats *stats, size_t cap);
+void rpmsg_stats_reset(struct rpmsg_stats *stats);
+void rpmsg_stats_add(struct rpmsg_stats *stats, uint64_t ns);
+void rpmsg_stats_summarize(struct rpmsg_stats *stats, struct rpmsg_summary *sum);
+void rpmsg_stats_free(struct rpmsg_stats *stats);
+
+int rpmsg_report_begin(struct rpmsg_report *report, const char *json_path,
+		       const char *mode);
+void rpmsg_report_param(struct rpmsg_report *report, const char *key,
+			const char *value);
+void rpmsg_report_latency(struct rpmsg_report *report, const char *label,
+			  size_t payload, const struct rpmsg_summary *sum,
+			  uint64_t elapsed_ns, unsigned long errors);
+void rpmsg_report_throughput(struct rpmsg_report *report, const char *label,
+			     unsigned int window, size_t payload,
+			     const struct rpmsg_summary *sum, uint64_t elapsed_ns,
+			     unsigned long lost, unsigned long errors);
+void rpmsg_report_validate(struct rpmsg_report *report, const char *label,
+			   unsigned int window, size_t payload,
+			   const struct rpmsg_summary *sum, uint64_t elapsed_ns,
+			   const struct rpmsg_seq *seq);
+void rpmsg_report_coalesce(struct rpmsg_report *report, const char *label,
+			   unsigned int deadline_us, unsigned long msgs,
+			   unsigned long frames, long long irqs,
+			   const struct rpmsg_summary *sum, unsigned long lost,
+			   unsigned long errors);
+void rpmsg_report_end(struct rpmsg_report *report);
+
+#endif /* __RPMSG_STATS_H */
@@ -0,0 +1,390 @@
+// SPDX-License-Identifier: MIT
+/*
+ * Round trip and throughput benchmark of framed messages over an RPMsg tty
+ *
+ * The remote context is expected to echo everything it receives. Results
+ * are printed and written in the same format as rpmsg-pingpong, so the tty
+ * can be compared with the rpmsg char endpoint for the same payloads.
+ *
+ * Copyright (c) 2026 Microchip Technology Inc. All rights reserved.
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <termios.h>
+#include <string.h>
+#include <libgen.h>
+
+#include "rpmsg-stats.h"
+#include "tty-frame.h"
+
+#define DEFAULT_RPMSG_DEVICE	"/dev/ttyRPMSG0"
+#define ARRAY_SIZE(a)		(sizeof(a) / sizeof((a)[0]))
+#define BENCH_DEFAULT_COUNT	10000
+#define BENCH_DEFAULT_BATCH	1024
+#define BENCH_WARMUP		100
+#define RECV_TIMEOUT_MS		2000
+#define FRAME_ECHO		1
+
+/* The rpmsg-pingpong sizes, then what only fits in a frame */
+static const int bench_sizes[] = { 1, 16, 64, 128, 216, 1024, TTY_FRAME_MAX_PAYLOAD };
+static const int bench_windows[] = { 1, 2, 4, 8, 16, 32 };
+
+struct bench_config {
+	int throughput;
+	const char *label;
+	int size;		/* 0 for every size in bench_sizes */
+	int count;
+	int window;		/* 0 for every window in bench_windows */
+	size_t batch;
+};
+
+static uint8_t tx_buf[TTY_FRAME_MAX_PAYLOAD];
+static uint8_t rx_buf[TTY_FRAME_MAX_PAYLOAD];
+
+static void usage(const char *prog)
+{
+	printf("usage: %s [-d device | -L] [-b | -t] [-W window] [-B batch]\n"
+	       "\t[-c count] [-s size] [-j file]\n", prog);
+	printf("\t-d device  RPMsg tty device (default %s)\n", DEFAULT_RPMSG_DEVICE);
+	printf("\t-L         echo through a local pty instead of the remote context\n");
+	printf("\t-b         benchmark round trip time, one frame in flight (default)\n");
+	printf("\t-t         benchmark throughput with several frames in flight,\n"
+	       "\t           batched into as few writes as possible\n");
+	printf("\t-W window  frames in flight for -t (default 1 to 32)\n");
+	printf("\t-B batch   bytes of frames written together for -t (default %d)\n",
+	       BENCH_DEFAULT_BATCH);
+	printf("\t-c count   frames per payload size and window (default %d)\n",
+	       BENCH_DEFAULT_COUNT);
+	printf("\t-s size    benchmark only payloads of size bytes (1-%d)\n",
+	       TTY_FRAME_MAX_PAYLOAD);
+	printf("\t-j file    also write the results to file as JSON\n");
+}
+
+static int open_tty(const char *device)
+{
+	struct termios tty;
+	int fd;
+
+	fd = open(device, O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+	if (fd < 0)
+		return -1;
+	if (tcgetattr(fd, &tty) == 0) {
+		cfmakeraw(&tty);
+		tcsetattr(fd, TCSANOW, &tty);
+	}
+	return fd;
+}
+
+static void *pty_echo(void *arg)
+{
+	int master = (long)arg;
+	char buf[4096];
+	ssize_t n, done, ret;
+
+	while ((n = read(master, buf, sizeof(buf))) > 0) {
+		for (done = 0; done < n; done += ret) {
+			ret = write(master, buf + done, n - done);
+			if (ret < 0)
+				return NULL;
+		}
+	}
+	return NULL;
+}
+
+/* A pty whose far end echoes from a thread, standing in for the remote */
+static int open_loopback(char *name, size_t len)
+{
+	pthread_t thread;
+	int master;
+
+	master = posix_openpt(O_RDWR | O_NOCTTY | O_CLOEXEC);
+	if (master < 0 || grantpt(master) || unlockpt(master) ||
+	    ptsname_r(master, name, len))
+		return -1;
+	if (pthread_create(&thread, NULL, pty_echo, (void *)(long)master))
+		return -1;
+	pthread_detach(thread);
+
+	return open_tty(name);
+}
+
+/* Returns -ETIMEDOUT when nothing arrives within RECV_TIMEOUT_MS */
+static ssize_t recv_frame(struct tty_frame *tf, struct tty_frame_hdr *hdr)
+{
+	struct pollfd pfd = { .fd = tf->fd, .events = POLLIN };
+	uint64_t deadline = rpmsg_now_ns() + RECV_TIMEOUT_MS * 1000000ULL;
+	ssize_t n;
+
+	for (;;) {
+		n = tty_frame_recv(tf, hdr, rx_buf, sizeof(rx_buf));
+		if (n != -EAGAIN)
+			return n;
+		if (rpmsg_now_ns() >= deadline)
+			return -ETIMEDOUT;
+		if (poll(&pfd, 1, RECV_TIMEOUT_MS) < 0 && errno != EINTR)
+			return -errno;
+	}
+}
+
+/* Account for an echo, returns 0 or -1 when it is not one we are waiting for */
+static int window_echo(const struct tty_frame_hdr *hdr, ssize_t n, int size,
+		       unsigned long sent, unsigned long *done,
+		       const uint64_t *sent_ns, int window,
+		       struct rpmsg_stats *stats, unsigned long *lost)
+{
+	if (n != size || hdr->seq < *done || hdr->seq >= sent)
+		return -1;
+	rpmsg_stats_add(stats, rpmsg_now_ns() - sent_ns[hdr->seq % window]);
+	*lost += hdr->seq - *done;
+	*done = hdr->seq + 1;
+	return 0;
+}
+
+/* One frame in flight, written on its own */
+static int bench_latency(struct tty_frame *tf, int size, int count,
+			 struct rpmsg_stats *stats, uint64_t *elapsed_ns,
+			 unsigned long *errors)
+{
+	struct tty_frame_hdr hdr;
+	uint64_t start = 0, t0;
+	ssize_t n;
+	int i, ret;
+
+	rpmsg_stats_reset(stats);
+	*errors = 0;
+
+	for (i = -BENCH_WARMUP; i < count; i++) {
+		if (i == 0)
+			start = rpmsg_now_ns();
+
+		t0 = rpmsg_now_ns();
+		ret = tty_frame_send(tf, FRAME_ECHO, i, tx_buf, size, 0);
+		if (ret)
+			return ret;
+		n = recv_frame(tf, &hdr);
+		if (n < 0 && n != -EMSGSIZE) {
+			fprintf(stderr, "read: %s\n", strerror(-n));
+			return n;
+		}
+		if (i >= 0)
+			rpmsg_stats_add(stats, rpmsg_now_ns() - t0);
+
+		if (n != size || hdr.seq != (uint32_t)i)
+			(*errors)++;
+	}
+
+	*elapsed_ns = rpmsg_now_ns() - start;
+	return 0;
+}
+
+/*
+ * Up to 'window' frames in flight. Every echo already received is taken
+ * before the window is refilled, so the free slots go out batched in as
+ * few writes as possible. A gap in the echoed sequence numbers or a timeout
+ * counts as lost.
+ */
+static int bench_window(struct tty_frame *tf, int size, int count, int window,
+			struct rpmsg_stats *stats, uint64_t *elapsed_ns,
+			unsigned long *lost, unsigned long *errors)
+{
+	struct tty_frame_hdr hdr;
+	unsigned long sent = 0, done = 0;
+	uint64_t *sent_ns, start;
+	int more, ret = 0;
+	ssize_t n;
+
+	sent_ns = calloc(window, sizeof(*sent_ns));
+	if (!sent_ns)
+		return -ENOMEM;
+	rpmsg_stats_reset(stats);
+	*lost = *errors = 0;
+
+	start = rpmsg_now_ns();
+	while (done < count) {
+		while (sent < count && sent - done < window) {
+			more = sent + 1 < count && sent + 1 - done < window;
+			sent_ns[sent % window] = rpmsg_now_ns();
+			ret = tty_frame_send(tf, FRAME_ECHO, sent, tx_buf, size, more);
+			if (ret) {
+				fprintf(stderr, "write: %s\n", strerror(-ret));
+				goto out;
+			}
+			sent++;
+		}
+
+		n = recv_frame(tf, &hdr);
+		while (n != -EAGAIN) {
+			if (n == -ETIMEDOUT) {
+				*lost += sent - done;
+				done = sent;
+				break;
+			}
+			if (n < 0 && n != -EMSGSIZE) {
+				fprintf(stderr, "read: %s\n", strerror(-n));
+				ret = n;
+				goto out;
+			}
+			if (window_echo(&hdr, n, size, sent, &done, sent_ns, window,
+					stats, lost))
+				(*errors)++;
+			n = tty_frame_recv(tf, &hdr, rx_buf, sizeof(rx_buf));
+		}
+	}
+	*elapsed_ns = rpmsg_now_ns() - start;
+
+out:
+	free(sent_ns);
+	return ret;
+}
+
+static int run_benchmark(int fd, const struct bench_config *cfg,
+			 struct rpmsg_report *report, unsigned long *total_errors)
+{
+	const int *sizes = cfg->size ? &cfg->size : bench_sizes;
+	const int *windows = cfg->window ? &cfg->window : bench_windows;
+	int num_sizes = cfg->size ? 1 : ARRAY_SIZE(bench_sizes);
+	int num_windows = cfg->window ? 1 : ARRAY_SIZE(bench_windows);
+	unsigned long lost = 0, errors = 0;
+	struct rpmsg_summary sum;
+	struct rpmsg_stats stats;
+	struct tty_frame tf;
+	uint64_t elapsed_ns = 0;
+	int i, w, ret;
+
+	if (!cfg->throughput)
+		num_windows = 1;
+	ret = tty_frame_init(&tf, fd, cfg->throughput ? cfg->batch : 0);
+	if (ret)
+		return ret;
+	if (rpmsg_stats_init(&stats, cfg->count)) {
+		tty_frame_free(&tf);
+		return -ENOMEM;
+	}
+	memset(tx_buf, 0xA5, sizeof(tx_buf));
+
+	for (i = 0; i < num_sizes && !ret; i++) {
+		for (w = 0; w < num_windows && !ret; w++) {
+			if (cfg->throughput)
+				ret = bench_window(&tf, sizes[i], cfg->count,
+						   windows[w], &stats, &elapsed_ns,
+						   &lost, &errors);
+			else
+				ret = bench_latency(&tf, sizes[i], cfg->count,
+						    &stats, &elapsed_ns, &errors);
+			if (ret)
+				break;
+
+			rpmsg_stats_summarize(&stats, &sum);
+			if (cfg->throughput)
+				rpmsg_report_throughput(report, cfg->label, windows[w],
+							sizes[i], &sum, elapsed_ns,
+							lost, errors);
+			else
+				rpmsg_report_latency(report, cfg->label, sizes[i],
+						     &sum, elapsed_ns, errors);
+			*total_errors += lost + errors;
+		}
+	}
+
+	printf("\n%lu frames in %lu writes, %lu reads, %lu resyncs\n",
+	       tf.frames_sent, tf.writes, tf.reads, tf.rx_errors);
+	rpmsg_stats_free(&stats);
+	tty_frame_free(&tf);
+	return ret;
+}
+
+int main(int argc, char *argv[])
+{
+	struct bench_config cfg = { .batch = BENCH_DEFAULT_BATCH };
+	const char *device = DEFAULT_RPMSG_DEVICE;
+	const char *json_path = NULL;
+	unsigned long total_errors = 0;
+	struct rpmsg_report report;
+	char pty_name[64];
+	char batch[24];
+	int opt, fd, loopback = 0, ret;
+
+	while ((opt = getopt(argc, argv, "d:LbtW:B:c:s:j:h")) != -1) {
+		switch (opt) {
+		case 'd':
+			device = optarg;
+			break;
+		case 'L':
+			loopback = 1;
+			break;
+		case 'b':
+			cfg.throughput = 0;
+			break;
+		case 't':
+			cfg.throughput = 1;
+			break;
+		case 'W':
+			cfg.window = atoi(optarg);
+			break;
+		case 'B':
+			cfg.batch = atoi(optarg);
+			break;
+		case 'c':
+			cfg.count = atoi(optarg);
+			break;
+		case 's':
+			cfg.size = atoi(optarg);
+			break;
+		case 'j':
+			json_path = optarg;
+			break;
+		case 'h':
+			usage(argv[0]);
+			return 0;
+		default:
+			usage(argv[0]);
+			return 1;
+		}
+	}
+
+	if (!cfg.count)
+		cfg.count = BENCH_DEFAULT_COUNT;
+	if (cfg.count < 0 || cfg.size < 0 || cfg.size > TTY_FRAME_MAX_PAYLOAD ||
+	    cfg.window < 0 || (int)cfg.batch <= 0) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	if (loopback) {
+		fd = open_loopback(pty_name, sizeof(pty_name));
+		device = pty_name;
+	} else {
+		fd = open_tty(device);
+	}
+	if (fd < 0) {
+		perror(device);
+		return 1;
+	}
+	cfg.label = loopback ? "pty" : basename((char *)device);
+
+	if (rpmsg_report_begin(&report, json_path,
+			       cfg.throughput ? "throughput" : "latency")) {
+		close(fd);
+		return 1;
+	}
+	rpmsg_report_param(&report, "transport", "tty");
+	snprintf(batch, sizeof(batch), "%zu", cfg.throughput ? cfg.batch : 0);
+	rpmsg_report_param(&report, "batch", batch);
+	printf("framed echo over %s\n", device);
+
+	ret = run_benchmark(fd, &cfg, &report, &total_errors);
+	rpmsg_report_end(&report);
+	close(fd);
+
+	if (ret)
+		fprintf(stderr, "benchmark: %s\n", strerror(-ret));
+	return ret || total_errors ? 1 : 0;
+}
@@ -2,95 +2,538 @@
 /*
  * RPMsg TTY example for the Microchip PolarFire SoC
  *
+ * Bridges /dev/ttyRPMSGx to stdin/stdout, or to a Unix or TCP socket, in
+ * both directions. A single epoll loop moves data with splice() through a
+ * pipe where both ends support it, and with large buffered reads and writes
+ * otherwise.
+ *
  * Copyright (c) 2021 Microchip Technology Inc. All rights reserved.
  */
 
+#define _GNU_SOURCE
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <errno.h>
+#include <signal.h>
 #include <termios.h>
-#include <sched.h>
 #include <string.h>
+#include <time.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
 
 #define DEFAULT_RPMSG_DEVICE "/dev/ttyRPMSG0"
-#define RPMSG_MAX_SIZE		256
+#define BRIDGE_BUF_SIZE		65536
+#define DRAIN_MS		500	/* replies still collected after end of input */
 
-char *rpmsg_device = "";
+/* An fd in the epoll set, or one epoll refuses such as a regular file */
+struct endpoint {
+	int fd;
+	uint32_t events;	/* registered with epoll */
+	int always_ready;
+};
 
-void parse_cmd_line_args(int argc, char *argv[])
+/*
+ * One direction of the bridge. Data waits in 'pipe' when splicing, or in
+ * 'buf' when copying; 'queued' is the amount waiting either way.
+ */
+struct stream {
+	const char *name;
+	struct endpoint *in;
+	struct endpoint *out;
+	int pipe[2];
+	char *buf;
+	size_t head;
+	size_t tail;
+	size_t queued;
+	int eof;
+	unsigned long long bytes;
+};
+
+static char *rpmsg_device = DEFAULT_RPMSG_DEVICE;
+static const char *unix_path;
+static int tcp_port;
+static int interactive;
+static int verbose;
+
+static void usage(const char *prog)
+{
+	printf("usage: %s [-d device] [-u path | -t port] [-v]\n", prog);
+	printf("\t-d device  RPMsg tty device (default %s)\n", DEFAULT_RPMSG_DEVICE);
+	printf("\t-u path    bridge the device to clients of a Unix socket\n");
+	printf("\t-t port    bridge the device to clients of a TCP port\n");
+	printf("\t-v         print the bytes moved when each client leaves\n");
+	printf("Without -u or -t the device is bridged to stdin and stdout.\n");
+}
+
+static void parse_cmd_line_args(int argc, char *argv[])
 {
 	int c;
 
-	while ((c = getopt (argc, argv, "d")) != -1)
-	{
-		switch (c)
-		{
-			case 'd':
-				rpmsg_device = argv[2];
+	while ((c = getopt(argc, argv, "d:u:t:vh")) != -1) {
+		switch (c) {
+		case 'd':
+			rpmsg_device = optarg;
 			break;
-			default:
-				break;
+		case 'u':
+			unix_path = optarg;
+			break;
+		case 't':
+			tcp_port = atoi(optarg);
+			break;
+		case 'v':
+			verbose = 1;
+			break;
+		case 'h':
+			usage(argv[0]);
+			exit(0);
+		default:
+			usage(argv[0]);
+			exit(1);
 		}
 	}
+
+	if ((unix_path && tcp_port) || tcp_port < 0 || tcp_port > 65535) {
+		usage(argv[0]);
+		exit(1);
+	}
+}
+
+/* Returns the previous file status flags, to be restored on exit */
+static int set_nonblock(int fd)
+{
+	int flags = fcntl(fd, F_GETFL);
+
+	if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK))
+		return -1;
+	return flags;
 }
 
-void send_message_from_stdin(int fd)
+/*
+ * Raw mode so the line discipline passes every byte through untouched. The
+ * fd is non-blocking and epoll says when to read, so VMIN and VTIME do not
+ * come into play.
+ */
+static int open_tty(const char *device)
 {
-	char str[RPMSG_MAX_SIZE];
-	int len = 0;
+	struct termios tty;
+	int fd;
+
+	fd = open(device, O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+	if (fd < 0)
+		return -1;
 
-	while(len <= 1)
-	{
-		fgets(str, RPMSG_MAX_SIZE, stdin);
-		len = strlen(str);
+	if (tcgetattr(fd, &tty) == 0) {
+		cfmakeraw(&tty);
+		tty.c_cc[VMIN] = 1;
+		tty.c_cc[VTIME] = 0;
+		tcsetattr(fd, TCSANOW, &tty);
 	}
 
-	str[strcspn(str, "\n")] = 0;
+	return fd;
+}
+
+static int listen_socket(void)
+{
+	struct sockaddr_un sun = { .sun_family = AF_UNIX };
+	struct sockaddr_in sin = { .sin_family = AF_INET };
+	int fd, one = 1;
+
+	if (unix_path) {
+		if (strlen(unix_path) >= sizeof(sun.sun_path)) {
+			errno = ENAMETOOLONG;
+			return -1;
+		}
+		strcpy(sun.sun_path, unix_path);
+		unlink(unix_path);
+		fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+		if (fd < 0)
+			return -1;
+		if (bind(fd, (struct sockaddr *)&sun, sizeof(sun)))
+			goto err;
+	} else {
+		sin.sin_port = htons(tcp_port);
+		sin.sin_addr.s_addr = htonl(INADDR_ANY);
+		fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+		if (fd < 0)
+			return -1;
+		setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+		if (bind(fd, (struct sockaddr *)&sin, sizeof(sin)))
+			goto err;
+	}
 
-	write(fd, str, strlen(str));
+	if (listen(fd, 1) || set_nonblock(fd) < 0)
+		goto err;
+	return fd;
 
-	if(!strncmp(str,"quit", 4) && strlen(str) <= 5)
-		exit(0);
+err:
+	close(fd);
+	return -1;
 }
 
-int main(int argc, char **argv)
+/* Register the events 'ep' waits for, or mark it always ready */
+static int endpoint_watch(int epfd, struct endpoint *ep, uint32_t events)
 {
-	int fd;
-	struct termios tty;
+	struct epoll_event ev = { .events = events, .data.ptr = ep };
+	int op;
 
-	parse_cmd_line_args(argc, argv);
+	if (ep->always_ready || ep->events == events)
+		return 0;
 
-	if(strlen(rpmsg_device) == 0)
-	{
-		printf("Opening device %s...\n", DEFAULT_RPMSG_DEVICE);
-		fd = open(DEFAULT_RPMSG_DEVICE, O_RDWR | O_NOCTTY | O_NDELAY);
+	op = !ep->events ? EPOLL_CTL_ADD : events ? EPOLL_CTL_MOD : EPOLL_CTL_DEL;
+	if (epoll_ctl(epfd, op, ep->fd, &ev)) {
+		if (errno != EPERM)
+			return -1;
+		ep->always_ready = 1;
 	}
+	ep->events = events;
+	return 0;
+}
+
+static void stream_init(struct stream *s, const char *name,
+			struct endpoint *in, struct endpoint *out)
+{
+	memset(s, 0, sizeof(*s));
+	s->name = name;
+	s->in = in;
+	s->out = out;
+	s->pipe[0] = s->pipe[1] = -1;
+
+	/* interactive input is edited line by line, always copy it */
+	if (interactive && in->fd == STDIN_FILENO)
+		return;
+	if (pipe2(s->pipe, O_NONBLOCK | O_CLOEXEC))
+		s->pipe[0] = s->pipe[1] = -1;
 	else
-	{
-		printf("Opening device %s...\n", rpmsg_device);
-		fd = open(rpmsg_device, O_RDWR | O_NOCTTY | O_NDELAY);
+		fcntl(s->pipe[1], F_SETPIPE_SZ, BRIDGE_BUF_SIZE);
+}
+
+static void stream_free(struct stream *s)
+{
+	if (s->pipe[0] >= 0) {
+		close(s->pipe[0]);
+		close(s->pipe[1]);
 	}
+	free(s->buf);
+}
 
-	if (fd < 0)
-	{
-		printf("Error, cannot open device\n");
+/*
+ * splice() refused one of the fds, copy through a buffer from now on. Data
+ * already in the pipe moves to the buffer.
+ */
+static int stream_fall_back(struct stream *s)
+{
+	ssize_t n = 0;
+
+	s->buf = malloc(BRIDGE_BUF_SIZE + 1);
+	if (!s->buf)
+		return -1;
+	if (s->queued)
+		n = read(s->pipe[0], s->buf, s->queued);
+	close(s->pipe[0]);
+	close(s->pipe[1]);
+	s->pipe[0] = s->pipe[1] = -1;
+	s->head = 0;
+	s->tail = n > 0 ? n : 0;
+	s->queued = s->tail;
+	return 0;
+}
+
+/*
+ * Lines typed at the terminal lose their newline, as the remote console
+ * expects, and "quit" ends the program once it has been sent.
+ */
+static ssize_t interactive_line(struct stream *s, ssize_t n, int *quit)
+{
+	char *line = s->buf;
+
+	line[n] = '\0';
+	line[strcspn(line, "\n")] = '\0';
+	n = strlen(line);
+	if (!strcmp(line, "quit"))
+		*quit = 1;
+	return n;
+}
+
+static ssize_t stream_fill(struct stream *s, int *quit)
+{
+	ssize_t n;
+
+	if (s->pipe[0] >= 0) {
+		n = splice(s->in->fd, NULL, s->pipe[1], NULL, BRIDGE_BUF_SIZE,
+			   SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+		if (n >= 0 || errno != EINVAL)
+			return n;
+		if (stream_fall_back(s))
+			return -1;
+	}
+
+	if (!s->buf) {
+		s->buf = malloc(BRIDGE_BUF_SIZE + 1);
+		if (!s->buf)
+			return -1;
+	}
+	s->head = s->tail = 0;
+	n = read(s->in->fd, s->buf, BRIDGE_BUF_SIZE);
+	if (n > 0 && interactive && s->in->fd == STDIN_FILENO) {
+		n = interactive_line(s, n, quit);
+		if (n == 0 && !*quit) {
+			/* nothing to send for an empty line */
+			errno = EAGAIN;
+			return -1;
+		}
+	}
+	if (n > 0)
+		s->tail = n;
+	return n;
+}
+
+static ssize_t stream_flush(struct stream *s)
+{
+	ssize_t n;
+
+	if (s->pipe[0] >= 0) {
+		n = splice(s->pipe[0], NULL, s->out->fd, NULL, s->queued,
+			   SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+		if (n >= 0 || errno != EINVAL)
+			return n;
+		if (stream_fall_back(s))
+			return -1;
+	}
+
+	n = write(s->out->fd, s->buf + s->head, s->tail - s->head);
+	if (n > 0)
+		s->head += n;
+	return n;
+}
+
+/*
+ * Move what can be moved without blocking. Returns 0, or -1 with errno set
+ * when either side failed; 'eof' is set once the input is done and drained.
+ */
+static int stream_pump(struct stream *s, int *quit)
+{
+	ssize_t n;
+
+	for (;;) {
+		if (s->queued) {
+			n = stream_flush(s);
+			if (n < 0) {
+				if (errno == EAGAIN || errno == EINTR)
+					return 0;
+				return -1;
+			}
+			s->queued -= n;
+			s->bytes += n;
+			continue;
+		}
+		if (s->eof || *quit)
+			return 0;
+
+		n = stream_fill(s, quit);
+		if (n < 0) {
+			if (errno == EAGAIN || errno == EINTR)
+				return 0;
+			return -1;
+		}
+		if (n == 0 && !*quit) {
+			s->eof = 1;
+			return 0;
+		}
+		s->queued += n;
+	}
+}
+
+static long long now_ms(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000LL + ts.tv_nsec / 1000000;
+}
+
+static uint32_t stream_in_events(const struct stream *s)
+{
+	return s->queued || s->eof ? 0 : EPOLLIN;
+}
+
+static uint32_t stream_out_events(const struct stream *s)
+{
+	return s->queued ? EPOLLOUT : 0;
+}
+
+/*
+ * Bridge the host side and the tty until the user types quit, an error, or
+ * the host input reaches end of file and the tty has been quiet for
+ * DRAIN_MS, so replies to the last requests still get through. The host in
+ * and out ends may be the same socket.
+ */
+static int bridge(int epfd, struct endpoint *tty, struct endpoint *host_in,
+		  struct endpoint *host_out, int *quit)
+{
+	struct endpoint *eps[3] = { tty, host_in, host_out };
+	struct stream to_tty, from_tty;
+	struct epoll_event events[3];
+	unsigned long long from_bytes = 0;
+	long long drain_end = 0;
+	uint32_t want[3];
+	int i, timeout, ret = 0;
+
+	stream_init(&to_tty, "to device", host_in, tty);
+	stream_init(&from_tty, "from device", tty, host_out);
+
+	for (;;) {
+		if (stream_pump(&to_tty, quit) || stream_pump(&from_tty, quit)) {
+			if (errno != EPIPE && errno != ECONNRESET)
+				ret = -1;
+			break;
+		}
+		if (*quit && !to_tty.queued)
+			break;
+		if (to_tty.eof && !to_tty.queued) {
+			if (!drain_end || from_tty.bytes != from_bytes)
+				drain_end = now_ms() + DRAIN_MS;
+			else if (now_ms() >= drain_end && !from_tty.queued)
+				break;
+			from_bytes = from_tty.bytes;
+		}
+
+		want[0] = stream_out_events(&to_tty) | stream_in_events(&from_tty);
+		want[1] = stream_in_events(&to_tty);
+		want[2] = stream_out_events(&from_tty);
+		if (host_in == host_out) {
+			want[1] |= want[2];
+			want[2] = want[1];
+		}
+
+		timeout = drain_end ? DRAIN_MS : -1;
+		for (i = 0; i < 3; i++) {
+			if (endpoint_watch(epfd, eps[i], want[i])) {
+				ret = -1;
+				goto out;
+			}
+			if (eps[i]->always_ready && want[i])
+				timeout = 0;
+		}
+
+		/* level triggered, the streams are pumped again either way */
+		if (epoll_wait(epfd, events, 3, timeout) < 0 && errno != EINTR) {
+			ret = -1;
+			break;
+		}
+	}
+
+out:
+	for (i = 0; i < 3; i++)
+		endpoint_watch(epfd, eps[i], 0);
+	if (verbose)
+		fprintf(stderr, "%llu bytes %s, %llu bytes %s\n", to_tty.bytes,
+			to_tty.name, from_tty.bytes, from_tty.name);
+	stream_free(&to_tty);
+	stream_free(&from_tty);
+	return ret;
+}
+
+static int serve(int epfd, struct endpoint *tty)
+{
+	struct endpoint listener = { .fd = -1 }, client;
+	struct epoll_event ev;
+	int fd, quit = 0, one = 1;
+
+	listener.fd = listen_socket();
+	if (listener.fd < 0) {
+		perror(unix_path ? unix_path : "listen");
 		return 1;
 	}
+	if (unix_path)
+		printf("Listening on %s\n", unix_path);
+	else
+		printf("Listening on port %d\n", tcp_port);
+
+	while (!quit) {
+		if (endpoint_watch(epfd, &listener, EPOLLIN) ||
+		    (epoll_wait(epfd, &ev, 1, -1) < 0 && errno != EINTR))
+			break;
+
+		fd = accept4(listener.fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+		if (fd < 0)
+			continue;
+		/* no new clients until this one leaves */
+		endpoint_watch(epfd, &listener, 0);
+		if (tcp_port)
+			setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+		client = (struct endpoint){ .fd = fd };
+		if (verbose)
+			fprintf(stderr, "client connected\n");
+		if (bridge(epfd, tty, &client, &client, &quit))
+			perror("bridge");
+		close(fd);
+		if (verbose)
+			fprintf(stderr, "client disconnected\n");
+	}
 
-	tcgetattr(fd, &tty);              /* get current attributes */
-	cfmakeraw(&tty);                  /* raw input */
-	tty.c_cc[VMIN] = 0;               /* non blocking */
-	tty.c_cc[VTIME] = 0;              /* non blocking */
-	tcsetattr(fd, TCSANOW, &tty);     /* write attributes */
-	printf("Device is open\n");
+	close(listener.fd);
+	if (unix_path)
+		unlink(unix_path);
+	return 1;
+}
 
-	printf("Enter message to send or type quit to quit :");
+int main(int argc, char **argv)
+{
+	struct endpoint tty = { .fd = -1 };
+	struct endpoint host_in = { .fd = STDIN_FILENO };
+	struct endpoint host_out = { .fd = STDOUT_FILENO };
+	int epfd, quit = 0, ret;
+	int stdin_flags, stdout_flags, status;
+
+	parse_cmd_line_args(argc, argv);
+	signal(SIGPIPE, SIG_IGN);
+
+	/* bridging a pipe, stdout carries the data and takes no messages */
+	interactive = !unix_path && !tcp_port && isatty(STDIN_FILENO);
+	status = interactive || unix_path || tcp_port;
+
+	if (status)
+		printf("Opening device %s...\n", rpmsg_device);
+	tty.fd = open_tty(rpmsg_device);
+	if (tty.fd < 0) {
+		fprintf(stderr, "Error, cannot open device %s\n", rpmsg_device);
+		return 1;
+	}
+	if (status)
+		printf("Device is open\n");
+
+	epfd = epoll_create1(EPOLL_CLOEXEC);
+	if (epfd < 0) {
+		perror("epoll_create1");
+		return 1;
+	}
 
-	for ( ;; )
-	{
-		send_message_from_stdin(fd);
+	if (unix_path || tcp_port) {
+		ret = serve(epfd, &tty);
+	} else {
+		if (interactive)
+			printf("Enter message to send or type quit to quit :\n");
+		fflush(stdout);
+		/* shared with the shell when a terminal, so put them back after */
+		stdin_flags = set_nonblock(STDIN_FILENO);
+		stdout_flags = set_nonblock(STDOUT_FILENO);
+		ret = bridge(epfd, &tty, &host_in, &host_out, &quit);
+		if (ret)
+			perror("bridge");
+		if (stdin_flags >= 0)
+			fcntl(STDIN_FILENO, F_SETFL, stdin_flags);
+		if (stdout_flags >= 0)
+			fcntl(STDOUT_FILENO, F_SETFL, stdout_flags);
 	}
 
-	return EXIT_SUCCESS;
+	close(epfd);
+	close(tty.fd);
+	return ret ? 1 : EXIT_SUCCESS;
 }
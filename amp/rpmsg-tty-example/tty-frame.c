@@ -0,0 +1,195 @@
+// SPDX-License-Identifier: MIT
+/*
+ * Length-prefixed binary framing with batching over an RPMsg tty
+ *
+ * Copyright (c) 2026 Microchip Technology Inc. All rights reserved.
+ */
+
+#include <errno.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "rpmsg-check.h"
+#include "tty-frame.h"
+
+#define HDR_SIZE		sizeof(struct tty_frame_hdr)
+#define FRAME_MAX		(HDR_SIZE + TTY_FRAME_MAX_PAYLOAD)
+#define TX_TIMEOUT_MS		2000
+#define HDR_CRC_LEN		offsetof(struct tty_frame_hdr, hcrc)
+
+/* 'batch' is how many bytes of frames sent with 'more' are held back */
+int tty_frame_init(struct tty_frame *tf, int fd, size_t batch)
+{
+	memset(tf, 0, sizeof(*tf));
+	tf->tx = malloc(batch > FRAME_MAX ? batch : FRAME_MAX);
+	tf->rx = malloc(TTY_FRAME_RX_SIZE);
+	tf->rx_size = TTY_FRAME_RX_SIZE;
+	if (!tf->tx || !tf->rx) {
+		tty_frame_free(tf);
+		return -ENOMEM;
+	}
+	tf->fd = fd;
+	tf->batch = batch;
+
+	return 0;
+}
+
+void tty_frame_free(struct tty_frame *tf)
+{
+	free(tf->tx);
+	free(tf->rx);
+	tf->tx = tf->rx = NULL;
+}
+
+/*
+ * Read what the tty has behind the bytes not taken yet, growing the buffer
+ * up to TTY_FRAME_RX_MAX when it is full. Returns the bytes read, -EAGAIN
+ * when there are none or -ENOBUFS when there is no room left.
+ */
+static ssize_t rx_fill(struct tty_frame *tf)
+{
+	size_t avail = tf->rx_len - tf->rx_pos;
+	uint8_t *rx;
+	ssize_t ret;
+
+	if (tf->rx_pos) {
+		memmove(tf->rx, tf->rx + tf->rx_pos, avail);
+		tf->rx_len = avail;
+		tf->rx_pos = 0;
+	}
+	if (tf->rx_len == tf->rx_size) {
+		if (tf->rx_size >= TTY_FRAME_RX_MAX)
+			return -ENOBUFS;
+		rx = realloc(tf->rx, tf->rx_size * 2);
+		if (!rx)
+			return -ENOMEM;
+		tf->rx = rx;
+		tf->rx_size *= 2;
+	}
+
+	ret = read(tf->fd, tf->rx + tf->rx_len, tf->rx_size - tf->rx_len);
+	if (ret < 0)
+		return errno == EINTR || errno == EAGAIN ? -EAGAIN : -errno;
+	if (ret == 0)
+		return -EAGAIN;
+	tf->rx_len += ret;
+	tf->reads++;
+	return ret;
+}
+
+/*
+ * The tty is non-blocking and may take part of a write, wait for room.
+ * Meanwhile take in what arrives, the far end may wait for us to read
+ * before it reads again.
+ */
+int tty_frame_flush(struct tty_frame *tf)
+{
+	struct pollfd pfd = { .fd = tf->fd, .events = POLLOUT | POLLIN };
+	size_t done = 0;
+	ssize_t ret;
+
+	while (done < tf->tx_len) {
+		ret = write(tf->fd, tf->tx + done, tf->tx_len - done);
+		if (ret > 0) {
+			done += ret;
+			tf->writes++;
+			continue;
+		}
+		if (ret < 0 && errno != EAGAIN && errno != EINTR)
+			return -errno;
+
+		ret = poll(&pfd, 1, TX_TIMEOUT_MS);
+		if (ret == 0)
+			return -ETIMEDOUT;
+		if (ret < 0 && errno != EINTR)
+			return -errno;
+
+		if (ret > 0 && (pfd.revents & POLLIN)) {
+			ret = rx_fill(tf);
+			if (ret == -ENOBUFS)
+				pfd.events = POLLOUT;
+			else if (ret < 0 && ret != -EAGAIN)
+				return ret;
+		}
+	}
+
+	tf->tx_len = 0;
+	return 0;
+}
+
+int tty_frame_send(struct tty_frame *tf, uint8_t type, uint32_t seq,
+		   const void *msg, size_t len, int more)
+{
+	struct tty_frame_hdr hdr = {
+		.magic = TTY_FRAME_MAGIC,
+		.type = type,
+		.len = len,
+		.seq = seq,
+	};
+	int ret;
+
+	if (len > TTY_FRAME_MAX_PAYLOAD)
+		return -EMSGSIZE;
+	hdr.hcrc = rpmsg_crc32c(0, &hdr, HDR_CRC_LEN);
+
+	if (tf->tx_len && tf->tx_len + HDR_SIZE + len > tf->batch) {
+		ret = tty_frame_flush(tf);
+		if (ret)
+			return ret;
+	}
+
+	memcpy(tf->tx + tf->tx_len, &hdr, HDR_SIZE);
+	memcpy(tf->tx + tf->tx_len + HDR_SIZE, msg, len);
+	tf->tx_len += HDR_SIZE + len;
+	tf->frames_sent++;
+
+	if (!more || tf->tx_len + HDR_SIZE > tf->batch)
+		return tty_frame_flush(tf);
+	return 0;
+}
+
+/*
+ * Returns the payload length of the next complete frame, copied to 'buf'
+ * with its header in 'hdr', or -EAGAIN when the tty has no more data. A
+ * payload longer than 'len' is skipped and reported as -EMSGSIZE. Bytes
+ * that do not start a valid header are skipped and counted, once per
+ * resync, in 'rx_errors'.
+ */
+ssize_t tty_frame_recv(struct tty_frame *tf, struct tty_frame_hdr *hdr,
+		       void *buf, size_t len)
+{
+	size_t avail;
+	ssize_t ret;
+
+	for (;;) {
+		avail = tf->rx_len - tf->rx_pos;
+		if (avail >= HDR_SIZE) {
+			memcpy(hdr, tf->rx + tf->rx_pos, HDR_SIZE);
+			if (hdr->magic != TTY_FRAME_MAGIC ||
+			    hdr->len > TTY_FRAME_MAX_PAYLOAD ||
+			    hdr->hcrc != rpmsg_crc32c(0, hdr, HDR_CRC_LEN)) {
+				if (!tf->rx_sync_lost)
+					tf->rx_errors++;
+				tf->rx_sync_lost = 1;
+				tf->rx_pos++;
+				continue;
+			}
+			if (avail >= HDR_SIZE + hdr->len) {
+				tf->rx_sync_lost = 0;
+				tf->rx_pos += HDR_SIZE + hdr->len;
+				tf->frames_received++;
+				if (hdr->len > len)
+					return -EMSGSIZE;
+				memcpy(buf, tf->rx + tf->rx_pos - hdr->len, hdr->len);
+				return hdr->len;
+			}
+		}
+
+		/* keep the partial frame and read more behind it */
+		ret = rx_fill(tf);
+		if (ret < 0)
+			return ret;
+	}
+}
@@ -0,0 +1,74 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * Length-prefixed binary framing with batching over an RPMsg tty
+ *
+ * Copyright (c) 2026 Microchip Technology Inc. All rights reserved.
+ *
+ * The tty is a byte stream, so every frame starts with a header:
+ *
+ *   | magic (8) | type (8) | len (16) | seq (32) | hcrc (32) | payload ... |
+ *
+ * with the fields in host byte order, little endian on both sides. 'hcrc'
+ * is the CRC32C of the header fields before it.
+ *
+ * 'type' and 'seq' are the caller's, for example a command and a tag to
+ * match replies to requests. Frames sent with 'more' set are collected and
+ * written together once 'batch' bytes are queued or tty_frame_flush() is
+ * called, so the tty driver can pack them into as few RPMsg buffers as
+ * possible. While a write waits for room, whatever the far end sends back
+ * is read and kept for tty_frame_recv(), so that an echo blocked on its
+ * own write cannot hold up ours. A receiver that loses sync skips ahead to the next magic byte
+ * followed by a plausible length and a matching header CRC, so payload
+ * bytes that happen to look like a header are not taken for one.
+ */
+
+#ifndef __TTY_FRAME_H
+#define __TTY_FRAME_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <sys/types.h>
+
+#define TTY_FRAME_MAGIC		0x7e
+#define TTY_FRAME_MAX_PAYLOAD	4096
+#define TTY_FRAME_RX_SIZE	16384
+#define TTY_FRAME_RX_MAX	(1 << 20)
+
+struct tty_frame_hdr {
+	uint8_t magic;
+	uint8_t type;
+	uint16_t len;
+	uint32_t seq;
+	uint32_t hcrc;
+};
+
+struct tty_frame {
+	int fd;
+	size_t batch;
+
+	uint8_t *tx;
+	size_t tx_len;
+
+	uint8_t *rx;
+	size_t rx_size;
+	size_t rx_len;
+	size_t rx_pos;
+	int rx_sync_lost;
+
+	/* statistics */
+	unsigned long frames_sent;
+	unsigned long frames_received;
+	unsigned long writes;
+	unsigned long reads;
+	unsigned long rx_errors;
+};
+
+int tty_frame_init(struct tty_frame *tf, int fd, size_t batch);
+void tty_frame_free(struct tty_frame *tf);
+int tty_frame_send(struct tty_frame *tf, uint8_t type, uint32_t seq,
+		   const void *msg, size_t len, int more);
+int tty_frame_flush(struct tty_frame *tf);
+ssize_t tty_frame_recv(struct tty_frame *tf, struct tty_frame_hdr *hdr,
+		       void *buf, size_t len);
+
+#endif /* __TTY_FRAME_H */
@@ -8,6 +8,9 @@
 #ifndef MSS_FDMA_H
 #define MSS_FDMA_H
 
+#include <stddef.h>
+#include "mmio-trace.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -36,4 +39,12 @@ typedef struct _fdmaregs
 #define FDMA_IRQ_MASK    0x00000001U
 #define FDMA_MAP_SIZE    0x1000U
 
+/* Register accessors, traced when built with MMIO_TRACE=1 */
+#define FDMA_READ(dev, reg)         mmio_read32((dev), offsetof(fdma_t, reg))
+#define FDMA_WRITE(dev, reg, val)   mmio_write32((dev), offsetof(fdma_t, reg), (val))
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* MSS_FDMA_H */
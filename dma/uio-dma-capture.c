@@ -0,0 +1,465 @@
+// SPDX-License-Identifier: MIT
+/*
+ * Continuous fabric-to-disk capture example for the Microchip PolarFire SoC
+ *
+ * The fabric DMA controller (CoreAXI4DMAController) fills a ring of buffers
+ * in uncached LPDDR4 back to back, while a writer thread streams completed
+ * buffers to a file using large, page aligned writes.
+ *
+ * Copyright (C) 2026 Microchip Technology Inc. and its subsidiaries
+ */
+
+#define _GNU_SOURCE
+
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+
+#include <fcntl.h>
+#include <errno.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <signal.h>
+#include <pthread.h>
+#include <time.h>
+#include "fdma.h"
+
+#define UIO_DMA_DEVNAME        "dma-controller@60010000"
+
+#define LSRAM_BASE             0x60000000U
+#define UNCACHED_DDR_BASE      0xC8000000U
+#define UNCACHED_DDR_SIZE      0x10000U
+#define SYSFS_PATH_LEN         (128)
+#define ID_STR_LEN             (32)
+#define UIO_DEVICE_PATH_LEN    (32)
+#define NUM_UIO_DEVICES        (32)
+
+#define DEFAULT_NUM_SLOTS      (UNCACHED_DDR_SIZE / FDMA_TR_SIZE)
+#define DIRECT_IO_ALIGN        (4096U)
+#define MMIO_TRACE_FILE        "mmio-trace.bin"
+
+static char uio_id_str_fdma[] = UIO_DMA_DEVNAME;
+static char sysfs_template[] = "/sys/class/uio/uio%d/%s";
+
+/*
+ * Ring of DMA destination buffers. The capture thread owns 'head' and the
+ * writer thread owns 'tail'; both only move forward and are reduced modulo
+ * the number of slots when indexing.
+ */
+struct capture_ring {
+    volatile uint8_t *mem;       /* uncached DDR mapping of the whole ring */
+    uint32_t phys;               /* physical base address seen by the DMA */
+    uint32_t slot_size;
+    uint32_t num_slots;
+    uint64_t head;               /* next slot the DMA will fill */
+    uint64_t tail;               /* next slot the writer will drain */
+    bool done;
+    pthread_mutex_t lock;
+    pthread_cond_t filled;
+    pthread_cond_t drained;
+};
+
+struct capture_stats {
+    uint64_t captured;           /* buffers completed by the DMA */
+    uint64_t stalls;             /* times the capture waited for the writer on a full ring */
+    uint64_t written;            /* bytes written to the output file */
+    uint64_t occupancy_sum;      /* sum of ring occupancy sampled per transfer */
+    uint32_t occupancy_max;
+    uint64_t write_usecs;        /* time spent inside write() */
+};
+
+static struct capture_ring ring = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .filled = PTHREAD_COND_INITIALIZER,
+    .drained = PTHREAD_COND_INITIALIZER,
+};
+static struct capture_stats stats;
+static volatile sig_atomic_t stop_capture;
+static int out_fd = -1;
+
+static uint32_t get_memory_size(char *sysfs_path, char *uio_device)
+{
+    FILE *fp;
+    uint32_t sz;
+
+    /*
+     * open the file the describes the memory range size.
+     * this is set up by the reg property of the node in the device tree
+     */
+    fp = fopen(sysfs_path, "r");
+    if (fp == NULL) {
+        fprintf(stderr, "unable to determine size for %s\n", uio_device);
+        exit(0);
+    }
+    fscanf(fp, "0x%016X", &sz);
+    fclose(fp);
+    return sz;
+}
+
+static int get_uio_device(char * id)
+{
+    FILE *fp;
+    int i;
+    size_t len;
+    char file_id[ID_STR_LEN];
+    char sysfs_path[SYSFS_PATH_LEN];
+
+    for (i = 0; i < NUM_UIO_DEVICES; i++) {
+        snprintf(sysfs_path, SYSFS_PATH_LEN, sysfs_template, i, "/name");
+        fp = fopen(sysfs_path, "r");
+        if (fp == NULL)
+            break;
+        fscanf(fp, "%32s", file_id);
+        fclose(fp);
+        len = strlen(id);
+        if (len > ID_STR_LEN-1)
+            len = ID_STR_LEN-1;
+        if (strncmp(file_id, id, len) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static uint64_t now_usecs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void handle_sigint(int sig)
+{
+    stop_capture = 1;
+}
+
+/*
+ * Stop the capture from the writer thread. The capture loop may be waiting
+ * for a slot to be drained, which will never happen now.
+ */
+static void writer_stop(void)
+{
+    pthread_mutex_lock(&ring.lock);
+    ring.done = true;
+    stop_capture = 1;
+    pthread_cond_broadcast(&ring.drained);
+    pthread_mutex_unlock(&ring.lock);
+}
+
+/*
+ * Writer thread: drains every completed slot available in one go. The ring
+ * lives in uncached memory mapped through /dev/mem, which O_DIRECT cannot DMA
+ * from, so contiguous slots are first copied into an aligned bounce buffer and
+ * then written with a single large write().
+ */
+static void *writer_thread(void *arg)
+{
+    uint8_t *bounce;
+    uint64_t tail, avail, i;
+    uint32_t slot;
+    size_t len;
+    ssize_t ret;
+    uint64_t start;
+
+    if (posix_memalign((void **)&bounce, DIRECT_IO_ALIGN,
+                       (size_t)ring.slot_size * ring.num_slots)) {
+        fprintf(stderr, "cannot allocate bounce buffer\n");
+        writer_stop();
+        return NULL;
+    }
+
+    for (;;) {
+        pthread_mutex_lock(&ring.lock);
+        while (ring.head == ring.tail && !ring.done)
+            pthread_cond_wait(&ring.filled, &ring.lock);
+        tail = ring.tail;
+        avail = ring.head - tail;
+        pthread_mutex_unlock(&ring.lock);
+
+        if (avail == 0)
+            break;
+
+        len = 0;
+        for (i = 0; i < avail; i++) {
+            slot = (tail + i) % ring.num_slots;
+            memcpy(bounce + len, (void *)(ring.mem + (size_t)slot * ring.slot_size),
+                   ring.slot_size);
+            len += ring.slot_size;
+        }
+
+        /* the slots have been copied out so the DMA may reuse them */
+        pthread_mutex_lock(&ring.lock);
+        ring.tail = tail + avail;
+        pthread_cond_signal(&ring.drained);
+        pthread_mutex_unlock(&ring.lock);
+
+        start = now_usecs();
+        ret = write(out_fd, bounce, len);
+        stats.write_usecs += now_usecs() - start;
+        if (ret != (ssize_t)len) {
+            fprintf(stderr, "write failed: %s\n",
+                    ret < 0 ? strerror(errno) : "short write");
+            writer_stop();
+            break;
+        }
+        stats.written += len;
+    }
+
+    free(bounce);
+    return NULL;
+}
+
+static int dma_transfer(volatile fdma_t *fdma_dev, int uio_fd,
+                        uint32_t src, uint32_t dst, uint32_t len)
+{
+    uint32_t pending = 0;
+
+    FDMA_WRITE(fdma_dev, irq_mask_reg, FDMA_IRQ_MASK);
+    FDMA_WRITE(fdma_dev, exec_source, src);
+    FDMA_WRITE(fdma_dev, exec_destination, dst);
+    FDMA_WRITE(fdma_dev, exec_bytes, len);
+    FDMA_WRITE(fdma_dev, exec_config, FDMA_CONF_VAL);
+    FDMA_WRITE(fdma_dev, start_op_reg, FDMA_START);
+
+    /* blocks until the uio driver reports the completion interrupt */
+    if (read(uio_fd, &pending, sizeof(pending)) < 0) {
+        fprintf(stderr, "Cannot wait for uio device interrupt: %s\n",
+                strerror(errno));
+        return -1;
+    }
+
+    return 0;
+}
+
+static void print_stats(uint64_t elapsed_usecs, bool final)
+{
+    double secs = elapsed_usecs / 1000000.0;
+    double avg_occ = stats.captured ?
+        (double)stats.occupancy_sum / stats.captured : 0.0;
+
+    printf("%s%.1fs captured %lu stalls %lu ring %u/%u (avg %.2f, max %u) "
+           "written %.2f MB at %.2f MB/s\n",
+           final ? "\ntotal: " : "", secs,
+           stats.captured, stats.stalls,
+           (uint32_t)(ring.head - ring.tail), ring.num_slots,
+           avg_occ, stats.occupancy_max,
+           stats.written / 1048576.0,
+           secs > 0 ? stats.written / 1048576.0 / secs : 0.0);
+    if (final && stats.write_usecs)
+        printf("write() bandwidth while busy: %.2f MB/s\n",
+               stats.written / 1048576.0 / (stats.write_usecs / 1000000.0));
+}
+
+static void usage(const char *prog)
+{
+    printf("usage: %s -o file [-s src_addr] [-n slots] [-b slot_bytes] "
+           "[-t seconds] [-B]\n", prog);
+    printf("\t-o file        output file\n");
+    printf("\t-s src_addr    fabric source address (default 0x%x, LSRAM)\n",
+           LSRAM_BASE);
+    printf("\t-n slots       number of ring slots (default %u)\n",
+           DEFAULT_NUM_SLOTS);
+    printf("\t-b slot_bytes  bytes per DMA transfer (default 0x%x)\n",
+           FDMA_TR_SIZE);
+    printf("\t-t seconds     stop after this many seconds (default: ctrl+c)\n");
+    printf("\t-B             use buffered I/O instead of O_DIRECT\n");
+}
+
+int main(int argc, char *argv[])
+{
+    int opt;
+    int uio_fd, mem_fd;
+    int index;
+    int ret = 0;
+    volatile fdma_t *fdma_dev;
+    char uio_device[UIO_DEVICE_PATH_LEN];
+    char sysfs_path[SYSFS_PATH_LEN];
+    uint32_t fdma_mmap_size;
+    uint64_t ring_size;
+    uint32_t src_addr = LSRAM_BASE;
+    uint32_t occupancy, slot;
+    char *out_path = NULL;
+    bool direct_io = true;
+    unsigned int duration = 0;
+    uint64_t start, last_report, now;
+    pthread_t writer;
+
+    ring.num_slots = DEFAULT_NUM_SLOTS;
+    ring.slot_size = FDMA_TR_SIZE;
+
+    while ((opt = getopt(argc, argv, "o:s:n:b:t:Bh")) != -1) {
+        switch (opt) {
+        case 'o':
+            out_path = optarg;
+            break;
+        case 's':
+            src_addr = strtoul(optarg, NULL, 0);
+            break;
+        case 'n':
+            ring.num_slots = strtoul(optarg, NULL, 0);
+            break;
+        case 'b':
+            ring.slot_size = strtoul(optarg, NULL, 0);
+            break;
+        case 't':
+            duration = strtoul(optarg, NULL, 0);
+            break;
+        case 'B':
+            direct_io = false;
+            break;
+        default:
+            usage(argv[0]);
+            return -1;
+        }
+    }
+
+    if (!out_path || ring.num_slots < 2 || ring.slot_size == 0 ||
+        ring.slot_size % DIRECT_IO_ALIGN) {
+        usage(argv[0]);
+        fprintf(stderr, "need an output file, at least 2 slots and a slot size "
+                "that is a multiple of %u\n", DIRECT_IO_ALIGN);
+        return -1;
+    }
+
+    /* the DMA would write past the reserved window, and the writer read past the mapping */
+    ring_size = (uint64_t)ring.num_slots * ring.slot_size;
+    if (ring_size > UNCACHED_DDR_SIZE) {
+        fprintf(stderr, "ring of 0x%llx bytes exceeds the 0x%x byte uncached DDR window\n",
+                (unsigned long long)ring_size, UNCACHED_DDR_SIZE);
+        return -1;
+    }
+
+    printf("locating device for %s\n", uio_id_str_fdma);
+    index = get_uio_device(uio_id_str_fdma);
+    if (index < 0) {
+        fprintf(stderr, "can't locate uio device for %s\n", uio_id_str_fdma);
+        return -1;
+    }
+
+    snprintf(uio_device, UIO_DEVICE_PATH_LEN, "/dev/uio%d", index);
+    printf("located %s\n", uio_device);
+
+    uio_fd = open(uio_device, O_RDWR);
+    if (uio_fd < 0) {
+        fprintf(stderr, "cannot open %s: %s\n", uio_device, strerror(errno));
+        return -1;
+    }
+    snprintf(sysfs_path, SYSFS_PATH_LEN, sysfs_template, index, "maps/map0/size");
+    fdma_mmap_size = get_memory_size(sysfs_path, uio_device);
+    if (fdma_mmap_size == 0) {
+        fprintf(stderr, "bad memory size for %s\n", uio_device);
+        return -1;
+    }
+    fdma_dev = mmap(NULL, fdma_mmap_size, PROT_READ|PROT_WRITE, MAP_SHARED, uio_fd, 0);
+    if (fdma_dev == MAP_FAILED) {
+        fprintf(stderr, "cannot mmap %s: %s\n", uio_device, strerror(errno));
+        return -1;
+    }
+    printf("DMAC Version = 0x%x\n", FDMA_READ(fdma_dev, version_reg));
+
+    /* Map in the uncached DDR ring */
+    mem_fd = open("/dev/mem", O_RDWR);
+    if (mem_fd < 0) {
+        fprintf(stderr, "cannot open /dev/mem: %s\n", strerror(errno));
+        return -1;
+    }
+    ring.phys = UNCACHED_DDR_BASE;
+    ring.mem = mmap(NULL, ring_size, PROT_READ | PROT_WRITE,
+                    MAP_SHARED, mem_fd, UNCACHED_DDR_BASE);
+    if (ring.mem == MAP_FAILED) {
+        fprintf(stderr, "Cannot mmap: %s\n", strerror(errno));
+        close(mem_fd);
+        return -1;
+    }
+    printf("ring of %u x 0x%x bytes at 0x%x\n",
+           ring.num_slots, ring.slot_size, ring.phys);
+
+    out_fd = -1;
+    if (direct_io) {
+        out_fd = open(out_path, O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT, 0644);
+        if (out_fd < 0)
+            fprintf(stderr, "O_DIRECT not available for %s (%s), "
+                    "falling back to buffered I/O\n", out_path, strerror(errno));
+    }
+    if (out_fd < 0)
+        out_fd = open(out_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (out_fd < 0) {
+        fprintf(stderr, "cannot open %s: %s\n", out_path, strerror(errno));
+        return -1;
+    }
+
+    signal(SIGINT, handle_sigint);
+
+    if (pthread_create(&writer, NULL, writer_thread, NULL)) {
+        fprintf(stderr, "cannot create writer thread\n");
+        return -1;
+    }
+
+    printf("capturing from 0x%x to %s, press ctrl+c to stop\n", src_addr, out_path);
+    start = now_usecs();
+    last_report = start;
+
+    while (!stop_capture) {
+        pthread_mutex_lock(&ring.lock);
+        occupancy = ring.head - ring.tail;
+        if (occupancy == ring.num_slots) {
+            /*
+             * The writer has fallen behind. The source is a fixed fabric
+             * address, so the capture just pauses until a slot is drained
+             * rather than spinning on the full ring.
+             */
+            stats.stalls++;
+            while (ring.head - ring.tail == ring.num_slots && !stop_capture)
+                pthread_cond_wait(&ring.drained, &ring.lock);
+            pthread_mutex_unlock(&ring.lock);
+            continue;
+        }
+        slot = ring.head % ring.num_slots;
+        pthread_mutex_unlock(&ring.lock);
+
+        if (occupancy > stats.occupancy_max)
+            stats.occupancy_max = occupancy;
+        stats.occupancy_sum += occupancy;
+
+        if (dma_transfer(fdma_dev, uio_fd, src_addr,
+                         ring.phys + slot * ring.slot_size, ring.slot_size)) {
+            ret = -1;
+            break;
+        }
+
+        pthread_mutex_lock(&ring.lock);
+        ring.head++;
+        pthread_cond_signal(&ring.filled);
+        pthread_mutex_unlock(&ring.lock);
+        stats.captured++;
+
+        now = now_usecs();
+        if (now - last_report >= 1000000) {
+            print_stats(now - start, false);
+            last_report = now;
+        }
+        if (duration && now - start >= (uint64_t)duration * 1000000)
+            break;
+    }
+
+    pthread_mutex_lock(&ring.lock);
+    ring.done = true;
+    pthread_cond_signal(&ring.filled);
+    pthread_mutex_unlock(&ring.lock);
+    pthread_join(writer, NULL);
+
+    print_stats(now_usecs() - start, true);
+
+    close(out_fd);
+    munmap((void *)ring.mem, ring_size);
+    munmap((void *)fdma_dev, fdma_mmap_size);
+    close(mem_fd);
+    close(uio_fd);
+    mmio_trace_dump(MMIO_TRACE_FILE);
+    return ret;
+}
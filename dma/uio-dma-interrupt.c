@@ -31,6 +31,7 @@
 #define ID_STR_LEN             (32)
 #define UIO_DEVICE_PATH_LEN    (32)
 #define NUM_UIO_DEVICES        (32)
+#define MMIO_TRACE_FILE        "mmio-trace.bin"
 
 static char uio_id_str_fdma[] = UIO_DMA_DEVNAME;
 static char uio_id_str_lsram[] = UIO_LSRAM_DEVNAME;
@@ -215,25 +216,25 @@ int main(void)
             printf("\nInitialized LSRAM (64KB) with incremental pattern.\n");
             printf("\nFabric DMA controller configured for LSRAM to LPDDR4 data transfer.\n");
 
-            printf("DMAC Version = 0x%x \n\r", fdma_dev->version_reg);
+            printf("DMAC Version = 0x%x \n\r", FDMA_READ(fdma_dev, version_reg));
 
-            fdma_dev->irq_mask_reg = FDMA_IRQ_MASK;
+            FDMA_WRITE(fdma_dev, irq_mask_reg, FDMA_IRQ_MASK);
 
             /*0x68  Source current address. */
-            fdma_dev->exec_source = LSRAM_BASE;
+            FDMA_WRITE(fdma_dev, exec_source, LSRAM_BASE);
             printf("\n\r\tSource Address (LSRAM) - 0x%x \n\r", LSRAM_BASE);
 
             /*0x6C  Destination current address. */
-            fdma_dev->exec_destination = UNCACHED_DDR_BASE;
+            FDMA_WRITE(fdma_dev, exec_destination, UNCACHED_DDR_BASE);
             printf("\n\r\tDestination Address (LPDDR4) - %x \n\r", UNCACHED_DDR_BASE);
 
-            fdma_dev->exec_bytes = FDMA_TR_SIZE;
+            FDMA_WRITE(fdma_dev, exec_bytes, FDMA_TR_SIZE);
             printf("\n\r\tByte count - 0x%x \n\r", FDMA_TR_SIZE);
 
-            fdma_dev->exec_config = FDMA_CONF_VAL;
+            FDMA_WRITE(fdma_dev, exec_config, FDMA_CONF_VAL);
 
             /*0x04  Start Register */
-            fdma_dev->start_op_reg = FDMA_START;
+            FDMA_WRITE(fdma_dev, start_op_reg, FDMA_START);
             printf("\n\r\tDMA Transfer Initiated... \n\r");
 
             readSize = read(uioFd_0, &pending, sizeof(pending));
@@ -285,5 +286,6 @@ int main(void)
     close(uioFd_0);
     close(uioFd_1);
     close(uioFd_2);
+    mmio_trace_dump(MMIO_TRACE_FILE);
     return 0;
 }
@@ -0,0 +1,117 @@
+// SPDX-License-Identifier: MIT
+/*
+ * Arena and fixed-size pool allocators over a mapped fabric memory region
+ *
+ * Copyright (C) 2026 Microchip Technology Inc. and its subsidiaries
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#include "lsram-alloc.h"
+
+void lsram_arena_init(struct lsram_arena *arena, volatile void *base, size_t size)
+{
+    arena->base = (uint8_t *)base;
+    arena->size = size;
+    arena->used = 0;
+    arena->high_water = 0;
+}
+
+/*
+ * Returns NULL when the arena cannot satisfy the request; 'align' must be a
+ * power of two and is raised to LSRAM_MIN_ALIGN.
+ */
+void *lsram_arena_alloc(struct lsram_arena *arena, size_t size, size_t align)
+{
+    uintptr_t addr;
+    size_t offset;
+
+    if (align < LSRAM_MIN_ALIGN)
+        align = LSRAM_MIN_ALIGN;
+    if (align & (align - 1))
+        return NULL;
+
+    addr = (uintptr_t)arena->base + arena->used;
+    offset = ((addr + align - 1) & ~(uintptr_t)(align - 1)) - (uintptr_t)arena->base;
+    if (offset > arena->size || size > arena->size - offset)
+        return NULL;
+
+    arena->used = offset + size;
+    if (arena->used > arena->high_water)
+        arena->high_water = arena->used;
+
+    return arena->base + offset;
+}
+
+void lsram_arena_reset(struct lsram_arena *arena)
+{
+    arena->used = 0;
+}
+
+/* Free everything allocated since lsram_arena_mark() returned 'mark' */
+void lsram_arena_release(struct lsram_arena *arena, size_t mark)
+{
+    if (mark <= arena->used)
+        arena->used = mark;
+}
+
+/*
+ * The free list is threaded through the free objects themselves, so objects
+ * are at least pointer sized and pointer aligned.
+ */
+int lsram_pool_init(struct lsram_pool *pool, struct lsram_arena *arena,
+                    size_t obj_size, size_t count)
+{
+    size_t i;
+
+    if (obj_size < sizeof(void *))
+        obj_size = sizeof(void *);
+    obj_size = (obj_size + LSRAM_MIN_ALIGN - 1) & ~(size_t)(LSRAM_MIN_ALIGN - 1);
+
+    if (count && obj_size > SIZE_MAX / count)
+        return -EINVAL;
+
+    pool->base = lsram_arena_alloc(arena, obj_size * count, LSRAM_MIN_ALIGN);
+    if (!pool->base)
+        return -ENOMEM;
+
+    pool->obj_size = obj_size;
+    pool->count = count;
+    pool->in_use = 0;
+    pool->free_list = NULL;
+
+    /* push in reverse so objects are handed out in address order */
+    for (i = count; i-- > 0; ) {
+        void **obj = (void **)(pool->base + i * obj_size);
+
+        *obj = pool->free_list;
+        pool->free_list = obj;
+    }
+
+    return 0;
+}
+
+void *lsram_pool_alloc(struct lsram_pool *pool)
+{
+    void **obj = pool->free_list;
+
+    if (!obj)
+        return NULL;
+
+    pool->free_list = *obj;
+    pool->in_use++;
+
+    return obj;
+}
+
+void lsram_pool_free(struct lsram_pool *pool, void *obj)
+{
+    if (!obj)
+        return;
+
+    *(void **)obj = pool->free_list;
+    pool->free_list = obj;
+    pool->in_use--;
+}
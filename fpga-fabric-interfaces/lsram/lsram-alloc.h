@@ -0,0 +1,61 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * Arena and fixed-size pool allocators over a mapped fabric memory region
+ *
+ * Copyright (C) 2026 Microchip Technology Inc. and its subsidiaries
+ *
+ * An arena hands out memory from a mapped region (normally the fpga_lsram UIO
+ * mapping) by bumping an offset; everything allocated from it is released at
+ * once with lsram_arena_reset(), or back to a mark with lsram_arena_release().
+ *
+ * A pool carves a fixed number of equally sized objects out of an arena and
+ * allocates and frees them individually in constant time.
+ *
+ * Neither allocator is thread safe; use one arena per thread or lock around
+ * them.
+ */
+
+#ifndef __LSRAM_ALLOC_H
+#define __LSRAM_ALLOC_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * Fabric memory is mapped as device memory, where misaligned accesses trap,
+ * so allocations are at least 8 byte aligned.
+ */
+#define LSRAM_MIN_ALIGN         (8)
+
+struct lsram_arena {
+    uint8_t *base;
+    size_t size;
+    size_t used;
+    size_t high_water;
+};
+
+struct lsram_pool {
+    uint8_t *base;
+    size_t obj_size;
+    size_t count;
+    size_t in_use;
+    void *free_list;
+};
+
+void lsram_arena_init(struct lsram_arena *arena, volatile void *base, size_t size);
+void *lsram_arena_alloc(struct lsram_arena *arena, size_t size, size_t align);
+void lsram_arena_reset(struct lsram_arena *arena);
+
+static inline size_t lsram_arena_mark(const struct lsram_arena *arena)
+{
+    return arena->used;
+}
+
+void lsram_arena_release(struct lsram_arena *arena, size_t mark);
+
+int lsram_pool_init(struct lsram_pool *pool, struct lsram_arena *arena,
+                    size_t obj_size, size_t count);
+void *lsram_pool_alloc(struct lsram_pool *pool);
+void lsram_pool_free(struct lsram_pool *pool, void *obj);
+
+#endif /* __LSRAM_ALLOC_H */
@@ -0,0 +1,254 @@
+// SPDX-License-Identifier: MIT
+/*
+ * Memory region mapping helpers for the Microchip PolarFire SoC examples
+ *
+ * Copyright (C) 2026 Microchip Technology Inc. and its subsidiaries
+ */
+
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+#include <fcntl.h>
+#include <errno.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "mem-region.h"
+
+#define SYSFS_PATH_LEN          (128)
+#define ID_STR_LEN              (32)
+#define UIO_DEVICE_PATH_LEN     (32)
+#define NUM_UIO_DEVICES         (32)
+
+static char sysfs_template[] = "/sys/class/uio/uio%d/%s";
+static char udmabuf_template[] = "/sys/class/u-dma-buf/%s/%s";
+
+static int read_sysfs_u64(const char *path, const char *fmt, uint64_t *val)
+{
+    FILE *fp;
+    int ret;
+
+    fp = fopen(path, "r");
+    if (fp == NULL)
+        return -1;
+    ret = fscanf(fp, fmt, val);
+    fclose(fp);
+
+    return ret == 1 ? 0 : -1;
+}
+
+static int get_uio_device(const char *id)
+{
+    FILE *fp;
+    int i;
+    size_t len;
+    char file_id[ID_STR_LEN];
+    char sysfs_path[SYSFS_PATH_LEN];
+
+    for (i = 0; i < NUM_UIO_DEVICES; i++) {
+        snprintf(sysfs_path, SYSFS_PATH_LEN, sysfs_template, i, "name");
+        fp = fopen(sysfs_path, "r");
+        if (fp == NULL)
+            break;
+        if (fscanf(fp, "%31s", file_id) != 1)
+            file_id[0] = '\0';
+        fclose(fp);
+        len = strlen(id);
+        if (len > ID_STR_LEN-1)
+            len = ID_STR_LEN-1;
+        if (strncmp(file_id, id, len) == 0)
+            return i;
+    }
+
+    return -1;
+}
+
+static int map_device(struct mem_region *region, const char *path, off_t offset)
+{
+    region->fd = open(path, O_RDWR | O_SYNC);
+    if (region->fd < 0) {
+        fprintf(stderr, "cannot open %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    region->ptr = mmap(NULL, region->size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                       region->fd, offset);
+    if (region->ptr == MAP_FAILED) {
+        fprintf(stderr, "cannot mmap %s: %s\n", path, strerror(errno));
+        close(region->fd);
+        region->fd = -1;
+        return -1;
+    }
+
+    return 0;
+}
+
+static int open_uio(struct mem_region *region, const char *id)
+{
+    char uio_device[UIO_DEVICE_PATH_LEN];
+    char sysfs_path[SYSFS_PATH_LEN];
+    uint64_t val;
+    int index;
+
+    index = get_uio_device(id);
+    if (index < 0) {
+        fprintf(stderr, "can't locate uio device for %s\n", id);
+        return -1;
+    }
+    snprintf(uio_device, UIO_DEVICE_PATH_LEN, "/dev/uio%d", index);
+
+    /*
+     * the memory range size and address are set up by the reg property of
+     * the node in the device tree
+     */
+    snprintf(sysfs_path, SYSFS_PATH_LEN, sysfs_template, index, "maps/map0/size");
+    if (read_sysfs_u64(sysfs_path, "%lx", &val) || val == 0) {
+        fprintf(stderr, "bad memory size for %s\n", uio_device);
+        return -1;
+    }
+    region->size = val;
+
+    snprintf(sysfs_path, SYSFS_PATH_LEN, sysfs_template, index, "maps/map0/addr");
+    if (read_sysfs_u64(sysfs_path, "%lx", &val) == 0)
+        region->phys = val;
+
+    return map_device(region, uio_device, 0);
+}
+
+static int open_udmabuf(struct mem_region *region, const char *dev)
+{
+    char sysfs_path[SYSFS_PATH_LEN];
+    char dev_path[SYSFS_PATH_LEN];
+    uint64_t val;
+
+    snprintf(sysfs_path, SYSFS_PATH_LEN, udmabuf_template, dev, "size");
+    if (read_sysfs_u64(sysfs_path, "%lu", &val) || val == 0) {
+        fprintf(stderr, "bad memory size for %s\n", dev);
+        return -1;
+    }
+    region->size = val;
+
+    snprintf(sysfs_path, SYSFS_PATH_LEN, udmabuf_template, dev, "phys_addr");
+    if (read_sysfs_u64(sysfs_path, "%lx", &val) == 0)
+        region->phys = val;
+
+    snprintf(dev_path, SYSFS_PATH_LEN, "/dev/%s", dev);
+    return map_device(region, dev_path, 0);
+}
+
+static int open_devmem(struct mem_region *region, const char *args)
+{
+    char *end;
+
+    region->phys = strtoull(args, &end, 0);
+    if (*end != ':') {
+        fprintf(stderr, "expected mem:<phys>:<size>\n");
+        return -1;
+    }
+    region->size = strtoull(end + 1, NULL, 0);
+    if (region->size == 0) {
+        fprintf(stderr, "bad memory size for %s\n", region->name);
+        return -1;
+    }
+
+    return map_device(region, "/dev/mem", region->phys);
+}
+
+static int open_heap(struct mem_region *region, const char *args)
+{
+    region->size = strtoull(args, NULL, 0);
+    if (region->size == 0) {
+        fprintf(stderr, "bad memory size for %s\n", region->name);
+        return -1;
+    }
+
+    region->ptr = mmap(NULL, region->size, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+    if (region->ptr == MAP_FAILED) {
+        fprintf(stderr, "cannot allocate %zu bytes: %s\n", region->size,
+                strerror(errno));
+        return -1;
+    }
+
+    return 0;
+}
+
+static int open_shm(struct mem_region *region, const char *args)
+{
+    char shm_name[MEM_REGION_NAME_LEN];
+    const char *sep = strchr(args, ':');
+
+    if (!sep || sep == args) {
+        fprintf(stderr, "expected shm:<name>:<size>\n");
+        return -1;
+    }
+    snprintf(shm_name, sizeof(shm_name), "/%.*s", (int)(sep - args), args);
+    region->size = strtoull(sep + 1, NULL, 0);
+    if (region->size == 0) {
+        fprintf(stderr, "bad memory size for %s\n", region->name);
+        return -1;
+    }
+
+    region->fd = shm_open(shm_name, O_RDWR | O_CREAT, 0600);
+    if (region->fd < 0 || ftruncate(region->fd, region->size) < 0) {
+        fprintf(stderr, "cannot create %s: %s\n", shm_name, strerror(errno));
+        if (region->fd >= 0)
+            close(region->fd);
+        region->fd = -1;
+        return -1;
+    }
+
+    region->ptr = mmap(NULL, region->size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                       region->fd, 0);
+    if (region->ptr == MAP_FAILED) {
+        fprintf(stderr, "cannot mmap %s: %s\n", shm_name, strerror(errno));
+        close(region->fd);
+        region->fd = -1;
+        return -1;
+    }
+
+    return 0;
+}
+
+static int is_type(const char *spec, size_t type_len, const char *type)
+{
+    return type_len == strlen(type) && !strncmp(spec, type, type_len);
+}
+
+int mem_region_open(struct mem_region *region, const char *spec)
+{
+    const char *sep = strchr(spec, ':');
+    const char *args = sep ? sep + 1 : spec;
+    size_t type_len = sep ? (size_t)(sep - spec) : 0;
+
+    memset(region, 0, sizeof(*region));
+    region->fd = -1;
+    snprintf(region->name, sizeof(region->name), "%s", spec);
+
+    if (!sep || is_type(spec, type_len, "uio"))
+        return open_uio(region, args);
+    if (is_type(spec, type_len, "udmabuf"))
+        return open_udmabuf(region, args);
+    if (is_type(spec, type_len, "mem"))
+        return open_devmem(region, args);
+    if (is_type(spec, type_len, "heap"))
+        return open_heap(region, args);
+    if (is_type(spec, type_len, "shm"))
+        return open_shm(region, args);
+
+    fprintf(stderr, "unknown memory region type in %s\n", spec);
+    return -1;
+}
+
+void mem_region_close(struct mem_region *region)
+{
+    if (region->ptr && region->ptr != MAP_FAILED)
+        munmap((void *)region->ptr, region->size);
+    if (region->fd >= 0)
+        close(region->fd);
+    region->ptr = NULL;
+    region->fd = -1;
+}
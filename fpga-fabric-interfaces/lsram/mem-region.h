@@ -0,0 +1,39 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * Memory region mapping helpers for the Microchip PolarFire SoC examples
+ *
+ * Copyright (C) 2026 Microchip Technology Inc. and its subsidiaries
+ */
+
+#ifndef __MEM_REGION_H
+#define __MEM_REGION_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define MEM_REGION_NAME_LEN     (64)
+
+/*
+ * A region is described by a string of the form:
+ *
+ *   uio:<name>               UIO device whose sysfs name matches <name>
+ *   udmabuf:<device>         u-dma-buf device /dev/<device>
+ *   mem:<phys>:<size>        physical range mapped through /dev/mem
+ *   heap:<size>              anonymous (cached DDR) memory, for comparison
+ *   shm:<name>:<size>        POSIX shared memory object, for testing
+ *                            cross-process code without fabric memory
+ *
+ * A bare name is taken to be a UIO device name.
+ */
+struct mem_region {
+    char name[MEM_REGION_NAME_LEN];
+    int fd;
+    volatile void *ptr;
+    size_t size;
+    uint64_t phys;      /* physical base address, 0 when not known */
+};
+
+int mem_region_open(struct mem_region *region, const char *spec);
+void mem_region_close(struct mem_region *region);
+
+#endif /* __MEM_REGION_H */
@@ -0,0 +1,233 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * Lock-free single-producer/single-consumer ring in shared fabric memory
+ *
+ * Copyright (C) 2026 Microchip Technology Inc. and its subsidiaries
+ *
+ * The ring lives entirely inside a shared mapping (the fpga_lsram UIO region,
+ * a u-dma-buf pool or a region reserved for the AMP context), so the producer
+ * and consumer may be different processes, or Linux and a remote hart.
+ *
+ * Layout, all fields little endian:
+ *
+ *   +0     header: magic, slot size, slot count
+ *   +64    head, written only by the producer
+ *   +128   tail, written only by the consumer
+ *   +192   slots, each a 32 bit length followed by the payload
+ *
+ * head and tail are free running 32 bit counters on separate cache lines,
+ * the slot count is a power of two so a slot is found with a mask.
+ */
+
+#ifndef __SHM_RING_H
+#define __SHM_RING_H
+
+#include <errno.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#define SHM_RING_MAGIC          0x53505343U     /* "SPSC" */
+#define SHM_RING_CACHE_LINE     (64)
+#define SHM_RING_SLOT_HDR       (8)             /* length plus padding */
+
+/*
+ * Fabric memory is I/O space on RISC-V, which the plain "rw" fences emitted
+ * for C11 acquire/release do not order. The ring may equally live in normal
+ * (u-dma-buf) memory, so fence both device and normal accesses there.
+ */
+#if defined(__riscv)
+#define shm_ring_release()      __asm__ __volatile__("fence iorw, iorw" ::: "memory")
+#define shm_ring_acquire()      __asm__ __volatile__("fence iorw, iorw" ::: "memory")
+#else
+#define shm_ring_release()      __atomic_thread_fence(__ATOMIC_RELEASE)
+#define shm_ring_acquire()      __atomic_thread_fence(__ATOMIC_ACQUIRE)
+#endif
+
+struct shm_ring_hdr {
+    uint32_t magic;
+    uint32_t slot_size;         /* bytes per slot, including SHM_RING_SLOT_HDR */
+    uint32_t num_slots;         /* power of two */
+    uint32_t reserved;
+    uint8_t  pad0[SHM_RING_CACHE_LINE - 16];
+    volatile uint32_t head;
+    uint8_t  pad1[SHM_RING_CACHE_LINE - 4];
+    volatile uint32_t tail;
+    uint8_t  pad2[SHM_RING_CACHE_LINE - 4];
+};
+
+/*
+ * Per-process handle. Each side keeps its own index and a cached copy of the
+ * other side's index, so the shared line is only read when the ring looks
+ * full (producer) or empty (consumer).
+ */
+struct shm_ring {
+    volatile struct shm_ring_hdr *hdr;
+    volatile uint8_t *slots;
+    uint32_t slot_size;
+    uint32_t mask;
+    uint32_t local;             /* head for the producer, tail for the consumer */
+    uint32_t cached;            /* last seen tail (producer) or head (consumer) */
+};
+
+static inline size_t shm_ring_size(uint32_t slot_size, uint32_t num_slots)
+{
+    return sizeof(struct shm_ring_hdr) + (size_t)slot_size * num_slots;
+}
+
+/*
+ * Format a ring using as many slots of 'slot_size' bytes (rounded up to a
+ * multiple of 8) as fit in 'size' bytes, rounded down to a power of two.
+ */
+static inline int shm_ring_init(struct shm_ring *ring, volatile void *mem,
+                                size_t size, uint32_t slot_size)
+{
+    volatile struct shm_ring_hdr *hdr = mem;
+    uint32_t num_slots = 1;
+
+    slot_size = (slot_size + 7) & ~7U;
+    if (slot_size <= SHM_RING_SLOT_HDR || size < shm_ring_size(slot_size, 2))
+        return -EINVAL;
+    while (shm_ring_size(slot_size, num_slots * 2) <= size)
+        num_slots *= 2;
+
+    hdr->magic = 0;
+    shm_ring_release();
+    hdr->slot_size = slot_size;
+    hdr->num_slots = num_slots;
+    hdr->head = 0;
+    hdr->tail = 0;
+    shm_ring_release();
+    hdr->magic = SHM_RING_MAGIC;
+
+    ring->hdr = hdr;
+    ring->slots = (volatile uint8_t *)mem + sizeof(struct shm_ring_hdr);
+    ring->slot_size = slot_size;
+    ring->mask = num_slots - 1;
+    ring->local = 0;
+    ring->cached = 0;
+
+    return 0;
+}
+
+/* Attach to a ring formatted by the other side, as producer or consumer */
+static inline int shm_ring_attach(struct shm_ring *ring, volatile void *mem,
+                                  size_t size, int producer)
+{
+    volatile struct shm_ring_hdr *hdr = mem;
+    uint32_t num_slots;
+
+    if (size < sizeof(*hdr) || hdr->magic != SHM_RING_MAGIC)
+        return -ENODEV;
+    shm_ring_acquire();
+
+    num_slots = hdr->num_slots;
+    if (!num_slots || (num_slots & (num_slots - 1)) ||
+        shm_ring_size(hdr->slot_size, num_slots) > size)
+        return -EINVAL;
+
+    ring->hdr = hdr;
+    ring->slots = (volatile uint8_t *)mem + sizeof(struct shm_ring_hdr);
+    ring->slot_size = hdr->slot_size;
+    ring->mask = num_slots - 1;
+    ring->local = producer ? hdr->head : hdr->tail;
+    ring->cached = producer ? hdr->tail : hdr->head;
+
+    return 0;
+}
+
+static inline uint32_t shm_ring_max_payload(const struct shm_ring *ring)
+{
+    return ring->slot_size - SHM_RING_SLOT_HDR;
+}
+
+/*
+ * Copy with 64 bit stores where possible: slots are 8 byte aligned and
+ * fabric memory traps on misaligned accesses.
+ */
+static inline void shm_ring_copy_in(volatile uint8_t *dst, const uint8_t *src, uint32_t len)
+{
+    uint64_t word;
+
+    for (; len >= sizeof(word); len -= sizeof(word)) {
+        memcpy(&word, src, sizeof(word));
+        *(volatile uint64_t *)dst = word;
+        dst += sizeof(word);
+        src += sizeof(word);
+    }
+    while (len--)
+        *dst++ = *src++;
+}
+
+static inline void shm_ring_copy_out(uint8_t *dst, volatile const uint8_t *src, uint32_t len)
+{
+    uint64_t word;
+
+    for (; len >= sizeof(word); len -= sizeof(word)) {
+        word = *(volatile const uint64_t *)src;
+        memcpy(dst, &word, sizeof(word));
+        dst += sizeof(word);
+        src += sizeof(word);
+    }
+    while (len--)
+        *dst++ = *src++;
+}
+
+/* Returns 0, -EAGAIN when the ring is full or -EMSGSIZE */
+static inline int shm_ring_push(struct shm_ring *ring, const void *data, uint32_t len)
+{
+    volatile uint8_t *slot;
+
+    if (len > shm_ring_max_payload(ring))
+        return -EMSGSIZE;
+
+    if (ring->local - ring->cached > ring->mask) {
+        ring->cached = ring->hdr->tail;
+        /* the consumer has finished reading every slot up to tail */
+        shm_ring_acquire();
+        if (ring->local - ring->cached > ring->mask)
+            return -EAGAIN;
+    }
+
+    slot = ring->slots + (size_t)(ring->local & ring->mask) * ring->slot_size;
+    *(volatile uint32_t *)slot = len;
+    shm_ring_copy_in(slot + SHM_RING_SLOT_HDR, data, len);
+
+    /* publish the payload before the new head */
+    shm_ring_release();
+    ring->hdr->head = ++ring->local;
+
+    return 0;
+}
+
+/*
+ * Returns the payload length, -EAGAIN when the ring is empty or -EMSGSIZE when
+ * the payload does not fit in 'maxlen', in which case it is left in the ring.
+ */
+static inline int shm_ring_pop(struct shm_ring *ring, void *data, uint32_t maxlen)
+{
+    volatile uint8_t *slot;
+    uint32_t len;
+
+    if (ring->local == ring->cached) {
+        ring->cached = ring->hdr->head;
+        if (ring->local == ring->cached)
+            return -EAGAIN;
+        /* see the payload written before head was published */
+        shm_ring_acquire();
+    }
+
+    slot = ring->slots + (size_t)(ring->local & ring->mask) * ring->slot_size;
+    len = *(volatile uint32_t *)slot;
+    if (len > maxlen || len > shm_ring_max_payload(ring))
+        return -EMSGSIZE;
+    shm_ring_copy_out(data, slot + SHM_RING_SLOT_HDR, len);
+
+    /* finish reading the slot before handing it back to the producer */
+    shm_ring_release();
+    ring->hdr->tail = ++ring->local;
+
+    return len;
+}
+
+#endif /* __SHM_RING_H */
@@ -0,0 +1,391 @@
+// SPDX-License-Identifier: MIT
+/*
+ * FPGA fabric LSRAM bandwidth and latency benchmark for the Microchip
+ * PolarFire SoC
+ *
+ * Measures read, write and copy bandwidth with 8, 16, 32 and 64 bit and
+ * vector accesses, and dependent-load latency by pointer chasing, over the
+ * LSRAM UIO mapping and any number of other memory regions for comparison.
+ *
+ * Copyright (C) 2026 Microchip Technology Inc. and its subsidiaries
+ */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+#include "mem-region.h"
+
+#define DEFAULT_REGION          "uio:fpga_lsram"
+#define MAX_REGIONS             (8)
+#define MAX_THREADS             (16)
+#define DEFAULT_TARGET_MSECS    (200)
+#define CHASE_STRIDE            (64)    /* one L1 cache line per hop */
+#define CHASE_HOPS              (1000000)
+
+/*
+ * 128 bit accesses through the GCC vector extension. On cores without a
+ * vector unit the compiler splits these into the widest scalar accesses.
+ */
+typedef uint64_t vec128_t __attribute__((vector_size(16)));
+
+enum bench_op {
+    OP_READ,
+    OP_WRITE,
+    OP_COPY,
+};
+
+static const char *op_names[] = { "read", "write", "copy" };
+
+typedef void (*access_fn)(volatile void *dst, volatile void *src, size_t bytes);
+
+struct access_width {
+    const char *name;
+    size_t size;
+    access_fn fns[3];   /* indexed by enum bench_op */
+};
+
+/*
+ * One read, write and copy loop per access width. Reads are folded into a
+ * volatile sink so the compiler cannot drop them.
+ */
+#define DEFINE_ACCESS_FNS(type, suffix)                                         \
+static volatile type sink_##suffix;                                             \
+static void read_##suffix(volatile void *dst, volatile void *src, size_t bytes) \
+{                                                                               \
+    volatile type *p = src;                                                     \
+    size_t i, n = bytes / sizeof(type);                                         \
+    type acc;                                                                   \
+                                                                                \
+    memset(&acc, 0, sizeof(acc));                                               \
+    for (i = 0; i < n; i++)                                                     \
+        acc ^= p[i];                                                            \
+    sink_##suffix = acc;                                                        \
+}                                                                               \
+static void write_##suffix(volatile void *dst, volatile void *src, size_t bytes)\
+{                                                                               \
+    volatile type *p = dst;                                                     \
+    size_t i, n = bytes / sizeof(type);                                         \
+    type val;                                                                   \
+                                                                                \
+    memset(&val, 0x5a, sizeof(val));                                            \
+    for (i = 0; i < n; i++)                                                     \
+        p[i] = val;                                                             \
+}                                                                               \
+static void copy_##suffix(volatile void *dst, volatile void *src, size_t bytes) \
+{                                                                               \
+    volatile type *d = dst;                                                     \
+    volatile type *s = src;                                                     \
+    size_t i, n = bytes / sizeof(type);                                         \
+                                                                                \
+    for (i = 0; i < n; i++)                                                     \
+        d[i] = s[i];                                                            \
+}
+
+DEFINE_ACCESS_FNS(uint8_t, 8)
+DEFINE_ACCESS_FNS(uint16_t, 16)
+DEFINE_ACCESS_FNS(uint32_t, 32)
+DEFINE_ACCESS_FNS(uint64_t, 64)
+DEFINE_ACCESS_FNS(vec128_t, vec)
+
+static struct access_width widths[] = {
+    { "8",   sizeof(uint8_t),  { read_8,   write_8,   copy_8 } },
+    { "16",  sizeof(uint16_t), { read_16,  write_16,  copy_16 } },
+    { "32",  sizeof(uint32_t), { read_32,  write_32,  copy_32 } },
+    { "64",  sizeof(uint64_t), { read_64,  write_64,  copy_64 } },
+    { "v128", sizeof(vec128_t), { read_vec, write_vec, copy_vec } },
+};
+
+#define NUM_WIDTHS (sizeof(widths) / sizeof(widths[0]))
+
+struct bench_thread {
+    pthread_t thread;
+    int cpu;
+    access_fn fn;
+    volatile uint8_t *dst;
+    volatile uint8_t *src;
+    size_t bytes;
+    unsigned int iterations;
+    pthread_barrier_t *barrier;
+    uint64_t start_ns;
+    uint64_t end_ns;
+};
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void pin_to_cpu(int cpu)
+{
+    cpu_set_t set;
+
+    if (cpu < 0)
+        return;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+
+static void *bench_thread_fn(void *arg)
+{
+    struct bench_thread *bt = arg;
+    unsigned int i;
+
+    pin_to_cpu(bt->cpu);
+    pthread_barrier_wait(bt->barrier);
+
+    bt->start_ns = now_ns();
+    for (i = 0; i < bt->iterations; i++)
+        bt->fn(bt->dst, bt->src, bt->bytes);
+    bt->end_ns = now_ns();
+
+    return NULL;
+}
+
+/*
+ * Run 'fn' over 'bytes' of the region split evenly between 'nthreads'
+ * threads, 'iterations' times each. Returns the wall time from the first
+ * thread starting to the last one finishing.
+ */
+static uint64_t run_threads(access_fn fn, enum bench_op op, volatile uint8_t *base,
+                            size_t bytes, int nthreads, int first_cpu,
+                            unsigned int iterations)
+{
+    struct bench_thread bt[MAX_THREADS];
+    pthread_barrier_t barrier;
+    size_t slice;
+    uint64_t start = UINT64_MAX, end = 0;
+    int ncpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int i;
+
+    /* copies read from the first half of each slice into the second half */
+    slice = (bytes / nthreads) & ~(sizeof(vec128_t) * 2 - 1);
+
+    pthread_barrier_init(&barrier, NULL, nthreads);
+    for (i = 0; i < nthreads; i++) {
+        bt[i].cpu = first_cpu < 0 ? -1 : (first_cpu + i) % ncpus;
+        bt[i].fn = fn;
+        bt[i].iterations = iterations;
+        bt[i].barrier = &barrier;
+        if (op == OP_COPY) {
+            bt[i].src = base + i * slice;
+            bt[i].dst = bt[i].src + slice / 2;
+            bt[i].bytes = slice / 2;
+        } else {
+            bt[i].src = bt[i].dst = base + i * slice;
+            bt[i].bytes = slice;
+        }
+        pthread_create(&bt[i].thread, NULL, bench_thread_fn, &bt[i]);
+    }
+
+    for (i = 0; i < nthreads; i++) {
+        pthread_join(bt[i].thread, NULL);
+        if (bt[i].start_ns < start)
+            start = bt[i].start_ns;
+        if (bt[i].end_ns > end)
+            end = bt[i].end_ns;
+    }
+    pthread_barrier_destroy(&barrier);
+
+    return end - start;
+}
+
+static void bench_bandwidth(struct mem_region *region, size_t bytes, int nthreads,
+                            int first_cpu, unsigned int target_msecs)
+{
+    unsigned int iterations;
+    uint64_t elapsed;
+    size_t moved;
+    size_t w;
+    int op;
+
+    for (op = OP_READ; op <= OP_COPY; op++) {
+        for (w = 0; w < NUM_WIDTHS; w++) {
+            access_fn fn = widths[w].fns[op];
+
+            /* calibrate with a single pass, then size the run to the target */
+            elapsed = run_threads(fn, op, region->ptr, bytes, nthreads,
+                                  first_cpu, 1);
+            iterations = elapsed ?
+                (uint64_t)target_msecs * 1000000 / elapsed : 1000;
+            if (iterations < 1)
+                iterations = 1;
+
+            elapsed = run_threads(fn, op, region->ptr, bytes, nthreads,
+                                  first_cpu, iterations);
+            moved = (bytes / nthreads) & ~(sizeof(vec128_t) * 2 - 1);
+            if (op == OP_COPY)
+                moved /= 2;
+            moved *= (size_t)nthreads * iterations;
+
+            printf("%-24s %-6s %-5s %7d %12.2f\n", region->name,
+                   op_names[op], widths[w].name, nthreads,
+                   elapsed ? moved * 1000.0 / elapsed : 0.0);
+        }
+    }
+}
+
+/*
+ * Build a single random cycle through the region with one hop per cache line
+ * (Sattolo's algorithm) so every load depends on the previous one and the
+ * hardware prefetcher cannot guess the next address. Each slot holds the
+ * byte offset of the next slot, so the chain is valid in any mapping.
+ */
+static void bench_latency(struct mem_region *region, size_t bytes)
+{
+    volatile uint64_t *mem = region->ptr;
+    size_t slots = bytes / CHASE_STRIDE;
+    size_t step = CHASE_STRIDE / sizeof(uint64_t);
+    size_t *order;
+    size_t i, j, tmp;
+    uint64_t offset = 0;
+    uint64_t start, elapsed;
+
+    if (slots < 2) {
+        printf("%-24s region too small for pointer chasing\n", region->name);
+        return;
+    }
+
+    order = malloc(slots * sizeof(*order));
+    if (!order) {
+        fprintf(stderr, "cannot allocate pointer chase order\n");
+        return;
+    }
+
+    for (i = 0; i < slots; i++)
+        order[i] = i;
+    for (i = slots - 1; i > 0; i--) {
+        j = rand() % i;
+        tmp = order[i];
+        order[i] = order[j];
+        order[j] = tmp;
+    }
+    for (i = 0; i < slots; i++)
+        mem[order[i] * step] = order[(i + 1) % slots] * CHASE_STRIDE;
+    free(order);
+
+    /* one lap to warm any caches, then the timed run */
+    for (i = 0; i < slots; i++)
+        offset = mem[offset / sizeof(uint64_t)];
+
+    start = now_ns();
+    for (i = 0; i < CHASE_HOPS; i++)
+        offset = mem[offset / sizeof(uint64_t)];
+    elapsed = now_ns() - start;
+
+    printf("%-24s %10.2f ns per dependent load (%zu lines, end 0x%lx)\n",
+           region->name, (double)elapsed / CHASE_HOPS, slots, offset);
+}
+
+static void usage(const char *prog)
+{
+    printf("usage: %s [-r region]... [-s bytes] [-t threads] [-c cpu] [-m msecs]\n", prog);
+    printf("\t-r region   memory region to benchmark, may be repeated (default %s\n"
+           "\t            followed by heap:<size> for comparison):\n"
+           "\t              uio:<name>, udmabuf:<device>, mem:<phys>:<size>, heap:<size>\n",
+           DEFAULT_REGION);
+    printf("\t-s bytes    limit the test to the first 'bytes' of each region\n");
+    printf("\t-t threads  number of threads for the bandwidth tests (default 1)\n");
+    printf("\t-c cpu      pin thread n to hart cpu+n (default: no pinning)\n");
+    printf("\t-m msecs    target run time of each bandwidth test (default %d)\n",
+           DEFAULT_TARGET_MSECS);
+    printf("\nWARNING: the contents of every region are overwritten.\n");
+}
+
+int main(int argc, char *argv[])
+{
+    struct mem_region regions[MAX_REGIONS];
+    const char *specs[MAX_REGIONS];
+    char heap_spec[MEM_REGION_NAME_LEN];
+    int num_specs = 0;
+    int num_regions = 0;
+    size_t limit = 0, bytes;
+    int nthreads = 1;
+    int first_cpu = -1;
+    unsigned int target_msecs = DEFAULT_TARGET_MSECS;
+    int opt, i;
+
+    while ((opt = getopt(argc, argv, "r:s:t:c:m:h")) != -1) {
+        switch (opt) {
+        case 'r':
+            if (num_specs < MAX_REGIONS)
+                specs[num_specs++] = optarg;
+            break;
+        case 's':
+            limit = strtoul(optarg, NULL, 0);
+            break;
+        case 't':
+            nthreads = atoi(optarg);
+            break;
+        case 'c':
+            first_cpu = atoi(optarg);
+            break;
+        case 'm':
+            target_msecs = strtoul(optarg, NULL, 0);
+            break;
+        default:
+            usage(argv[0]);
+            return -1;
+        }
+    }
+
+    if (nthreads < 1 || nthreads > MAX_THREADS) {
+        fprintf(stderr, "threads must be between 1 and %d\n", MAX_THREADS);
+        return -1;
+    }
+
+    if (num_specs == 0) {
+        if (mem_region_open(&regions[num_regions], DEFAULT_REGION) == 0) {
+            num_regions++;
+            /* compare against the same amount of cached DDR */
+            snprintf(heap_spec, sizeof(heap_spec), "heap:0x%zx",
+                     limit ? limit : regions[0].size);
+            if (mem_region_open(&regions[num_regions], heap_spec) == 0)
+                num_regions++;
+        }
+    }
+
+    for (i = 0; i < num_specs; i++) {
+        if (mem_region_open(&regions[num_regions], specs[i]) == 0)
+            num_regions++;
+    }
+
+    if (num_regions == 0) {
+        fprintf(stderr, "no memory regions to benchmark\n");
+        return -1;
+    }
+
+    for (i = 0; i < num_regions; i++)
+        printf("%-24s 0x%zx bytes at 0x%lx\n", regions[i].name, regions[i].size,
+               regions[i].phys);
+
+    printf("\n%-24s %-6s %-5s %7s %12s\n", "region", "op", "width", "threads", "MB/s");
+    for (i = 0; i < num_regions; i++) {
+        bytes = limit && limit < regions[i].size ? limit : regions[i].size;
+        bench_bandwidth(&regions[i], bytes, nthreads, first_cpu, target_msecs);
+    }
+
+    printf("\n");
+    for (i = 0; i < num_regions; i++) {
+        bytes = limit && limit < regions[i].size ? limit : regions[i].size;
+        bench_latency(&regions[i], bytes);
+    }
+
+    for (i = 0; i < num_regions; i++)
+        mem_region_close(&regions[i]);
+
+    return 0;
+}
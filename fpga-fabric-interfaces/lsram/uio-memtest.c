@@ -0,0 +1,403 @@
+// SPDX-License-Identifier: MIT
+/*
+ * Multi-hart memory test for the Microchip PolarFire SoC
+ *
+ * Runs walking-ones, checkerboard, March C- and PRBS patterns over any UIO,
+ * u-dma-buf or /dev/mem mapping, splitting the region between harts, and
+ * reports throughput and the exact address of every failure.
+ *
+ * Copyright (C) 2026 Microchip Technology Inc. and its subsidiaries
+ */
+
+#define _GNU_SOURCE
+
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+#include "mem-region.h"
+
+#define DEFAULT_REGION          "uio:fpga_lsram"
+#define MAX_THREADS             (16)
+#define DEFAULT_MAX_FAILURES    (16)
+
+#define PATTERN_WALK            (1 << 0)
+#define PATTERN_CHECKER         (1 << 1)
+#define PATTERN_MARCH           (1 << 2)
+#define PATTERN_PRBS            (1 << 3)
+#define PATTERN_ALL             (PATTERN_WALK | PATTERN_CHECKER | PATTERN_MARCH | PATTERN_PRBS)
+
+#define CHECKER_PATTERN         0xAAAAAAAAAAAAAAAAULL
+
+struct memtest_failure {
+    uint64_t addr;
+    uint64_t expected;
+    uint64_t actual;
+};
+
+/* Each thread tests one contiguous block of the region */
+struct memtest_thread {
+    pthread_t thread;
+    int cpu;
+    volatile uint64_t *mem;
+    size_t words;
+    uint64_t phys;              /* physical address of mem[0] */
+    unsigned int patterns;
+    pthread_barrier_t *barrier;
+    uint64_t bytes;             /* bytes read plus bytes written */
+    uint64_t errors;
+    unsigned int max_failures;
+    unsigned int num_failures;
+    struct memtest_failure *failures;
+};
+
+struct pattern_result {
+    const char *name;
+    unsigned int mask;
+    uint64_t nsecs;
+    uint64_t bytes;
+    uint64_t errors;
+};
+
+static struct pattern_result results[] = {
+    { "walking-ones", PATTERN_WALK },
+    { "checkerboard", PATTERN_CHECKER },
+    { "march-c-",     PATTERN_MARCH },
+    { "prbs",         PATTERN_PRBS },
+};
+
+#define NUM_PATTERNS (sizeof(results) / sizeof(results[0]))
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void record_failure(struct memtest_thread *mt, size_t i,
+                           uint64_t expected, uint64_t actual)
+{
+    struct memtest_failure *f;
+
+    mt->errors++;
+    if (mt->num_failures >= mt->max_failures)
+        return;
+
+    f = &mt->failures[mt->num_failures++];
+    f->addr = mt->phys + i * sizeof(uint64_t);
+    f->expected = expected;
+    f->actual = actual;
+}
+
+static inline void check_word(struct memtest_thread *mt, size_t i, uint64_t expected)
+{
+    uint64_t actual = mt->mem[i];
+
+    if (actual != expected)
+        record_failure(mt, i, expected, actual);
+}
+
+/* Every data bit is set on its own in every word, one bit per pass */
+static void test_walking_ones(struct memtest_thread *mt)
+{
+    size_t i;
+    int bit;
+
+    for (bit = 0; bit < 64; bit++) {
+        for (i = 0; i < mt->words; i++)
+            mt->mem[i] = 1ULL << ((i + bit) & 63);
+        for (i = 0; i < mt->words; i++)
+            check_word(mt, i, 1ULL << ((i + bit) & 63));
+    }
+    mt->bytes += 64 * 2 * mt->words * sizeof(uint64_t);
+}
+
+/* Alternating 1010/0101 words, then the inverse */
+static void test_checkerboard(struct memtest_thread *mt)
+{
+    uint64_t pattern;
+    size_t i;
+    int pass;
+
+    for (pass = 0; pass < 2; pass++) {
+        pattern = pass ? ~CHECKER_PATTERN : CHECKER_PATTERN;
+        for (i = 0; i < mt->words; i++)
+            mt->mem[i] = (i & 1) ? ~pattern : pattern;
+        for (i = 0; i < mt->words; i++)
+            check_word(mt, i, (i & 1) ? ~pattern : pattern);
+    }
+    mt->bytes += 2 * 2 * mt->words * sizeof(uint64_t);
+}
+
+/*
+ * March C-: {any(w0); up(r0,w1); up(r1,w0); down(r0,w1); down(r1,w0); any(r0)}
+ * with all-zero and all-one words. Threads synchronise between elements so
+ * each element completes across the whole region before the next starts.
+ */
+static void test_march_c(struct memtest_thread *mt)
+{
+    const uint64_t zero = 0, one = ~0ULL;
+    size_t i;
+
+    for (i = 0; i < mt->words; i++)
+        mt->mem[i] = zero;
+    pthread_barrier_wait(mt->barrier);
+
+    for (i = 0; i < mt->words; i++) {
+        check_word(mt, i, zero);
+        mt->mem[i] = one;
+    }
+    pthread_barrier_wait(mt->barrier);
+
+    for (i = 0; i < mt->words; i++) {
+        check_word(mt, i, one);
+        mt->mem[i] = zero;
+    }
+    pthread_barrier_wait(mt->barrier);
+
+    for (i = mt->words; i-- > 0; ) {
+        check_word(mt, i, zero);
+        mt->mem[i] = one;
+    }
+    pthread_barrier_wait(mt->barrier);
+
+    for (i = mt->words; i-- > 0; ) {
+        check_word(mt, i, one);
+        mt->mem[i] = zero;
+    }
+    pthread_barrier_wait(mt->barrier);
+
+    for (i = 0; i < mt->words; i++)
+        check_word(mt, i, zero);
+
+    mt->bytes += 10 * mt->words * sizeof(uint64_t);
+}
+
+/*
+ * xorshift64 is a linear feedback generator over GF(2) with period 2^64 - 1,
+ * so it serves as a 64 bit wide PRBS that is cheap to regenerate for checking.
+ */
+static inline uint64_t prbs_next(uint64_t x)
+{
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return x;
+}
+
+static void test_prbs(struct memtest_thread *mt)
+{
+    uint64_t seed = mt->phys | 1;
+    uint64_t x;
+    size_t i;
+
+    x = seed;
+    for (i = 0; i < mt->words; i++) {
+        x = prbs_next(x);
+        mt->mem[i] = x;
+    }
+    x = seed;
+    for (i = 0; i < mt->words; i++) {
+        x = prbs_next(x);
+        check_word(mt, i, x);
+    }
+    mt->bytes += 2 * mt->words * sizeof(uint64_t);
+}
+
+static void *memtest_thread_fn(void *arg)
+{
+    struct memtest_thread *mt = arg;
+    cpu_set_t set;
+
+    if (mt->cpu >= 0) {
+        CPU_ZERO(&set);
+        CPU_SET(mt->cpu, &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    }
+
+    if (mt->patterns & PATTERN_WALK)
+        test_walking_ones(mt);
+    if (mt->patterns & PATTERN_CHECKER)
+        test_checkerboard(mt);
+    if (mt->patterns & PATTERN_MARCH)
+        test_march_c(mt);
+    if (mt->patterns & PATTERN_PRBS)
+        test_prbs(mt);
+
+    return NULL;
+}
+
+static unsigned int parse_patterns(char *list)
+{
+    unsigned int mask = 0;
+    char *tok;
+    size_t i;
+
+    for (tok = strtok(list, ","); tok; tok = strtok(NULL, ",")) {
+        if (!strcmp(tok, "all")) {
+            mask |= PATTERN_ALL;
+            continue;
+        }
+        for (i = 0; i < NUM_PATTERNS; i++)
+            if (!strncmp(tok, results[i].name, strlen(tok)))
+                break;
+        if (i == NUM_PATTERNS) {
+            fprintf(stderr, "unknown pattern %s\n", tok);
+            return 0;
+        }
+        mask |= results[i].mask;
+    }
+
+    return mask;
+}
+
+static void usage(const char *prog)
+{
+    printf("usage: %s [-r region] [-p patterns] [-t threads] [-c cpu] [-s bytes] "
+           "[-m max_failures]\n", prog);
+    printf("\t-r region        uio:<name>, udmabuf:<device> or mem:<phys>:<size>\n"
+           "\t                 (default %s)\n", DEFAULT_REGION);
+    printf("\t-p patterns      comma separated list of walking-ones, checkerboard,\n"
+           "\t                 march-c-, prbs or all (default all)\n");
+    printf("\t-t threads       number of harts to split the region between\n"
+           "\t                 (default: all online harts)\n");
+    printf("\t-c cpu           pin thread n to hart cpu+n (default 0)\n");
+    printf("\t-s bytes         test only the first 'bytes' of the region\n");
+    printf("\t-m max_failures  failing addresses to report per thread (default %d)\n",
+           DEFAULT_MAX_FAILURES);
+    printf("\nWARNING: the contents of the region are destroyed.\n");
+}
+
+int main(int argc, char *argv[])
+{
+    struct memtest_thread mt[MAX_THREADS];
+    struct mem_region region;
+    pthread_barrier_t barrier;
+    const char *spec = DEFAULT_REGION;
+    unsigned int patterns = PATTERN_ALL;
+    unsigned int max_failures = DEFAULT_MAX_FAILURES;
+    int nthreads = sysconf(_SC_NPROCESSORS_ONLN);
+    int ncpus = nthreads;
+    int first_cpu = 0;
+    size_t limit = 0, words, per_thread;
+    uint64_t start, total_errors = 0, total_bytes = 0, total_ns = 0;
+    unsigned int f;
+    size_t p;
+    int opt, i;
+
+    while ((opt = getopt(argc, argv, "r:p:t:c:s:m:h")) != -1) {
+        switch (opt) {
+        case 'r':
+            spec = optarg;
+            break;
+        case 'p':
+            patterns = parse_patterns(optarg);
+            break;
+        case 't':
+            nthreads = atoi(optarg);
+            break;
+        case 'c':
+            first_cpu = atoi(optarg);
+            break;
+        case 's':
+            limit = strtoul(optarg, NULL, 0);
+            break;
+        case 'm':
+            max_failures = strtoul(optarg, NULL, 0);
+            break;
+        default:
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (!patterns || nthreads < 1) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (nthreads > MAX_THREADS)
+        nthreads = MAX_THREADS;
+
+    if (mem_region_open(&region, spec))
+        return EXIT_FAILURE;
+
+    words = (limit && limit < region.size ? limit : region.size) / sizeof(uint64_t);
+    per_thread = words / nthreads;
+    if (per_thread == 0) {
+        fprintf(stderr, "region too small for %d threads\n", nthreads);
+        mem_region_close(&region);
+        return EXIT_FAILURE;
+    }
+
+    printf("testing 0x%zx bytes at 0x%lx (%s) with %d thread(s)\n",
+           words * sizeof(uint64_t), region.phys, region.name, nthreads);
+
+    for (i = 0; i < nthreads; i++) {
+        memset(&mt[i], 0, sizeof(mt[i]));
+        mt[i].cpu = first_cpu < 0 ? -1 : (first_cpu + i) % ncpus;
+        mt[i].mem = (volatile uint64_t *)region.ptr + i * per_thread;
+        /* the last thread also takes the remainder */
+        mt[i].words = i == nthreads - 1 ? words - i * per_thread : per_thread;
+        mt[i].phys = region.phys + i * per_thread * sizeof(uint64_t);
+        mt[i].barrier = &barrier;
+        mt[i].max_failures = max_failures;
+        mt[i].failures = calloc(max_failures ? max_failures : 1,
+                                sizeof(struct memtest_failure));
+    }
+
+    /* run one pattern at a time across all threads so each can be timed */
+    for (p = 0; p < NUM_PATTERNS; p++) {
+        if (!(patterns & results[p].mask))
+            continue;
+
+        pthread_barrier_init(&barrier, NULL, nthreads);
+        for (i = 0; i < nthreads; i++) {
+            mt[i].patterns = results[p].mask;
+            mt[i].bytes = 0;
+            mt[i].errors = 0;
+        }
+
+        start = now_ns();
+        for (i = 0; i < nthreads; i++)
+            pthread_create(&mt[i].thread, NULL, memtest_thread_fn, &mt[i]);
+        for (i = 0; i < nthreads; i++) {
+            pthread_join(mt[i].thread, NULL);
+            results[p].bytes += mt[i].bytes;
+            results[p].errors += mt[i].errors;
+        }
+        results[p].nsecs = now_ns() - start;
+        pthread_barrier_destroy(&barrier);
+
+        printf("%-14s %s %10.3f ms %10.2f MB/s %lu error(s)\n", results[p].name,
+               results[p].errors ? "FAIL" : "pass", results[p].nsecs / 1e6,
+               results[p].bytes * 1000.0 / results[p].nsecs, results[p].errors);
+
+        total_errors += results[p].errors;
+        total_bytes += results[p].bytes;
+        total_ns += results[p].nsecs;
+    }
+
+    for (i = 0; i < nthreads; i++) {
+        for (f = 0; f < mt[i].num_failures; f++)
+            printf("hart %d: 0x%010lx expected 0x%016lx read 0x%016lx (xor 0x%016lx)\n",
+                   mt[i].cpu, mt[i].failures[f].addr, mt[i].failures[f].expected,
+                   mt[i].failures[f].actual,
+                   mt[i].failures[f].expected ^ mt[i].failures[f].actual);
+        free(mt[i].failures);
+    }
+
+    printf("\n**** memory test %s: %lu error(s), %.3f ms, %.2f MB/s ****\n",
+           total_errors ? "FAILED" : "passed", total_errors, total_ns / 1e6,
+           total_ns ? total_bytes * 1000.0 / total_ns : 0.0);
+
+    mem_region_close(&region);
+    return total_errors ? EXIT_FAILURE : EXIT_SUCCESS;
+}
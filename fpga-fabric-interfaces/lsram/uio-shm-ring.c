@@ -0,0 +1,305 @@
+// SPDX-License-Identifier: MIT
+/*
+ * Cross-process SPSC ring benchmark over shared fabric memory for the
+ * Microchip PolarFire SoC
+ *
+ * A producer and a consumer process each map the same region and exchange
+ * messages through the shm-ring.h ring. Throughput is measured with one ring,
+ * latency with a second ring echoing every message back.
+ *
+ * Copyright (C) 2026 Microchip Technology Inc. and its subsidiaries
+ */
+
+#define _GNU_SOURCE
+
+#include <sys/wait.h>
+
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sched.h>
+#include <time.h>
+
+#include "mem-region.h"
+#include "shm-ring.h"
+
+#define DEFAULT_REGION          "uio:fpga_lsram"
+#define DEFAULT_SLOT_SIZE       (256)
+#define DEFAULT_MESSAGES        (100000)
+#define LATENCY_SAMPLES         (10000)
+#define MAX_PAYLOAD             (4096)
+#define SPIN_LIMIT              (1000)
+
+struct bench_msg {
+    uint64_t seq;
+    uint64_t ts_ns;
+};
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void pin_to_cpu(int cpu)
+{
+    cpu_set_t set;
+
+    if (cpu < 0)
+        return;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    sched_setaffinity(0, sizeof(set), &set);
+}
+
+/*
+ * Busy-wait on the ring for a while, then give up the hart so the two sides
+ * still make progress when they share one (or are not pinned).
+ */
+static void spin_wait(unsigned int *spins)
+{
+    if (++*spins < SPIN_LIMIT)
+        return;
+    *spins = 0;
+    sched_yield();
+}
+
+static int compare_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+
+    return x < y ? -1 : x > y;
+}
+
+/*
+ * The consumer and the echo side run in a child process that maps the
+ * region on its own, exactly as an unrelated process would.
+ */
+static pid_t start_child(const char *spec, int cpu, size_t ring_bytes, bool echo,
+                         uint32_t payload, uint32_t messages)
+{
+    struct mem_region region;
+    struct shm_ring rx, tx = { 0 };
+    uint8_t buf[MAX_PAYLOAD];
+    struct bench_msg *msg = (struct bench_msg *)buf;
+    uint64_t expected = 0, errors = 0, start = 0;
+    uint32_t received = 0;
+    unsigned int spins = 0;
+    pid_t pid;
+    int len;
+
+    pid = fork();
+    if (pid != 0)
+        return pid;
+
+    pin_to_cpu(cpu);
+    if (mem_region_open(&region, spec))
+        exit(EXIT_FAILURE);
+
+    while (shm_ring_attach(&rx, region.ptr, ring_bytes, 0))
+        sched_yield();
+    if (echo) {
+        while (shm_ring_attach(&tx, (volatile uint8_t *)region.ptr + ring_bytes,
+                               ring_bytes, 1))
+            sched_yield();
+    }
+
+    while (received < messages) {
+        len = shm_ring_pop(&rx, buf, sizeof(buf));
+        if (len == -EAGAIN) {
+            spin_wait(&spins);
+            continue;
+        }
+        if (len < 0) {
+            fprintf(stderr, "consumer: bad message (%d)\n", len);
+            exit(EXIT_FAILURE);
+        }
+        if (received == 0)
+            start = now_ns();
+        received++;
+
+        if (echo) {
+            while (shm_ring_push(&tx, buf, len) == -EAGAIN)
+                spin_wait(&spins);
+            continue;
+        }
+
+        if (len != (int)payload || msg->seq != expected)
+            errors++;
+        expected = msg->seq + 1;
+    }
+
+    if (!echo) {
+        uint64_t elapsed = now_ns() - start;
+
+        printf("%8u %10u %12.0f %12.2f %8lu\n", payload, messages,
+               messages * 1e9 / elapsed, (double)messages * payload * 1e3 / elapsed,
+               errors);
+    }
+
+    mem_region_close(&region);
+    exit(errors ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+
+static int wait_child(pid_t pid)
+{
+    int status;
+
+    if (waitpid(pid, &status, 0) < 0)
+        return -1;
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+static int bench_throughput(struct mem_region *region, const char *spec, uint32_t slot_size,
+                            uint32_t payload, uint32_t messages, int cpu)
+{
+    struct shm_ring tx;
+    uint8_t buf[MAX_PAYLOAD] = { 0 };
+    struct bench_msg *msg = (struct bench_msg *)buf;
+    unsigned int spins = 0;
+    uint32_t i;
+    pid_t pid;
+
+    if (shm_ring_init(&tx, region->ptr, region->size, slot_size))
+        return -1;
+    if (payload > shm_ring_max_payload(&tx))
+        return 0;
+
+    pid = start_child(spec, cpu < 0 ? -1 : cpu + 1, region->size, false,
+                      payload, messages);
+
+    for (i = 0; i < messages; i++) {
+        msg->seq = i;
+        while (shm_ring_push(&tx, buf, payload) == -EAGAIN)
+            spin_wait(&spins);
+    }
+
+    return wait_child(pid);
+}
+
+static int bench_latency(struct mem_region *region, const char *spec, uint32_t slot_size,
+                         uint32_t payload, int cpu)
+{
+    struct shm_ring tx, rx;
+    size_t ring_bytes = region->size / 2;
+    uint8_t buf[MAX_PAYLOAD] = { 0 };
+    struct bench_msg *msg = (struct bench_msg *)buf;
+    unsigned int spins = 0;
+    uint64_t *rtt;
+    uint32_t i;
+    pid_t pid;
+
+    if (shm_ring_init(&tx, region->ptr, ring_bytes, slot_size) ||
+        shm_ring_init(&rx, (volatile uint8_t *)region->ptr + ring_bytes,
+                      ring_bytes, slot_size))
+        return -1;
+    if (payload > shm_ring_max_payload(&tx))
+        return 0;
+
+    rtt = malloc(LATENCY_SAMPLES * sizeof(*rtt));
+    if (!rtt)
+        return -1;
+
+    pid = start_child(spec, cpu < 0 ? -1 : cpu + 1, ring_bytes, true,
+                      payload, LATENCY_SAMPLES);
+
+    for (i = 0; i < LATENCY_SAMPLES; i++) {
+        msg->seq = i;
+        msg->ts_ns = now_ns();
+        while (shm_ring_push(&tx, buf, payload) == -EAGAIN)
+            spin_wait(&spins);
+        while (shm_ring_pop(&rx, buf, sizeof(buf)) == -EAGAIN)
+            spin_wait(&spins);
+        rtt[i] = now_ns() - msg->ts_ns;
+    }
+
+    qsort(rtt, LATENCY_SAMPLES, sizeof(*rtt), compare_u64);
+    printf("%8u %10lu %10lu %10lu %10lu\n", payload,
+           rtt[0], rtt[LATENCY_SAMPLES / 2], rtt[LATENCY_SAMPLES * 99 / 100],
+           rtt[LATENCY_SAMPLES - 1]);
+    free(rtt);
+
+    return wait_child(pid);
+}
+
+static void usage(const char *prog)
+{
+    printf("usage: %s [-r region] [-s slot_size] [-n messages] [-c cpu]\n", prog);
+    printf("\t-r region     uio:<name>, udmabuf:<device>, mem:<phys>:<size> or\n"
+           "\t              shm:<name>:<size> (default %s)\n", DEFAULT_REGION);
+    printf("\t-s slot_size  bytes per ring slot (default %d)\n", DEFAULT_SLOT_SIZE);
+    printf("\t-n messages   messages per throughput run (default %d)\n", DEFAULT_MESSAGES);
+    printf("\t-c cpu        pin the producer to hart cpu and the consumer to cpu+1\n");
+}
+
+int main(int argc, char *argv[])
+{
+    static const uint32_t payloads[] = { 16, 64, 248, 1016, 4088 };
+    struct mem_region region;
+    const char *spec = DEFAULT_REGION;
+    uint32_t slot_size = DEFAULT_SLOT_SIZE;
+    uint32_t messages = DEFAULT_MESSAGES;
+    int cpu = -1;
+    int ret = 0;
+    size_t i;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "r:s:n:c:h")) != -1) {
+        switch (opt) {
+        case 'r':
+            spec = optarg;
+            break;
+        case 's':
+            slot_size = strtoul(optarg, NULL, 0);
+            break;
+        case 'n':
+            messages = strtoul(optarg, NULL, 0);
+            break;
+        case 'c':
+            cpu = atoi(optarg);
+            break;
+        default:
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (slot_size > MAX_PAYLOAD + SHM_RING_SLOT_HDR || messages == 0) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (!strncmp(spec, "heap", 4)) {
+        fprintf(stderr, "heap memory is private to one process, use shm:<name>:<size>\n");
+        return EXIT_FAILURE;
+    }
+    if (mem_region_open(&region, spec))
+        return EXIT_FAILURE;
+
+    pin_to_cpu(cpu);
+    setvbuf(stdout, NULL, _IOLBF, 0);
+
+    printf("region %s, 0x%zx bytes at 0x%lx, %u byte slots\n\n",
+           region.name, region.size, region.phys, slot_size);
+
+    printf("%8s %10s %12s %12s %8s\n", "payload", "messages", "msgs/s", "MB/s", "errors");
+    for (i = 0; i < sizeof(payloads) / sizeof(payloads[0]); i++) {
+        if (payloads[i] < sizeof(struct bench_msg))
+            continue;
+        ret |= bench_throughput(&region, spec, slot_size, payloads[i], messages, cpu);
+    }
+
+    printf("\nround trip latency in ns\n");
+    printf("%8s %10s %10s %10s %10s\n", "payload", "min", "p50", "p99", "max");
+    for (i = 0; i < sizeof(payloads) / sizeof(payloads[0]); i++)
+        ret |= bench_latency(&region, spec, slot_size, payloads[i], cpu);
+
+    mem_region_close(&region);
+    return ret ? EXIT_FAILURE : EXIT_SUCCESS;
+}
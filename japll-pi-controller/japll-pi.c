@@ -5,6 +5,7 @@
  * Copyright (C) 2025 Microchip Technology Inc. and its subsidiaries
  */
 
+#define _GNU_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
@@ -16,30 +17,28 @@
 #include <stdbool.h>
 #include <limits.h>
 #include <signal.h>
+#include <poll.h>
+#include <sched.h>
+#include <pthread.h>
 
 #include <sys/stat.h>
 #include <sys/mman.h>
+#include <sys/ioctl.h>
+#include <sys/timex.h>
+#include <sys/wait.h>
+#include <net/if.h>
+#include <linux/ethtool.h>
+#include <linux/sockios.h>
 
 #include "print.h"
+#include "mmio-trace.h"
+#include "ptp4l-mgmt.h"
+#include "japll-telemetry.h"
+#include "japll-pi.h"
 
 /******************************************************************
  * Configuration File parameters and PI Controller related
  ******************************************************************/
-#define INITIAL_PPB_SETTLE_COUNT      1
-#define APPLY_PPB_STEP_SIZE           1
-
-struct g_pi_conf_t {
-	bool   is_read;             /* indicate whether to read configuration file or not */
-	int    pi_enable;           /* indicate use of MCHP pi controller*/
-	double k_proportional;      /* constant for proportion */
-	double k_integral;          /* constant for integration */
-	double set_point;           /* target value to achieve */
-	double delta_time;          /* time instance for integral : 1 / ptp packets per sec */
-	float  board_ref_clk_freq;  /* reference clock frequency to JAPLL */
-	char   eth_interface[10];   /* ethernet driver interface for input to ptp4l command */
-	char   ptp4l_config[50];    /* filename along with path for input to ptp4l command */
-};
-
 struct g_pi_conf_t g_pi_conf = {
 	.is_read = false,
 	.pi_enable = false,
@@ -49,42 +48,110 @@ struct g_pi_conf_t g_pi_conf = {
 	.delta_time = 0.0,
 	.board_ref_clk_freq = 0.0,
 	.eth_interface[0] = '\0',
-	.ptp4l_config[0] = '\0'
+	.ptp4l_config[0] = '\0',
+	.ptp4l_source = "text",
+	.latency_report = 0,
+	.fixed_point = 0,
+	.async_log = 0,
+	.telemetry_file[0] = '\0',
+	.telemetry_records = JAPLL_TELEMETRY_DEFAULT_RECS,
+	.rt_priority = 0,
+	.rt_cpu = -1,
+	.jitter_report = 0
+};
+
+/******************************************************************
+ * ptp4l management interface and latency measurement related
+ ******************************************************************/
+#define PTP4L_START_TIMEOUT_MS         10000
+#define PTP4L_RETRY_MS                 100
+#define LATENCY_REPORT_SAMPLES         256
+#define LATENCY_PAIR_MAX_NS            1000000000LL
+#define FD_TO_CLOCKID(fd)              ((~(clockid_t)(fd) << 3) | 3)
+
+struct g_ptp_t {
+	char      uds_address[108];   /* ptp4l management socket */
+	int       domain;             /* domainNumber of ptp4l */
+	int       transport;          /* transportSpecific of ptp4l */
+	bool      sw_timestamping;    /* ptp4l servos CLOCK_REALTIME rather than the PHC */
+	int       phc_fd;             /* PTP hardware clock of eth_interface */
+	clockid_t clkid;              /* clock servoed by ptp4l */
+	struct ptp4l_mgmt mgmt;       /* subscription to ptp4l time sync notifications */
+	int64_t   ingress_ns;         /* sync ingress time not yet paired with an update */
+	int64_t   update_ns;          /* JAPLL update time not yet paired with a sync */
+	unsigned long lat_count;      /* latency samples so far */
+	int64_t   lat_min;
+	int64_t   lat_max;
+	int64_t   lat_sum;
+};
+
+struct g_ptp_t g_ptp = {
+	.uds_address = PTP4L_MGMT_DEFAULT_ADDRESS,
+	.domain = 0,
+	.transport = 0,
+	.sw_timestamping = false,
+	.phc_fd = -1,
+	.clkid = CLOCK_REALTIME,
+	.mgmt.fd = -1,
+};
+
+/******************************************************************
+ * Real-time execution and update jitter related
+ ******************************************************************/
+#define RT_STACK_PREFAULT              (256 * 1024)
+/*
+ * The arrival to write intervals are counted in buckets of a quarter
+ * octave from 2^JITTER_MIN_SHIFT to 2^JITTER_MAX_SHIFT ns, with one
+ * bucket below and one above that range.
+ */
+#define JITTER_MIN_SHIFT               10
+#define JITTER_MAX_SHIFT               30
+#define JITTER_SUB_BITS                2
+#define JITTER_BUCKETS                 (((JITTER_MAX_SHIFT - JITTER_MIN_SHIFT) << JITTER_SUB_BITS) + 2)
+#define JITTER_REPORT_SAMPLES          256
+
+struct g_rt_t {
+	int64_t   arrival_ns;         /* CLOCK_MONOTONIC when the current sample arrived */
+	int64_t   write_ns;           /* CLOCK_MONOTONIC when the JAPLL registers were last written */
+	unsigned long count;          /* intervals counted so far */
+	int64_t   min;
+	int64_t   max;
+	unsigned long hist[JITTER_BUCKETS];
 };
 
+struct g_rt_t g_rt;
+
+
 /******************************************************************
  * JAPLL configuration parameters and related
  ******************************************************************/
 #define UIO_0_DEVICE                   "/dev/uio0"
-#define MMAP_SIZE                      0x100
-
-#define JAPLL_9_INT_PRESET             0xE         /* Reg Offset:0x38 / sizeof(int) */
-#define JAPLL_8_FRAC_PRESET            0xD         /* Reg Offset:0x34 / sizeof(int) */
-#define JAPLL_8_PRESET_DISABLE         0xFEFFFFFF  /* Disabling TXPLL_JA_PRESET_EN (bit:24) Reg */
-#define JAPLL_8_HOLD_ENABLE            0x02000000  /* Enabling TXPLL_JA_HOLD_EN (bit:25) Reg */
-/* Enabling TXPLL_JA_HOLD (bit:25) and TXPLL_JA_PRESET_EN (bit:24) Regs */
-#define JAPLL_8_HOLD_PRESET_ENABLE     0x03000000
-/* To read only 24-29 bits from register */
-#define TXPLL_REF_DIV(x)               ((x & 0x3F000000) >> 24)
-#define TXPLL_DIV_2                    0x5         /* Reg Offset : 0x14 / sizeof(int) */
-#define FRAC_DIVIDER                   1000000000.0
-#define TSU_CLK_FREQ                   125.0
-#define BIT_CLK_FREQ_MULT              (10 * 2)
-#define FRAC_TO_JAPLL_FRAC(x)          ((x) * pow(2, JAPLL_FRAC_WIDTH_BITS))
-#define JAPLL_INT_WIDTH_BITS           12
-#define JAPLL_FRAC_WIDTH_BITS          24
-
-struct g_japll_t {
-	int      uioFd_0;             /* to store file descriptor for UIO device */
-	uint32_t *mem_ptr0;           /* to map JAPLL UIO device memory */
-	int      integer;             /* to store integer part of PPB value */
-	int      fraction;            /* to store fraction part of PPB value */
-	bool     is_int_written;      /* ensure integer has been written earlier */
-	bool     is_frac_written;     /* ensure fraction has been written earlier */
-	double   japll_preset_ppb_0;  /* indicate preset value of JAPLL for PPB value 0 */
-	int      japll_wr_enable;     /* indicate use of JAPLL functionality */
+#define FRAC_TO_JAPLL_FRAC(x)          ((x) * JAPLL_FRAC_ONE)
+#define MMIO_TRACE_FILE                "/tmp/japll-mmio-trace.bin"
+
+/* JAPLL register accessors, traced when built with MMIO_TRACE=1 */
+#define japll_reg_read(reg)         mmio_read32(g_japll.mem_ptr0, (reg) * sizeof(uint32_t))
+#define japll_reg_write(reg, val)   mmio_write32(g_japll.mem_ptr0, (reg) * sizeof(uint32_t), (val))
+
+
+struct g_fixed_t {
+	int64_t  preset_ppb_0;        /* g_japll.japll_preset_ppb_0 in Q.40 */
+	int64_t  ppb_scale;           /* japll_preset_ppb_0 / FRAC_DIVIDER in Q.72 */
+	int64_t  k_proportional;      /* Q.32 */
+	int64_t  k_integral_dt;       /* k_integral * delta_time in Q.32 */
+	int64_t  set_point;           /* Q.16 */
+	int64_t  integral;            /* integral term in Q.16 */
 };
 
+struct g_fixed_t g_fixed;
+
+static int g_iterations;      /* samples taken by japll_main() */
+static double g_integral;     /* integral term of pi_controller() */
+
+static struct japll_telemetry g_telemetry;    /* mapped while telemetry_file is set */
+static struct japll_telemetry_rec g_sample;   /* sample being taken by japll_main() */
+static volatile sig_atomic_t g_stop;          /* SIGINT or SIGTERM received */
+
 struct g_japll_t g_japll = {
 	.uioFd_0 = -1,
 	.mem_ptr0 = NULL,
@@ -99,14 +166,14 @@ struct g_japll_t g_japll = {
 /*
  *  Function to fetch parameters from configuration file
  */
-int get_pi_configuration(void)
+int get_pi_configuration(const char *path)
 {
 	FILE *fp;
 	char word[50];
 
-	fp = fopen("/opt/microchip/japll-pi-controller/configs/japll-pi.cfg", "r");
+	fp = fopen(path, "r");
 	if (!fp) {
-		pr_err("Cannot open japll-pi.cfg: %m");
+		pr_err("Cannot open %s: %m", path);
 		return errno;
 	}
 
@@ -147,6 +214,43 @@ int get_pi_configuration(void)
 			fscanf(fp, "%49s", word);
 			strncat(g_pi_conf.ptp4l_config, word, sizeof(g_pi_conf.ptp4l_config) - 1);
 			pr_info("ptp4l_config : %s", g_pi_conf.ptp4l_config);
+		} else if (!(strcmp(word, "ptp4l_source"))) {
+			fscanf(fp, "%49s", word);
+			snprintf(g_pi_conf.ptp4l_source, sizeof(g_pi_conf.ptp4l_source), "%.7s", word);
+			pr_info("ptp4l_source : %s", g_pi_conf.ptp4l_source);
+		} else if (!(strcmp(word, "latency_report"))) {
+			fscanf(fp, "%49s", word);
+			g_pi_conf.latency_report = atoi(word);
+			pr_info("latency_report : %d", g_pi_conf.latency_report);
+		} else if (!(strcmp(word, "fixed_point"))) {
+			fscanf(fp, "%49s", word);
+			g_pi_conf.fixed_point = atoi(word);
+			pr_info("fixed_point : %d", g_pi_conf.fixed_point);
+		} else if (!(strcmp(word, "async_log"))) {
+			fscanf(fp, "%49s", word);
+			g_pi_conf.async_log = atoi(word);
+			pr_info("async_log : %d", g_pi_conf.async_log);
+		} else if (!(strcmp(word, "telemetry_file"))) {
+			fscanf(fp, "%49s", word);
+			snprintf(g_pi_conf.telemetry_file, sizeof(g_pi_conf.telemetry_file), "%s",
+					strcmp(word, "none") ? word : "");
+			pr_info("telemetry_file : %s", word);
+		} else if (!(strcmp(word, "telemetry_records"))) {
+			fscanf(fp, "%49s", word);
+			g_pi_conf.telemetry_records = strtoul(word, NULL, 0);
+			pr_info("telemetry_records : %u", g_pi_conf.telemetry_records);
+		} else if (!(strcmp(word, "rt_priority"))) {
+			fscanf(fp, "%49s", word);
+			g_pi_conf.rt_priority = atoi(word);
+			pr_info("rt_priority : %d", g_pi_conf.rt_priority);
+		} else if (!(strcmp(word, "rt_cpu"))) {
+			fscanf(fp, "%49s", word);
+			g_pi_conf.rt_cpu = atoi(word);
+			pr_info("rt_cpu : %d", g_pi_conf.rt_cpu);
+		} else if (!(strcmp(word, "jitter_report"))) {
+			fscanf(fp, "%49s", word);
+			g_pi_conf.jitter_report = atoi(word);
+			pr_info("jitter_report : %d", g_pi_conf.jitter_report);
 		}
 	}
 
@@ -177,11 +281,10 @@ double p_cal(double error)
  */
 double i_cal(double error)
 {
-	static double integral; // Integral term
 	double i_val;
 
-	i_val = integral + (error * g_pi_conf.k_integral * g_pi_conf.delta_time);
-	integral = i_val;
+	i_val = g_integral + (error * g_pi_conf.k_integral * g_pi_conf.delta_time);
+	g_integral = i_val;
 
 	return i_val;
 }
@@ -207,35 +310,134 @@ double pi_controller(double input_val)
 }
 
 /*
- * Called per packet or per PPB basis.
+ * Multiply with rounding to nearest, ties to even, so that the integral
+ * term does not drift by the rounding of every sample. Ties are common
+ * with gains such as 0.5, rounding them up would add a bias.
  */
-void calculate_japll_presets(double ppb)
+static inline int64_t fixed_mul(int64_t a, int64_t b, int shift)
 {
-	double japll_preset_total = 0.0;
-	int japll_preset_int = 0;
+	__int128 prod = (__int128)a * b;
+	__int128 half = (__int128)1 << (shift - 1);
+	__int128 res = prod >> shift;
+	__int128 rem = prod - (res << shift);
+
+	if (rem > half || (rem == half && (res & 1)))
+		res++;
+
+	return res;
+}
+
+/**
+ * PI controller function, fixed point version of pi_controller()
+ * taking and returning ppb in Q.16
+ */
+int64_t pi_controller_fixed(int64_t input_val)
+{
+	int64_t input_err;
+	int64_t output_val;
+
+	input_err = g_fixed.set_point - input_val;
+
+	g_fixed.integral += fixed_mul(input_err, g_fixed.k_integral_dt, GAIN_Q);
+	output_val = fixed_mul(input_err, g_fixed.k_proportional, GAIN_Q) + g_fixed.integral;
+
+	pr_debug("ip_val : %lf op_val : %lf\n", (double)input_val / (1 << PPB_Q),
+			(double)output_val / (1 << PPB_Q));
+
+	return output_val;
+}
+
+/*
+ * Split the total preset for 'ppb' into the JAPLL int and frac presets.
+ */
+double japll_preset_split(double ppb, int *integer, int *fraction)
+{
+	double japll_preset_total;
 
 	/* Step-1: Calculate total preset */
 	japll_preset_total = (g_japll.japll_preset_ppb_0) * ((ppb / FRAC_DIVIDER) + 1);
 
 	/* Step-2: Calculate int preset */
 	/* int preset is obtained through trucation of the total preset */
-	japll_preset_int = japll_preset_total;
+	*integer = japll_preset_total;
+
+	/* Step-3: Calculate frac preset */
+	*fraction = FRAC_TO_JAPLL_FRAC(japll_preset_total - *integer);
+
+	return japll_preset_total;
+}
+
+/*
+ * Same as japll_preset_split() for a Q.16 'ppb', using only an integer
+ * multiply and shifts. Both truncate the total preset, the results agree
+ * to within one LSB of the frac preset.
+ */
+void japll_preset_split_fixed(int64_t ppb, int *integer, int *fraction)
+{
+	int64_t japll_preset_total;
+
+	japll_preset_total = g_fixed.preset_ppb_0 +
+		(int64_t)(((__int128)g_fixed.ppb_scale * ppb) >> PPB_SCALE_SHIFT);
 
-	if (g_japll.integer != japll_preset_int) {
-		g_japll.integer = japll_preset_int;
+	*integer = japll_preset_total >> PRESET_Q;
+	*fraction = (japll_preset_total >> (PRESET_Q - JAPLL_FRAC_WIDTH_BITS)) & JAPLL_FRAC_MASK;
+}
+
+void japll_preset_update(int integer, int fraction)
+{
+	if (g_japll.integer != integer) {
+		g_japll.integer = integer;
 		pr_info("New g_japll.integer = 0x%x", g_japll.integer);
 		g_japll.is_int_written = false;
 	}
 
-	/* Step-3: Calculate frac preset */
 	/* Typically frac preset will change every time */
-	g_japll.fraction = FRAC_TO_JAPLL_FRAC(japll_preset_total - g_japll.integer);
+	g_japll.fraction = fraction;
 	g_japll.is_frac_written = false;
+}
+
+/*
+ * Called per packet or per PPB basis.
+ */
+void calculate_japll_presets(double ppb)
+{
+	double japll_preset_total = 0.0;
+	int integer, fraction;
+
+	japll_preset_total = japll_preset_split(ppb, &integer, &fraction);
+	japll_preset_update(integer, fraction);
 
 	pr_debug("ppb = %.8f, japll_preset_total = %.8f, int = %d, frac = 0x%x",
 			ppb, japll_preset_total, g_japll.integer, g_japll.fraction);
 }
 
+/*
+ * Fixed point version of calculate_japll_presets(), 'ppb' in Q.16
+ */
+void calculate_japll_presets_fixed(int64_t ppb)
+{
+	int integer, fraction;
+
+	japll_preset_split_fixed(ppb, &integer, &fraction);
+	japll_preset_update(integer, fraction);
+
+	pr_debug("ppb = %.8f, int = %d, frac = 0x%x",
+			(double)ppb / (1 << PPB_Q), g_japll.integer, g_japll.fraction);
+}
+
+/*
+ * Convert the preset for PPB = 0 and the PI constants to fixed point.
+ */
+void japll_fixed_init(void)
+{
+	g_fixed.preset_ppb_0 = llround(ldexp(g_japll.japll_preset_ppb_0, PRESET_Q));
+	g_fixed.ppb_scale = llround(ldexp(g_japll.japll_preset_ppb_0 / FRAC_DIVIDER, PPB_SCALE_Q));
+	g_fixed.k_proportional = llround(ldexp(g_pi_conf.k_proportional, GAIN_Q));
+	g_fixed.k_integral_dt = llround(ldexp(g_pi_conf.k_integral * g_pi_conf.delta_time, GAIN_Q));
+	g_fixed.set_point = llround(ldexp(g_pi_conf.set_point, PPB_Q));
+	g_fixed.integral = 0;
+}
+
 /*
  * Should be called only once during the application's lifetime.
  */
@@ -245,7 +447,7 @@ void calculate_japll_initial_presets(void)
 
 	/* Step-1: Calculate total preset for ppb_0 */
 	/* read TXPLL_REF_DIV register */
-	japll_ref_div = *(g_japll.mem_ptr0 + TXPLL_DIV_2);
+	japll_ref_div = japll_reg_read(TXPLL_DIV_2);
 
 	/* JAPLL Base Preset value is the present value (integer + frac) for PPB = 0 */
 	g_japll.japll_preset_ppb_0 =
@@ -262,19 +464,28 @@ void calculate_japll_initial_presets(void)
 	/* Remaining part is frac preset, in the order of 24 bits */
 	g_japll.fraction = FRAC_TO_JAPLL_FRAC(g_japll.japll_preset_ppb_0 - g_japll.integer);
 	pr_info("step 3: japll_preset_frac = 0x%x", g_japll.fraction);
+
+	if (g_pi_conf.fixed_point)
+		japll_fixed_init();
 }
 
 int configure_japll(void)
 {
+	int64_t start_ns = 0, end_ns;
+
+	if (g_telemetry.hdr || g_pi_conf.jitter_report)
+		start_ns = japll_telemetry_clock_ns(CLOCK_MONOTONIC);
+
 	if (!(g_japll.is_int_written)) {
 		if (g_japll.integer >> JAPLL_INT_WIDTH_BITS)
 			pr_warning("g_japll.integer: 0x%x exceeding %d bits, msb's will be discarded!",
 					g_japll.integer, JAPLL_INT_WIDTH_BITS);
 
-		*(g_japll.mem_ptr0 + JAPLL_9_INT_PRESET) = g_japll.integer;
+		japll_reg_write(JAPLL_9_INT_PRESET, g_japll.integer);
 		pr_debug("[Write][JAPLL_9_INT_PRESET Reg]: 0x%x", g_japll.integer);
 
 		g_japll.is_int_written = true;
+		g_sample.flags |= JAPLL_TELEMETRY_INT_WRITTEN;
 	}
 
 	if (!(g_japll.is_frac_written)) {
@@ -286,8 +497,8 @@ int configure_japll(void)
 		/* Step 1: Ensure TXPLL_JA_PRESET_EN is disabled, TXPLL_JA_HOLD is enabled,
 		 * then copy the fractional value.
 		 */
-		*(g_japll.mem_ptr0 + JAPLL_8_FRAC_PRESET) =
-			((g_japll.fraction & JAPLL_8_PRESET_DISABLE) | JAPLL_8_HOLD_ENABLE);
+		japll_reg_write(JAPLL_8_FRAC_PRESET,
+				((g_japll.fraction & JAPLL_8_PRESET_DISABLE) | JAPLL_8_HOLD_ENABLE));
 		pr_debug("[Write][JAPLL_8_FRAC_PRESET Reg] Preset Disabled : 0x%x",
 				(g_japll.fraction & JAPLL_8_PRESET_DISABLE));
 		pr_debug("[Write][JAPLL_8_FRAC_PRESET Reg] Preset Disabled, Hold Enabled: 0x%x",
@@ -297,12 +508,20 @@ int configure_japll(void)
 		/* Step 2: Enable both TXPLL_JA_HOLD and TXPLL_JA_PRESET_EN,
 		 * along with retaining the fractional value,
 		 */
-		*(g_japll.mem_ptr0 + JAPLL_8_FRAC_PRESET) =
-			(g_japll.fraction | JAPLL_8_HOLD_PRESET_ENABLE);
+		japll_reg_write(JAPLL_8_FRAC_PRESET,
+				(g_japll.fraction | JAPLL_8_HOLD_PRESET_ENABLE));
 		pr_debug("[Write][JAPLL_8_FRAC_PRESET Reg] Hold and Preset Enabled: 0x%x",
 				(g_japll.fraction | JAPLL_8_HOLD_PRESET_ENABLE));
 
 		g_japll.is_frac_written = true;
+		g_sample.flags |= JAPLL_TELEMETRY_FRAC_WRITTEN;
+	}
+
+	if (start_ns) {
+		end_ns = japll_telemetry_clock_ns(CLOCK_MONOTONIC);
+		g_sample.write_ns = end_ns - start_ns;
+		if (g_pi_conf.jitter_report)
+			g_rt.write_ns = end_ns;
 	}
 
 	return EXIT_SUCCESS;
@@ -311,39 +530,69 @@ int configure_japll(void)
 int japll_main(double ppb)
 {
 	int status = 0;
-	static int iterations;
 	double n_freq;
+	int64_t ppb_q = 0, n_freq_q;
 
 	pr_debug("Input PPB = %f\n", ppb);
 
-	if (iterations < INITIAL_PPB_SETTLE_COUNT) {
+	if (g_telemetry.hdr) {
+		g_sample.ts_ns = japll_telemetry_clock_ns(CLOCK_MONOTONIC);
+		g_sample.realtime_ns = japll_telemetry_clock_ns(CLOCK_REALTIME);
+		g_sample.ppb_in = ppb;
+		g_sample.ppb_out = ppb;
+		g_sample.write_ns = 0;
+		g_sample.flags = 0;
+	}
+
+	if (g_pi_conf.fixed_point)
+		ppb_q = ppb * (1 << PPB_Q);
+
+	if (g_iterations < INITIAL_PPB_SETTLE_COUNT) {
 		/* Initial wait to reach some stability in PPB. The value of
 		 * INITIAL_PPB_SETTLE_COUNT is chosen based on tuning.
 		 */
-		iterations++;
+		g_sample.flags = JAPLL_TELEMETRY_SETTLING;
+		g_iterations++;
 
-	} else if (iterations == INITIAL_PPB_SETTLE_COUNT) {
+	} else if (g_iterations == INITIAL_PPB_SETTLE_COUNT) {
 		/* Once PPB is stable, we take it as input for JAPLL fraction PRESET.
 		 * The integer and frac parts were calculated once in the beginning.
 		 * The integer part is written to JAPLL_9_INT_PRESET register
 		 * while the fraction to the JAPLL_8_INT_PRESET register.
 		 */
 		if (g_japll.japll_wr_enable) {
-			calculate_japll_presets(ppb);
+			if (g_pi_conf.fixed_point)
+				calculate_japll_presets_fixed(ppb_q);
+			else
+				calculate_japll_presets(ppb);
 			status = configure_japll();
 			if (status)
 				pr_err("configure_japll failed: %m\n");
 		}
 
-		iterations++;
+		g_iterations++;
 
-	} else if (iterations > INITIAL_PPB_SETTLE_COUNT) {
+	} else if (g_iterations > INITIAL_PPB_SETTLE_COUNT) {
 
-		if (!(iterations % APPLY_PPB_STEP_SIZE)) {
+		if (!(g_iterations % APPLY_PPB_STEP_SIZE) && g_pi_conf.fixed_point) {
+			if (g_pi_conf.pi_enable)
+				n_freq_q = pi_controller_fixed(ppb_q);
+			else
+				n_freq_q = ppb_q;
+			g_sample.ppb_out = (double)n_freq_q / (1 << PPB_Q);
+
+			if (g_japll.japll_wr_enable) {
+				calculate_japll_presets_fixed(n_freq_q);
+				status = configure_japll();
+				if (status)
+					pr_err("configure_japll failed: %m");
+			}
+		} else if (!(g_iterations % APPLY_PPB_STEP_SIZE)) {
 			if (g_pi_conf.pi_enable)
 				n_freq = pi_controller(ppb);
 			else
 				n_freq = ppb;
+			g_sample.ppb_out = n_freq;
 
 			if (g_japll.japll_wr_enable) {
 				calculate_japll_presets(n_freq);
@@ -353,13 +602,415 @@ int japll_main(double ppb)
 			}
 		}
 
-		if (++iterations == INT_MAX)
-			iterations = INITIAL_PPB_SETTLE_COUNT + 1;
+		if (++g_iterations == INT_MAX)
+			g_iterations = INITIAL_PPB_SETTLE_COUNT + 1;
+	}
+
+	if (g_telemetry.hdr) {
+		g_sample.integer = g_japll.integer;
+		g_sample.fraction = g_japll.fraction;
+		japll_telemetry_append(&g_telemetry, &g_sample);
 	}
 
 	return status;
 }
 
+/*
+ *  Fetch the ptp4l settings the management client has to match
+ */
+int get_ptp4l_configuration(void)
+{
+	FILE *fp;
+	char line[256];
+	char key[64];
+	char value[108];
+
+	fp = fopen(g_pi_conf.ptp4l_config, "r");
+	if (!fp) {
+		pr_err("Cannot open %s: %m", g_pi_conf.ptp4l_config);
+		return errno;
+	}
+
+	while (fgets(line, sizeof(line), fp)) {
+		if (sscanf(line, "%63s %107s", key, value) != 2 || key[0] == '#')
+			continue;
+
+		if (!(strcmp(key, "uds_address")))
+			strcpy(g_ptp.uds_address, value);
+		else if (!(strcmp(key, "domainNumber")))
+			g_ptp.domain = strtol(value, NULL, 0);
+		else if (!(strcmp(key, "transportSpecific")))
+			g_ptp.transport = strtol(value, NULL, 0);
+		else if (!(strcmp(key, "time_stamping")))
+			g_ptp.sw_timestamping = !strcmp(value, "software");
+	}
+	fclose(fp);
+
+	pr_info("ptp4l uds_address : %s, domainNumber : %d, transportSpecific : 0x%x",
+			g_ptp.uds_address, g_ptp.domain, g_ptp.transport);
+
+	return 0;
+}
+
+/*
+ * Open the PTP hardware clock of eth_interface, which is what ptp4l servos
+ * and timestamps sync messages with, unless it uses software timestamping.
+ */
+int phc_open(void)
+{
+	struct ethtool_ts_info info = { .cmd = ETHTOOL_GET_TS_INFO };
+	struct ifreq ifr = {};
+	char device[32];
+	int fd;
+
+	if (g_ptp.sw_timestamping) {
+		g_ptp.clkid = CLOCK_REALTIME;
+		return 0;
+	}
+
+	fd = socket(AF_INET, SOCK_DGRAM, 0);
+	if (fd < 0) {
+		pr_err("socket failed: %m");
+		return errno;
+	}
+	snprintf(ifr.ifr_name, sizeof(ifr.ifr_name), "%s", g_pi_conf.eth_interface);
+	ifr.ifr_data = (char *)&info;
+	if (ioctl(fd, SIOCETHTOOL, &ifr) < 0) {
+		pr_err("ETHTOOL_GET_TS_INFO on %s failed: %m", g_pi_conf.eth_interface);
+		close(fd);
+		return errno;
+	}
+	close(fd);
+
+	if (info.phc_index < 0) {
+		pr_err("%s has no PTP hardware clock", g_pi_conf.eth_interface);
+		return ENODEV;
+	}
+
+	snprintf(device, sizeof(device), "/dev/ptp%d", info.phc_index);
+	g_ptp.phc_fd = open(device, O_RDWR);
+	if (g_ptp.phc_fd < 0) {
+		pr_err("%s open failed: %m", device);
+		return errno;
+	}
+	g_ptp.clkid = FD_TO_CLOCKID(g_ptp.phc_fd);
+	pr_info("using %s of %s", device, g_pi_conf.eth_interface);
+
+	return 0;
+}
+
+void phc_close(void)
+{
+	if (g_ptp.phc_fd >= 0)
+		close(g_ptp.phc_fd);
+	g_ptp.phc_fd = -1;
+}
+
+/*
+ * Frequency adjustment ptp4l's servo last applied to the clock. ptp4l
+ * applies the negated servo output, so negate it back to get the value
+ * printed as "freq" in the ptp4l -m output.
+ */
+int clock_read_ppb(double *ppb)
+{
+	struct timex tx = {};
+
+	if (clock_adjtime(g_ptp.clkid, &tx) < 0)
+		return errno;
+
+	/* tx.freq is in ppm with a 16 bit fractional part */
+	*ppb = -tx.freq / 65.536;
+
+	return 0;
+}
+
+int64_t clock_now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(g_ptp.clkid, &ts);
+
+	return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+void latency_print(void)
+{
+	if (!g_ptp.lat_count)
+		return;
+
+	pr_info("sync to JAPLL update latency over %lu samples: min %.1f avg %.1f max %.1f us",
+			g_ptp.lat_count, g_ptp.lat_min / 1000.0,
+			g_ptp.lat_sum / 1000.0 / g_ptp.lat_count, g_ptp.lat_max / 1000.0);
+}
+
+/*
+ * Pair the ingress time of a sync message with the JAPLL update made for
+ * it. In text mode the notification may arrive before or after the log
+ * line, so whichever comes second completes the pair.
+ */
+void latency_pair(void)
+{
+	int64_t latency;
+
+	if (!g_ptp.ingress_ns || !g_ptp.update_ns)
+		return;
+
+	latency = g_ptp.update_ns - g_ptp.ingress_ns;
+	if (latency < 0) {
+		/* this update was for an earlier sync */
+		g_ptp.update_ns = 0;
+		return;
+	}
+	g_ptp.ingress_ns = 0;
+	g_ptp.update_ns = 0;
+	if (latency > LATENCY_PAIR_MAX_NS)
+		return;
+
+	if (!g_ptp.lat_count || latency < g_ptp.lat_min)
+		g_ptp.lat_min = latency;
+	if (latency > g_ptp.lat_max)
+		g_ptp.lat_max = latency;
+	g_ptp.lat_sum += latency;
+
+	if (!(++g_ptp.lat_count % LATENCY_REPORT_SAMPLES))
+		latency_print();
+}
+
+void latency_sync(int64_t ingress_ns)
+{
+	g_ptp.ingress_ns = ingress_ns;
+	latency_pair();
+}
+
+void latency_update(void)
+{
+	g_ptp.update_ns = clock_now_ns();
+	latency_pair();
+}
+
+/*
+ * Subscribe to ptp4l time sync notifications, retrying while ptp4l is
+ * still creating its management socket.
+ */
+int ptp4l_subscribe(void)
+{
+	int status;
+	int waited;
+
+	status = ptp4l_mgmt_open(&g_ptp.mgmt, g_ptp.uds_address, g_ptp.domain,
+			g_ptp.transport);
+	if (status) {
+		pr_err("ptp4l management socket failed: %s", strerror(status));
+		return status;
+	}
+
+	for (waited = 0; waited < PTP4L_START_TIMEOUT_MS; waited += PTP4L_RETRY_MS) {
+		status = ptp4l_mgmt_subscribe(&g_ptp.mgmt);
+		if (status != ENOENT && status != ECONNREFUSED)
+			break;
+		usleep(PTP4L_RETRY_MS * 1000);
+	}
+	if (status) {
+		pr_err("subscribing to %s failed: %s", g_ptp.uds_address, strerror(status));
+		ptp4l_mgmt_close(&g_ptp.mgmt);
+		return status;
+	}
+	pr_info("subscribed to time sync notifications of %s", g_ptp.uds_address);
+
+	return 0;
+}
+
+/*
+ * Take in whatever notifications are queued without blocking, used to
+ * timestamp sync messages while the samples come from the text output.
+ */
+void ptp4l_drain(void)
+{
+	struct ptp4l_time_status ts;
+	int status;
+
+	if (g_ptp.mgmt.fd < 0)
+		return;
+
+	ptp4l_mgmt_renew(&g_ptp.mgmt);
+	do {
+		status = ptp4l_mgmt_recv(&g_ptp.mgmt, &ts, MSG_DONTWAIT);
+		if (!status)
+			latency_sync(ts.ingress_time);
+	} while (!status || status == ENOMSG || status == EPROTO);
+}
+
+/*
+ * Bucket of an arrival to write interval, and the lower bound of a bucket.
+ */
+int jitter_bucket(int64_t ns)
+{
+	int msb;
+
+	if (ns < (1LL << JITTER_MIN_SHIFT))
+		return 0;
+	msb = 63 - __builtin_clzll(ns);
+	if (msb >= JITTER_MAX_SHIFT)
+		return JITTER_BUCKETS - 1;
+
+	return 1 + ((msb - JITTER_MIN_SHIFT) << JITTER_SUB_BITS) +
+		((ns >> (msb - JITTER_SUB_BITS)) & ((1 << JITTER_SUB_BITS) - 1));
+}
+
+int64_t jitter_bucket_ns(int bucket)
+{
+	int octave, sub;
+
+	if (!bucket)
+		return 0;
+	octave = (bucket - 1) >> JITTER_SUB_BITS;
+	sub = (bucket - 1) & ((1 << JITTER_SUB_BITS) - 1);
+
+	return (int64_t)((1 << JITTER_SUB_BITS) + sub) << (JITTER_MIN_SHIFT + octave - JITTER_SUB_BITS);
+}
+
+/*
+ * Upper bound of the interval below which 'permille' of the samples fall.
+ */
+double jitter_percentile_us(int permille)
+{
+	unsigned long target = (g_rt.count * permille + 999) / 1000, sum = 0;
+	int i;
+
+	for (i = 0; i < JITTER_BUCKETS - 1; i++) {
+		sum += g_rt.hist[i];
+		if (sum >= target && jitter_bucket_ns(i + 1) <= g_rt.max)
+			return jitter_bucket_ns(i + 1) / 1000.0;
+		if (sum >= target)
+			break;
+	}
+
+	return g_rt.max / 1000.0;
+}
+
+void jitter_print(bool histogram)
+{
+	unsigned long sum = 0;
+	int i;
+
+	if (!g_rt.count)
+		return;
+
+	pr_info("sample to JAPLL write over %lu samples: min %.1f p50 %.1f p99 %.1f p99.9 %.1f max %.1f us",
+			g_rt.count, g_rt.min / 1000.0, jitter_percentile_us(500),
+			jitter_percentile_us(990), jitter_percentile_us(999), g_rt.max / 1000.0);
+	if (!histogram)
+		return;
+
+	for (i = 0; i < JITTER_BUCKETS; i++) {
+		if (!g_rt.hist[i])
+			continue;
+		sum += g_rt.hist[i];
+		if (i == JITTER_BUCKETS - 1)
+			pr_info("  %10.3f us and above %10lu %8.3f%%",
+					jitter_bucket_ns(i) / 1000.0, g_rt.hist[i], 100.0 * sum / g_rt.count);
+		else
+			pr_info("  %10.3f - %10.3f us %10lu %8.3f%%",
+					jitter_bucket_ns(i) / 1000.0, jitter_bucket_ns(i + 1) / 1000.0,
+					g_rt.hist[i], 100.0 * sum / g_rt.count);
+	}
+}
+
+/*
+ * Count the interval from the arrival of the sample just handed to
+ * japll_main() to the JAPLL register write it caused, if any.
+ */
+void jitter_update(void)
+{
+	int64_t interval;
+
+	if (!g_pi_conf.jitter_report || !g_rt.write_ns || g_rt.write_ns < g_rt.arrival_ns)
+		return;
+
+	interval = g_rt.write_ns - g_rt.arrival_ns;
+	g_rt.write_ns = 0;
+
+	if (!g_rt.count || interval < g_rt.min)
+		g_rt.min = interval;
+	if (interval > g_rt.max)
+		g_rt.max = interval;
+	g_rt.hist[jitter_bucket(interval)]++;
+
+	if (!(++g_rt.count % JITTER_REPORT_SAMPLES))
+		jitter_print(false);
+}
+
+void jitter_arrival(void)
+{
+	if (g_pi_conf.jitter_report)
+		g_rt.arrival_ns = japll_telemetry_clock_ns(CLOCK_MONOTONIC);
+}
+
+/*
+ * Touch the stack the servo loop will use, so that with mlockall() it
+ * never takes a page fault.
+ */
+void __attribute__((noinline)) rt_prefault_stack(void)
+{
+	unsigned char stack[RT_STACK_PREFAULT];
+
+	memset(stack, 0, sizeof(stack));
+	/* keep the stores, the array is never read */
+	__asm__ __volatile__("" : : "r" (stack) : "memory");
+}
+
+/*
+ * Move the calling thread, the one running the servo, to SCHED_FIFO on
+ * rt_cpu and lock all memory. Scheduling policy and affinity are per
+ * thread, so the logging thread and the ptp4l child keep theirs.
+ */
+int rt_setup(void)
+{
+	struct sched_param param = { .sched_priority = g_pi_conf.rt_priority };
+	cpu_set_t cpus;
+	int status;
+
+	if (g_pi_conf.rt_cpu >= 0) {
+		CPU_ZERO(&cpus);
+		CPU_SET(g_pi_conf.rt_cpu, &cpus);
+		status = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+		if (status) {
+			pr_err("cannot pin to hart %d: %s", g_pi_conf.rt_cpu, strerror(status));
+			return status;
+		}
+	}
+
+	if (mlockall(MCL_CURRENT | MCL_FUTURE)) {
+		pr_err("mlockall failed: %m");
+		return errno;
+	}
+	rt_prefault_stack();
+
+	status = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+	if (status) {
+		pr_err("cannot switch to SCHED_FIFO priority %d: %s",
+				g_pi_conf.rt_priority, strerror(status));
+		return status;
+	}
+
+	pr_info("running at SCHED_FIFO priority %d on hart %d", g_pi_conf.rt_priority,
+			g_pi_conf.rt_cpu);
+
+	return 0;
+}
+
+/*
+ * Forget all servo state, as if japll_main() had not been called yet.
+ */
+void japll_reset(void)
+{
+	g_iterations = 0;
+	g_integral = 0.0;
+	g_fixed.integral = 0;
+	g_japll.is_int_written = false;
+	g_japll.is_frac_written = false;
+}
+
 int memory_map(void)
 {
 	g_japll.uioFd_0 = open(UIO_0_DEVICE, O_RDWR);
@@ -387,62 +1038,37 @@ void memory_unmap(void)
 		munmap((void *)g_japll.mem_ptr0, MMAP_SIZE);
 		pr_info("memory unmapped successfully");
 	}
+	mmio_trace_dump(MMIO_TRACE_FILE);
 }
 
+/*
+ * Only flag the request, the source loops see it when their blocking
+ * read fails with EINTR and return to the cleanup in main().
+ */
 void handle_sigint(int sig)
 {
-	memory_unmap();
-	pr_info("******* exit with ctrl+C *******");
-	exit(EXIT_SUCCESS);
+	g_stop = 1;
 }
 
-int main(void)
+/*
+ * Take the frequency from the "freq" column of the ptp4l -m output.
+ */
+int run_text_source(FILE *fp)
 {
-	FILE *fp;
 	char  p_buf[128] = {};
 	char *freq_str = NULL;
 	char *end_ptr = NULL;
 	char *col_data = NULL;
 	double freq = 0.0;
-	int status = 0;
-	char command[100] = {};
-
-	signal(SIGINT, handle_sigint);
-
-	if (!(g_pi_conf.is_read)) {
-		status = get_pi_configuration();
-		if (status) {
-			pr_err("get_pi_configuration failed: %m");
-			return errno;
-		}
-	}
-
-	status = memory_map();
-	if (status)
-		g_japll.japll_wr_enable = 0;
-	else {
-		calculate_japll_initial_presets();
-		/* NOTE : Depending on whether the Fabric design initializes JAPLL (INT and FRAC)
-		 * Preset values, the respective flags i.e., g_japll.is_int_written and
-		 * g_japll.is_frac_written can be set here, before calling configure_japll().
-		 */
-	}
-
-	/* Launch ptp4l */
-	snprintf(command, sizeof(command), "ptp4l -i %s -m -s -f %s",
-			g_pi_conf.eth_interface, g_pi_conf.ptp4l_config);
-	pr_info("Going to launch: %s", command);
-	fp = popen(command, "r");
-	if (fp == NULL) {
-		pr_err("Failed to launch ptp4l\n");
-		memory_unmap();
-		exit(EXIT_FAILURE);
-	}
 
 	/* Read the output a line at a time - output it. */
-	while (fgets(p_buf, sizeof(p_buf), fp) != NULL) {
+	while (!g_stop && fgets(p_buf, sizeof(p_buf), fp) != NULL) {
+		jitter_arrival();
 		pr_info("p_buf = %s", p_buf);
 
+		if (g_pi_conf.latency_report)
+			ptp4l_drain();
+
 		/*NOTE: If required, an additional pre-check may be added to discard
 		 * false positives in the beginning itself, for e.g.,
 		 * by searching 'master offset'.
@@ -464,8 +1090,7 @@ int main(void)
 		freq = strtol(col_data, &end_ptr, 10);
 		if (errno != 0) {
 			pr_err("strtol error: %d", errno);
-			memory_unmap();
-			exit(EXIT_FAILURE);
+			return EXIT_FAILURE;
 		}
 
 		/* This will discard the false positives i.e, lines
@@ -479,7 +1104,177 @@ int main(void)
 		pr_debug("freq : %lf", freq);
 
 		japll_main(freq);
+		jitter_update();
+
+		if (g_pi_conf.latency_report) {
+			latency_update();
+			ptp4l_drain();
+		}
+	}
+
+	return EXIT_SUCCESS;
+}
+
+/*
+ * Run once per TIME_STATUS_NP notification, that is once per servo
+ * update of ptp4l, taking the frequency straight from the servoed clock.
+ * ptp4l's stdout is watched too, it reaches EOF when ptp4l exits.
+ */
+int run_uds_source(FILE *fp)
+{
+	struct ptp4l_time_status ts;
+	struct pollfd pfd[2] = {
+		{ .fd = g_ptp.mgmt.fd, .events = POLLIN },
+		{ .fd = fileno(fp), .events = POLLIN },
+	};
+	char discard[256];
+	double freq = 0.0;
+	int status;
+
+	while (!g_stop) {
+		status = ptp4l_mgmt_renew(&g_ptp.mgmt);
+		if (status)
+			pr_warning("renewing ptp4l subscription failed: %s", strerror(status));
+
+		if (poll(pfd, 2, PTP4L_MGMT_SUBSCRIBE_SEC / 3 * 1000) <= 0)
+			continue;
+
+		if (pfd[1].revents) {
+			/* nothing is expected without -m, but do not let it fill the pipe */
+			if (read(pfd[1].fd, discard, sizeof(discard)) == 0) {
+				status = pclose(fp);
+				pr_err("ptp4l exited, status %d",
+						WIFEXITED(status) ? WEXITSTATUS(status) : status);
+				return EXIT_FAILURE;
+			}
+		}
+		if (!(pfd[0].revents & POLLIN))
+			continue;
+		jitter_arrival();
+
+		status = ptp4l_mgmt_recv(&g_ptp.mgmt, &ts, 0);
+		if (status == EPROTO) {
+			pr_err("ptp4l rejected the subscription, needs linuxptp v3.1 or later");
+			return EXIT_FAILURE;
+		}
+		if (status)
+			continue;
+
+		status = clock_read_ppb(&freq);
+		if (status) {
+			pr_err("clock_adjtime failed: %s", strerror(status));
+			return EXIT_FAILURE;
+		}
+
+		pr_debug("master offset : %lld, freq : %lf", (long long)ts.master_offset, freq);
+
+		japll_main(freq);
+		jitter_update();
+
+		if (g_pi_conf.latency_report) {
+			latency_sync(ts.ingress_time);
+			latency_update();
+		}
 	}
 
 	return EXIT_SUCCESS;
 }
+
+#ifndef JAPLL_NO_MAIN
+int main(void)
+{
+	struct sigaction sa = { .sa_handler = handle_sigint };
+	FILE *fp;
+	bool use_uds;
+	int status = 0;
+	char command[100] = {};
+
+	/* no SA_RESTART, the blocking reads of the sources must return */
+	sigemptyset(&sa.sa_mask);
+	sigaction(SIGINT, &sa, NULL);
+	sigaction(SIGTERM, &sa, NULL);
+
+	if (!(g_pi_conf.is_read)) {
+		status = get_pi_configuration(JAPLL_PI_CONFIG_FILE);
+		if (status) {
+			pr_err("get_pi_configuration failed: %m");
+			return errno;
+		}
+	}
+
+	if (g_pi_conf.async_log) {
+		status = log_set_async(1);
+		if (status)
+			pr_warning("asynchronous logging unavailable: %s", strerror(status));
+	}
+
+	if (g_pi_conf.telemetry_file[0]) {
+		status = japll_telemetry_open(&g_telemetry, g_pi_conf.telemetry_file,
+				g_pi_conf.telemetry_records);
+		if (status)
+			pr_warning("telemetry disabled, cannot map %s: %s",
+					g_pi_conf.telemetry_file, strerror(status));
+	}
+
+	use_uds = !strcmp(g_pi_conf.ptp4l_source, "uds");
+	if (use_uds || g_pi_conf.latency_report) {
+		status = get_ptp4l_configuration();
+		if (!status)
+			status = phc_open();
+		if (status) {
+			pr_err("cannot reach the clock servoed by ptp4l");
+			return status;
+		}
+	}
+
+	status = memory_map();
+	if (status)
+		g_japll.japll_wr_enable = 0;
+	else {
+		calculate_japll_initial_presets();
+		/* NOTE : Depending on whether the Fabric design initializes JAPLL (INT and FRAC)
+		 * Preset values, the respective flags i.e., g_japll.is_int_written and
+		 * g_japll.is_frac_written can be set here, before calling configure_japll().
+		 */
+	}
+
+	/* Launch ptp4l, it only has to print its servo output for the text source */
+	snprintf(command, sizeof(command), "ptp4l -i %s%s -s -f %s",
+			g_pi_conf.eth_interface, use_uds ? "" : " -m", g_pi_conf.ptp4l_config);
+	pr_info("Going to launch: %s", command);
+	fp = popen(command, "r");
+	if (fp == NULL) {
+		pr_err("Failed to launch ptp4l\n");
+		memory_unmap();
+		exit(EXIT_FAILURE);
+	}
+
+	if (use_uds || g_pi_conf.latency_report) {
+		status = ptp4l_subscribe();
+		if (status && use_uds) {
+			memory_unmap();
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	/* after launching ptp4l, which would inherit the policy and affinity */
+	if (g_pi_conf.rt_priority > 0 && rt_setup())
+		pr_warning("real-time setup incomplete, see above");
+
+	if (use_uds)
+		status = run_uds_source(fp);
+	else
+		status = run_text_source(fp);
+
+	latency_print();
+	jitter_print(true);
+	ptp4l_mgmt_close(&g_ptp.mgmt);
+	phc_close();
+	japll_telemetry_close(&g_telemetry);
+	memory_unmap();
+	if (g_stop)
+		pr_info("******* exit with ctrl+C *******");
+
+	return status;
+}
+#endif /* JAPLL_NO_MAIN */
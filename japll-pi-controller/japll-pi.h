@@ -0,0 +1,101 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * @file japll-pi.h
+ * @brief JAPLL PI controller shared with the replay harness
+ * Copyright (C) 2025 Microchip Technology Inc. and its subsidiaries
+ */
+
+#ifndef __JAPLL_PI_H
+#define __JAPLL_PI_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/******************************************************************
+ * Configuration File parameters and PI Controller related
+ ******************************************************************/
+#define INITIAL_PPB_SETTLE_COUNT      1
+#define APPLY_PPB_STEP_SIZE           1
+#define JAPLL_PI_CONFIG_FILE          "/opt/microchip/japll-pi-controller/configs/japll-pi.cfg"
+
+struct g_pi_conf_t {
+	bool   is_read;             /* indicate whether to read configuration file or not */
+	int    pi_enable;           /* indicate use of MCHP pi controller*/
+	double k_proportional;      /* constant for proportion */
+	double k_integral;          /* constant for integration */
+	double set_point;           /* target value to achieve */
+	double delta_time;          /* time instance for integral : 1 / ptp packets per sec */
+	float  board_ref_clk_freq;  /* reference clock frequency to JAPLL */
+	char   eth_interface[10];   /* ethernet driver interface for input to ptp4l command */
+	char   ptp4l_config[50];    /* filename along with path for input to ptp4l command */
+	char   ptp4l_source[8];     /* "text" to parse ptp4l -m output, "uds" for management socket */
+	int    latency_report;      /* report sync message to JAPLL update latency */
+	int    fixed_point;         /* use the integer preset and PI computation */
+	int    async_log;           /* format and write log messages on a background thread */
+	char   telemetry_file[64];  /* ring file for per sample telemetry, none if empty */
+	unsigned int telemetry_records; /* records kept in telemetry_file */
+	int    rt_priority;         /* SCHED_FIFO priority of the servo thread, 0 for SCHED_OTHER */
+	int    rt_cpu;              /* hart the servo thread is pinned to, -1 for any */
+	int    jitter_report;       /* report the sample arrival to JAPLL write distribution */
+};
+
+/******************************************************************
+ * JAPLL configuration parameters and related
+ ******************************************************************/
+#define MMAP_SIZE                      0x100
+
+#define JAPLL_9_INT_PRESET             0xE         /* Reg Offset:0x38 / sizeof(int) */
+#define JAPLL_8_FRAC_PRESET            0xD         /* Reg Offset:0x34 / sizeof(int) */
+#define JAPLL_8_PRESET_DISABLE         0xFEFFFFFF  /* Disabling TXPLL_JA_PRESET_EN (bit:24) Reg */
+#define JAPLL_8_HOLD_ENABLE            0x02000000  /* Enabling TXPLL_JA_HOLD_EN (bit:25) Reg */
+/* Enabling TXPLL_JA_HOLD (bit:25) and TXPLL_JA_PRESET_EN (bit:24) Regs */
+#define JAPLL_8_HOLD_PRESET_ENABLE     0x03000000
+/* To read only 24-29 bits from register */
+#define TXPLL_REF_DIV(x)               ((x & 0x3F000000) >> 24)
+#define TXPLL_DIV_2                    0x5         /* Reg Offset : 0x14 / sizeof(int) */
+#define FRAC_DIVIDER                   1000000000.0
+#define TSU_CLK_FREQ                   125.0
+#define BIT_CLK_FREQ_MULT              (10 * 2)
+#define JAPLL_INT_WIDTH_BITS           12
+#define JAPLL_FRAC_WIDTH_BITS          24
+#define JAPLL_FRAC_ONE                 (1 << JAPLL_FRAC_WIDTH_BITS)
+#define JAPLL_FRAC_MASK                (JAPLL_FRAC_ONE - 1)
+
+/*
+ * Fixed point representation of the preset and PI computation:
+ * ppb values in Q.16, the total preset in Q.40 so that the 24 fraction
+ * bits of JAPLL_8_FRAC_PRESET are its top fraction bits, and gains in Q.32.
+ * The preset for PPB = 0 divided by FRAC_DIVIDER is kept in Q.72, which
+ * makes the per sample product with a Q.16 ppb a Q.88 value.
+ */
+#define PPB_Q                          16
+#define PRESET_Q                       40
+#define GAIN_Q                         32
+#define PPB_SCALE_Q                    72
+#define PPB_SCALE_SHIFT                (PPB_SCALE_Q + PPB_Q - PRESET_Q)
+
+struct g_japll_t {
+	int      uioFd_0;             /* to store file descriptor for UIO device */
+	uint32_t *mem_ptr0;           /* to map JAPLL UIO device memory */
+	int      integer;             /* to store integer part of PPB value */
+	int      fraction;            /* to store fraction part of PPB value */
+	bool     is_int_written;      /* ensure integer has been written earlier */
+	bool     is_frac_written;     /* ensure fraction has been written earlier */
+	double   japll_preset_ppb_0;  /* indicate preset value of JAPLL for PPB value 0 */
+	int      japll_wr_enable;     /* indicate use of JAPLL functionality */
+};
+
+extern struct g_pi_conf_t g_pi_conf;
+extern struct g_japll_t g_japll;
+
+int get_pi_configuration(const char *path);
+void calculate_japll_initial_presets(void);
+double pi_controller(double input_val);
+int64_t pi_controller_fixed(int64_t input_val);
+double japll_preset_split(double ppb, int *integer, int *fraction);
+void japll_preset_split_fixed(int64_t ppb, int *integer, int *fraction);
+void japll_fixed_init(void);
+int japll_main(double ppb);
+void japll_reset(void);
+
+#endif /* __JAPLL_PI_H */
@@ -0,0 +1,675 @@
+// SPDX-License-Identifier: MIT
+/*
+ * @file japll-replay.c
+ * @brief replay recorded or synthetic frequency traces through the JAPLL PI servo
+ * Copyright (C) 2026 Microchip Technology Inc. and its subsidiaries
+ *
+ * Runs japll_main() offline, against a simulated register file, for every
+ * combination of the given k_proportional, k_integral and delta_time values
+ * and reports convergence time, overshoot and steady state jitter.
+ *
+ * With -t it searches for the gains instead: the grid is evaluated on all
+ * cores, then the best points are refined by a pattern search and the
+ * winner is written out in japll-pi.cfg format.
+ *
+ * With -C it checks the fixed point computation against the double one
+ * instead, see fixed_check().
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <math.h>
+#include <float.h>
+
+#include <sys/wait.h>
+
+#include "print.h"
+#include "japll-pi.h"
+#include "japll-sim.h"
+
+#define DEFAULT_SAMPLES     2000
+#define DEFAULT_TRACE       "step:1000"
+#define DEFAULT_SEED        1
+#define MAX_VALUES          1024
+
+#define TUNE_KP_GRID        "0.05:1.5:0.05"
+#define TUNE_KI_GRID        "0.05:4:0.05"
+#define TUNE_STARTS         4       /* best grid points refined */
+#define TUNE_ROUNDS         64      /* pattern search moves per start */
+#define TUNE_HALVINGS       8       /* step size reductions per start */
+#define TUNE_MAX_CROSSINGS  1       /* more swings than this is oscillation */
+#define TUNE_SETTLED_SHARE  50      /* % of the trace that must be settled */
+
+#define CHECK_SAMPLES       1000000         /* PI input sequence length for -C */
+#define CHECK_TRACE         "sine:1000:60"
+#define CHECK_NOISE         100.0
+#define CHECK_PRESET_PPB    1000000         /* ppb range of the preset comparison */
+#define CHECK_PRESET_LSB    1               /* both truncate, one LSB apart at a step */
+/*
+ * The fixed point integral is rounded to Q.16 every sample, half an LSB
+ * or 7.6e-6 ppb at most, to nearest even so that it has no bias. Those
+ * roundings random walk, to about 0.005 ppb rms after 10^6 samples. The
+ * bound leaves margin for the walk and stays below a JAPLL_8_FRAC_PRESET
+ * LSB: 3 ppb with TXPLL_REF_DIV 1 and 0.05 ppb with 63.
+ */
+#define CHECK_PI_PPB        0.04            /* PI output difference bound */
+
+struct value_list {
+	double  val[MAX_VALUES];
+	int     count;
+};
+
+struct tune_point {
+	double  gain[3];      /* k_proportional, k_integral, delta_time */
+	double  cost;
+	struct japll_sim_result res;
+};
+
+struct tune_ctx {
+	const struct japll_trace  *trace;
+	const struct japll_plant  *plant;
+	double  open_loop_rms;    /* rms error with no servo at all */
+	int     max_crossings;
+	double  step[3];          /* initial pattern search steps */
+};
+
+/*
+ * "a,b,c" or "start:stop:step"
+ */
+static int parse_list(const char *arg, struct value_list *list)
+{
+	double start, stop, step, v;
+	char *end;
+
+	list->count = 0;
+	if (sscanf(arg, "%lf:%lf:%lf", &start, &stop, &step) == 3) {
+		if (step <= 0.0 || stop < start)
+			return EINVAL;
+		/* half a step of slack so that 'stop' itself is included */
+		for (v = start; v <= stop + step / 2 && list->count < MAX_VALUES; v += step)
+			list->val[list->count++] = v;
+		return 0;
+	}
+
+	while (*arg && list->count < MAX_VALUES) {
+		list->val[list->count++] = strtod(arg, &end);
+		if (end == arg || (*end && *end != ','))
+			return EINVAL;
+		arg = *end ? end + 1 : end;
+	}
+
+	return list->count ? 0 : EINVAL;
+}
+
+static double list_step(const struct value_list *list)
+{
+	if (list->count > 1)
+		return (list->val[list->count - 1] - list->val[0]) / (list->count - 1);
+	return list->val[0] / 4;
+}
+
+/*
+ * Settling time and rms error, both relative to the trace, summed. Points
+ * that settle too late to leave TUNE_SETTLED_SHARE of the trace settled,
+ * or swing across the tolerance band more than allowed, are rejected.
+ */
+static void tune_eval(const struct tune_ctx *ctx, struct tune_point *pt)
+{
+	double duration = ctx->trace->len / ctx->trace->rate;
+
+	g_pi_conf.k_proportional = pt->gain[0];
+	g_pi_conf.k_integral = pt->gain[1];
+	g_pi_conf.delta_time = pt->gain[2];
+	japll_sim_run(ctx->trace, ctx->plant, &pt->res);
+
+	if (pt->res.settle_s < 0 ||
+	    pt->res.settle_s > duration * (100 - TUNE_SETTLED_SHARE) / 100 ||
+	    pt->res.crossings > ctx->max_crossings)
+		pt->cost = DBL_MAX;
+	else
+		pt->cost = pt->res.settle_s / duration + pt->res.rms / ctx->open_loop_rms;
+}
+
+/*
+ * Move to a better neighbour along one gain at a time, halving the steps
+ * when none of them is better.
+ */
+static void tune_refine(const struct tune_ctx *ctx, struct tune_point *best)
+{
+	double step[3] = { ctx->step[0], ctx->step[1], ctx->step[2] };
+	struct tune_point pt;
+	int round, halvings = 0, dim, dir, improved;
+
+	for (round = 0; round < TUNE_ROUNDS && halvings < TUNE_HALVINGS; round++) {
+		improved = 0;
+		for (dim = 0; dim < 3; dim++) {
+			for (dir = -1; dir <= 1 && step[dim] > 0; dir += 2) {
+				pt = *best;
+				pt.gain[dim] += dir * step[dim];
+				if (pt.gain[dim] <= 0)
+					continue;
+				tune_eval(ctx, &pt);
+				if (pt.cost < best->cost) {
+					*best = pt;
+					improved = 1;
+				}
+			}
+		}
+		if (!improved) {
+			for (dim = 0; dim < 3; dim++)
+				step[dim] /= 2;
+			halvings++;
+		}
+	}
+}
+
+static int read_full(int fd, void *buf, size_t len)
+{
+	ssize_t ret;
+
+	while (len) {
+		ret = read(fd, buf, len);
+		if (ret <= 0)
+			return ret ? errno : EPIPE;
+		buf = (char *)buf + ret;
+		len -= ret;
+	}
+
+	return 0;
+}
+
+/*
+ * Evaluate, or with 'refine' set refine, 'count' points on 'jobs' forked
+ * workers, each handling a contiguous share and sending its points back
+ * through a pipe.
+ */
+static int tune_parallel(const struct tune_ctx *ctx, struct tune_point *pts,
+			 int count, int jobs, int refine)
+{
+	int fds[jobs][2];
+	pid_t pids[jobs];
+	int j, i, first, last, status = 0;
+	ssize_t ret;
+
+	if (jobs > count)
+		jobs = count;
+
+	for (j = 0; j < jobs; j++) {
+		first = count * j / jobs;
+		last = count * (j + 1) / jobs;
+		if (pipe(fds[j]))
+			return errno;
+		fflush(stdout);
+		pids[j] = fork();
+		if (pids[j] < 0)
+			return errno;
+		if (!pids[j]) {
+			close(fds[j][0]);
+			for (i = first; i < last; i++) {
+				if (refine)
+					tune_refine(ctx, &pts[i]);
+				else
+					tune_eval(ctx, &pts[i]);
+			}
+			ret = write(fds[j][1], &pts[first], (last - first) * sizeof(*pts));
+			_exit(ret == (last - first) * (ssize_t)sizeof(*pts) ? 0 : 1);
+		}
+		close(fds[j][1]);
+	}
+
+	for (j = 0; j < jobs; j++) {
+		first = count * j / jobs;
+		last = count * (j + 1) / jobs;
+		if (!status)
+			status = read_full(fds[j][0], &pts[first], (last - first) * sizeof(*pts));
+		close(fds[j][0]);
+		waitpid(pids[j], NULL, 0);
+	}
+
+	return status;
+}
+
+static int cmp_cost(const void *a, const void *b)
+{
+	const struct tune_point *pa = a, *pb = b;
+
+	return (pa->cost > pb->cost) - (pa->cost < pb->cost);
+}
+
+/*
+ * Copy 'config', or write a bare file if there is none, with the gains
+ * replaced by the tuned ones.
+ */
+static int write_config(const char *path, const char *config, const struct tune_point *best)
+{
+	static const char * const keys[] = { "k_proportional", "k_integral", "delta_time" };
+	int written[3] = {};
+	char line[256], key[64];
+	FILE *in = NULL, *out = stdout;
+	int k;
+
+	if (path) {
+		out = fopen(path, "w");
+		if (!out) {
+			fprintf(stderr, "cannot open %s: %s\n", path, strerror(errno));
+			return errno;
+		}
+	}
+
+	if (config)
+		in = fopen(config, "r");
+	if (!in)
+		fprintf(out, "#\n# PI controller constants found by japll-replay -t\n#\n");
+
+	while (in && fgets(line, sizeof(line), in)) {
+		if (sscanf(line, "%63s", key) == 1) {
+			for (k = 0; k < 3; k++) {
+				if (!strcmp(key, keys[k]))
+					break;
+			}
+			if (k < 3) {
+				fprintf(out, "%-24s%g\n", keys[k], best->gain[k]);
+				written[k] = 1;
+				continue;
+			}
+		}
+		fputs(line, out);
+	}
+	for (k = 0; k < 3; k++) {
+		if (!written[k])
+			fprintf(out, "%-24s%g\n", keys[k], best->gain[k]);
+	}
+
+	if (in)
+		fclose(in);
+	if (out != stdout)
+		fclose(out);
+
+	return 0;
+}
+
+static void print_point(const char *what, const struct tune_point *pt)
+{
+	printf("%-8s k_proportional %g k_integral %g delta_time %g: settle %.3f s, "
+	       "overshoot %.3f, jitter %.3f, rms %.3f ppb\n", what, pt->gain[0], pt->gain[1],
+	       pt->gain[2], pt->res.settle_s, pt->res.overshoot, pt->res.jitter, pt->res.rms);
+}
+
+static int tune(struct tune_ctx *ctx, const struct value_list *kp, const struct value_list *ki,
+		const struct value_list *dt, int jobs, const char *config, const char *output)
+{
+	struct tune_point *pts;
+	struct timespec t0, t1;
+	double sum_sq = 0.0, e;
+	int a, b, c, n = 0, count, starts, status;
+	size_t i;
+
+	for (i = 0; i < ctx->trace->len; i++) {
+		e = ctx->trace->ppb[i] - g_pi_conf.set_point;
+		sum_sq += e * e;
+	}
+	ctx->open_loop_rms = sqrt(sum_sq / ctx->trace->len);
+	if (ctx->open_loop_rms == 0.0)
+		ctx->open_loop_rms = 1.0;
+	ctx->step[0] = list_step(kp);
+	ctx->step[1] = list_step(ki);
+	ctx->step[2] = dt->count > 1 ? list_step(dt) : 0.0;
+
+	count = kp->count * ki->count * dt->count;
+	pts = calloc(count, sizeof(*pts));
+	if (!pts)
+		return ENOMEM;
+	for (a = 0; a < kp->count; a++) {
+		for (b = 0; b < ki->count; b++) {
+			for (c = 0; c < dt->count; c++) {
+				pts[n].gain[0] = kp->val[a];
+				pts[n].gain[1] = ki->val[b];
+				pts[n].gain[2] = dt->val[c];
+				n++;
+			}
+		}
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	status = tune_parallel(ctx, pts, count, jobs, 0);
+	if (status)
+		goto out;
+	qsort(pts, count, sizeof(*pts), cmp_cost);
+	if (pts[0].cost == DBL_MAX) {
+		fprintf(stderr, "none of the %d grid points settles without oscillating\n", count);
+		status = ERANGE;
+		goto out;
+	}
+	print_point("grid", &pts[0]);
+
+	for (starts = 0; starts < TUNE_STARTS && starts < count; starts++) {
+		if (pts[starts].cost == DBL_MAX)
+			break;
+	}
+	status = tune_parallel(ctx, pts, starts, jobs, 1);
+	if (status)
+		goto out;
+	qsort(pts, starts, sizeof(*pts), cmp_cost);
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+
+	print_point("refined", &pts[0]);
+	printf("%d grid points and %d refinements on %d jobs in %.3f s\n", count, starts, jobs,
+	       (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9);
+
+	status = write_config(output, config, &pts[0]);
+out:
+	free(pts);
+	return status;
+}
+
+/*
+ * Compare the fixed point presets with the double ones for every integer
+ * ppb in +/- CHECK_PRESET_PPB, as 36 bit int:frac values.
+ */
+static int fixed_check_presets(void)
+{
+	int d_int, d_frac, f_int, f_frac;
+	unsigned long exact = 0;
+	int64_t diff, max_diff = 0;
+	int ppb;
+
+	for (ppb = -CHECK_PRESET_PPB; ppb <= CHECK_PRESET_PPB; ppb++) {
+		japll_preset_split(ppb, &d_int, &d_frac);
+		japll_preset_split_fixed((int64_t)ppb << PPB_Q, &f_int, &f_frac);
+
+		diff = llabs((((int64_t)f_int << JAPLL_FRAC_WIDTH_BITS) + f_frac) -
+			     (((int64_t)d_int << JAPLL_FRAC_WIDTH_BITS) + d_frac));
+		if (!diff)
+			exact++;
+		if (diff > max_diff)
+			max_diff = diff;
+	}
+
+	printf("presets: %lu of %d exact, max difference %lld LSB (bound %d)\n",
+	       exact, 2 * CHECK_PRESET_PPB + 1, (long long)max_diff, CHECK_PRESET_LSB);
+
+	return max_diff > CHECK_PRESET_LSB ? ERANGE : 0;
+}
+
+/*
+ * Run pi_controller() and pi_controller_fixed() side by side over the
+ * trace, both fed the Q.16 input japll_main() would use, and compare
+ * their outputs. The recursion carries the integral term from sample to
+ * sample, so this also catches rounding that accumulates.
+ */
+static int fixed_check_pi(const struct japll_trace *trace)
+{
+	double lsb_ppb = FRAC_DIVIDER / (g_japll.japll_preset_ppb_0 * JAPLL_FRAC_ONE);
+	double d_out, f_out, diff, max_diff = 0.0, sum_sq = 0.0;
+	int64_t ppb_q;
+	size_t i;
+
+	japll_reset();
+	japll_fixed_init();
+	for (i = 0; i < trace->len; i++) {
+		ppb_q = trace->ppb[i] * (1 << PPB_Q);
+		d_out = pi_controller((double)ppb_q / (1 << PPB_Q));
+		f_out = (double)pi_controller_fixed(ppb_q) / (1 << PPB_Q);
+
+		diff = fabs(f_out - d_out);
+		sum_sq += diff * diff;
+		if (diff > max_diff)
+			max_diff = diff;
+	}
+
+	printf("PI output: %zu samples, max difference %.6f ppb, rms %.6f ppb (bound %g), "
+	       "frac preset LSB %.3f ppb\n", trace->len, max_diff, sqrt(sum_sq / trace->len),
+	       CHECK_PI_PPB, lsb_ppb);
+
+	return max_diff > CHECK_PI_PPB ? ERANGE : 0;
+}
+
+/*
+ * Check the fixed point computation against the double one, for the JAPLL
+ * given with -R and the gains of the configuration.
+ */
+static int fixed_check(const struct japll_trace *trace, const struct japll_plant *plant)
+{
+	int status;
+
+	g_pi_conf.fixed_point = 1;
+	japll_sim_init(plant);
+	printf("fixed point check, TXPLL_REF_DIV %d, k_proportional %g k_integral %g "
+	       "delta_time %g\n", plant->ref_div, g_pi_conf.k_proportional,
+	       g_pi_conf.k_integral, g_pi_conf.delta_time);
+
+	status = fixed_check_presets();
+	if (fixed_check_pi(trace))
+		status = ERANGE;
+	printf("%s\n", status ? "FAILED" : "passed");
+
+	return status;
+}
+
+static void usage(const char *prog)
+{
+	printf("usage: %s [-c japll-pi.cfg] [-p k_proportional] [-i k_integral] [-d delta_time]\n"
+	       "          [-s trace] [-n samples] [-N noise] [-r rate] [-g gain] [-a response]\n"
+	       "          [-R ref_div] [-T tolerance] [-F] [-t] [-j jobs] [-X crossings]\n"
+	       "          [-o output.cfg] [-C] [ptp4l.log]\n", prog);
+	printf("\t-c: take the gains and other settings from this file\n");
+	printf("\t-p, -i, -d: values to try, \"a,b,c\" or \"start:stop:step\"\n");
+	printf("\t-s: synthetic trace, step:PPB, ramp:PPB:SECONDS or sine:PPB:SECONDS (default %s)\n",
+	       DEFAULT_TRACE);
+	printf("\t-n: length of the synthetic trace in samples (default %d)\n", DEFAULT_SAMPLES);
+	printf("\t-N: gaussian noise in ppb added to the synthetic trace\n");
+	printf("\t-r: samples per second (default %.0f)\n", JAPLL_SIM_DEFAULT_RATE);
+	printf("\t-g: share of the applied JAPLL ppb seen in the ptp4l frequency (default 1)\n");
+	printf("\t-a: share of a frequency change ptp4l follows per sample (default 1)\n");
+	printf("\t-R: TXPLL_REF_DIV of the simulated JAPLL (default 1)\n");
+	printf("\t-T: ppb band around set_point counted as settled (default %.0f)\n",
+	       JAPLL_SIM_DEFAULT_TOLERANCE);
+	printf("\t-F: use the fixed point computation\n");
+	printf("\t-t: search for the gains, over -p and -i (default %s and %s)\n",
+	       TUNE_KP_GRID, TUNE_KI_GRID);
+	printf("\t-j: worker processes for -t (default: online harts)\n");
+	printf("\t-X: swings across the tolerance band counted as oscillation (default %d)\n",
+	       TUNE_MAX_CROSSINGS);
+	printf("\t-o: write the tuned configuration here instead of stdout\n");
+	printf("\t-C: check the fixed point presets and PI output against the double ones,\n"
+	       "\t    over a trace of %d samples unless -s, -n or a log is given (default %s,\n"
+	       "\t    noise %.0f)\n", CHECK_SAMPLES, CHECK_TRACE, CHECK_NOISE);
+	printf("\tptp4l.log: replay the freq column of a ptp4l -m log taken with japll_wr_enable 0\n");
+}
+
+int main(int argc, char *argv[])
+{
+	struct japll_plant plant = {
+		.gain = 1.0,
+		.response = 1.0,
+		.ref_div = 1,
+		.tolerance = JAPLL_SIM_DEFAULT_TOLERANCE,
+	};
+	struct value_list kp, ki, dt;
+	struct japll_sim_result res;
+	struct japll_trace trace;
+	struct timespec t0, t1;
+	const char *config = NULL;
+	const char *spec = DEFAULT_TRACE;
+	size_t samples = DEFAULT_SAMPLES;
+	double rate = JAPLL_SIM_DEFAULT_RATE;
+	double noise = 0.0, elapsed;
+	struct tune_ctx ctx = { .max_crossings = TUNE_MAX_CROSSINGS };
+	const char *output = NULL;
+	int fixed_point = 0, tuning = 0, checking = 0, trace_set = 0;
+	int jobs = sysconf(_SC_NPROCESSORS_ONLN);
+	int a, b, c, opt, status;
+	const char *kp_arg = NULL, *ki_arg = NULL, *dt_arg = NULL;
+
+	while ((opt = getopt(argc, argv, "c:p:i:d:s:n:N:r:g:a:R:T:Ftj:X:o:Ch")) != -1) {
+		switch (opt) {
+		case 'c':
+			config = optarg;
+			break;
+		case 'p':
+			kp_arg = optarg;
+			break;
+		case 'i':
+			ki_arg = optarg;
+			break;
+		case 'd':
+			dt_arg = optarg;
+			break;
+		case 's':
+			spec = optarg;
+			trace_set = 1;
+			break;
+		case 'n':
+			samples = strtoul(optarg, NULL, 0);
+			trace_set = 1;
+			break;
+		case 'N':
+			noise = strtod(optarg, NULL);
+			trace_set = 1;
+			break;
+		case 'r':
+			rate = strtod(optarg, NULL);
+			break;
+		case 'g':
+			plant.gain = strtod(optarg, NULL);
+			break;
+		case 'a':
+			plant.response = strtod(optarg, NULL);
+			break;
+		case 'R':
+			plant.ref_div = atoi(optarg);
+			break;
+		case 'T':
+			plant.tolerance = strtod(optarg, NULL);
+			break;
+		case 'F':
+			fixed_point = 1;
+			break;
+		case 't':
+			tuning = 1;
+			break;
+		case 'j':
+			jobs = atoi(optarg);
+			break;
+		case 'X':
+			ctx.max_crossings = atoi(optarg);
+			break;
+		case 'o':
+			output = optarg;
+			break;
+		case 'C':
+			checking = 1;
+			break;
+		default:
+			usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (samples < 2 || rate <= 0.0 || plant.ref_div < 1 || plant.ref_div > 63 || jobs < 1) {
+		usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	if (config) {
+		status = get_pi_configuration(config);
+		if (status)
+			return EXIT_FAILURE;
+	} else {
+		g_pi_conf.pi_enable = 1;
+		g_pi_conf.k_proportional = 0.9;
+		g_pi_conf.k_integral = 0.9;
+		g_pi_conf.delta_time = 0.125;
+	}
+	if (!g_pi_conf.board_ref_clk_freq)
+		g_pi_conf.board_ref_clk_freq = TSU_CLK_FREQ;
+	g_pi_conf.fixed_point = fixed_point;
+
+	kp.count = ki.count = dt.count = 1;
+	kp.val[0] = g_pi_conf.k_proportional;
+	ki.val[0] = g_pi_conf.k_integral;
+	dt.val[0] = g_pi_conf.delta_time;
+	if (tuning) {
+		parse_list(TUNE_KP_GRID, &kp);
+		parse_list(TUNE_KI_GRID, &ki);
+	}
+	if ((kp_arg && parse_list(kp_arg, &kp)) || (ki_arg && parse_list(ki_arg, &ki)) ||
+	    (dt_arg && parse_list(dt_arg, &dt))) {
+		usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	if (checking && !trace_set) {
+		spec = CHECK_TRACE;
+		samples = CHECK_SAMPLES;
+		noise = CHECK_NOISE;
+	}
+
+	if (optind < argc) {
+		status = japll_trace_load(&trace, argv[optind]);
+		trace.rate = rate;
+	} else {
+		status = japll_trace_synth(&trace, spec, samples, rate, noise, DEFAULT_SEED);
+	}
+	if (status) {
+		fprintf(stderr, "cannot set up the trace: %s\n", strerror(status));
+		return EXIT_FAILURE;
+	}
+
+	/* diverging gains would warn about out of range presets on every sample */
+	log_set_level(LOG_ERR);
+
+	if (checking) {
+		g_pi_conf.k_proportional = kp.val[0];
+		g_pi_conf.k_integral = ki.val[0];
+		g_pi_conf.delta_time = dt.val[0];
+		status = fixed_check(&trace, &plant);
+		japll_trace_free(&trace);
+		return status ? EXIT_FAILURE : EXIT_SUCCESS;
+	}
+
+	if (tuning) {
+		ctx.trace = &trace;
+		ctx.plant = &plant;
+		status = tune(&ctx, &kp, &ki, &dt, jobs, config, output);
+		japll_trace_free(&trace);
+		return status ? EXIT_FAILURE : EXIT_SUCCESS;
+	}
+
+	printf("%zu samples at %.1f/s, pi_enable %d, %s\n", trace.len, trace.rate,
+	       g_pi_conf.pi_enable, fixed_point ? "fixed point" : "double");
+	printf("%10s %10s %10s %10s %12s %12s %12s %9s\n", "k_prop", "k_int", "delta_t",
+	       "settle_s", "overshoot", "jitter", "rms", "crossings");
+
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	for (a = 0; a < kp.count; a++) {
+		for (b = 0; b < ki.count; b++) {
+			for (c = 0; c < dt.count; c++) {
+				g_pi_conf.k_proportional = kp.val[a];
+				g_pi_conf.k_integral = ki.val[b];
+				g_pi_conf.delta_time = dt.val[c];
+				japll_sim_run(&trace, &plant, &res);
+
+				printf("%10.4f %10.4f %10.4f ", kp.val[a], ki.val[b], dt.val[c]);
+				if (res.settle_s < 0)
+					printf("%10s ", "-");
+				else
+					printf("%10.3f ", res.settle_s);
+				printf("%12.3f %12.3f %12.3f %9d\n", res.overshoot, res.jitter,
+				       res.rms, res.crossings);
+			}
+		}
+	}
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+
+	elapsed = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+	printf("%d combinations in %.3f s\n", kp.count * ki.count * dt.count, elapsed);
+
+	japll_trace_free(&trace);
+
+	return EXIT_SUCCESS;
+}
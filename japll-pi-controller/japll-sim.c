@@ -0,0 +1,272 @@
+// SPDX-License-Identifier: MIT
+/*
+ * @file japll-sim.c
+ * @brief offline simulation of the JAPLL PI servo
+ * Copyright (C) 2026 Microchip Technology Inc. and its subsidiaries
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+
+#include "print.h"
+#include "japll-pi.h"
+#include "japll-sim.h"
+
+#define TRACE_INITIAL_LEN   4096
+#define JAPLL_INT_MASK      ((1 << JAPLL_INT_WIDTH_BITS) - 1)
+#define PTP4L_MAX_PPB       900000000.0   /* ptp4l max_frequency, a diverging loop ends here */
+#define SIM_AVERAGE_S       1.0           /* settle and crossings are taken on this moving average */
+#define SIM_SETTLE_SHARE    10            /* share in % of the trace that must be settled */
+
+/* stands in for the /dev/uio0 mapping */
+static uint32_t sim_regs[MMAP_SIZE / sizeof(uint32_t)];
+
+/*
+ * Take the "freq" column of a ptp4l -m log, the same way japll-pi does
+ * with the text source.
+ */
+int japll_trace_load(struct japll_trace *trace, const char *path)
+{
+	char line[256];
+	char *freq_str, *col_data, *end_ptr;
+	size_t size = TRACE_INITIAL_LEN;
+	double *ppb;
+	double freq;
+	FILE *fp;
+
+	fp = fopen(path, "r");
+	if (!fp) {
+		pr_err("Cannot open %s: %m", path);
+		return errno;
+	}
+
+	memset(trace, 0, sizeof(*trace));
+	trace->rate = JAPLL_SIM_DEFAULT_RATE;
+	trace->ppb = malloc(size * sizeof(*trace->ppb));
+	if (!trace->ppb) {
+		fclose(fp);
+		return ENOMEM;
+	}
+
+	while (fgets(line, sizeof(line), fp)) {
+		freq_str = strstr(line, "freq");
+		if (!freq_str)
+			continue;
+		col_data = strtok(freq_str, " ");
+		col_data = strtok(NULL, " ");
+		if (!col_data)
+			continue;
+		freq = strtol(col_data, &end_ptr, 10);
+		if (end_ptr == col_data)
+			continue;
+
+		if (trace->len == size) {
+			size *= 2;
+			ppb = realloc(trace->ppb, size * sizeof(*ppb));
+			if (!ppb) {
+				japll_trace_free(trace);
+				fclose(fp);
+				return ENOMEM;
+			}
+			trace->ppb = ppb;
+		}
+		trace->ppb[trace->len++] = freq;
+	}
+	fclose(fp);
+
+	if (!trace->len) {
+		pr_err("no freq samples in %s", path);
+		japll_trace_free(trace);
+		return ENODATA;
+	}
+
+	return 0;
+}
+
+/* Standard normal deviate, Box-Muller */
+static double gaussian(unsigned int *seed)
+{
+	double u1 = (rand_r(seed) + 1.0) / (RAND_MAX + 2.0);
+	double u2 = (rand_r(seed) + 1.0) / (RAND_MAX + 2.0);
+
+	return sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+}
+
+/*
+ * Synthetic free running offsets:
+ *   step:PPB           constant offset from the first sample
+ *   ramp:PPB:SECONDS   offset rising linearly from 0 to PPB, then held
+ *   sine:PPB:SECONDS   sinusoidal wander with amplitude PPB and given period
+ * with gaussian noise of standard deviation 'noise' ppb added on top.
+ */
+int japll_trace_synth(struct japll_trace *trace, const char *spec, size_t len,
+		      double rate, double noise, unsigned int seed)
+{
+	double amplitude = 0.0, seconds = 0.0, t, v;
+	char kind[8];
+	size_t n;
+
+	if (sscanf(spec, "%7[a-z]:%lf:%lf", kind, &amplitude, &seconds) < 2)
+		return EINVAL;
+	if (strcmp(kind, "step") && seconds <= 0.0)
+		return EINVAL;
+
+	memset(trace, 0, sizeof(*trace));
+	trace->rate = rate;
+	trace->ppb = malloc(len * sizeof(*trace->ppb));
+	if (!trace->ppb)
+		return ENOMEM;
+	trace->len = len;
+
+	for (n = 0; n < len; n++) {
+		t = n / trace->rate;
+		if (!strcmp(kind, "step")) {
+			v = amplitude;
+		} else if (!strcmp(kind, "ramp")) {
+			v = t < seconds ? amplitude * t / seconds : amplitude;
+		} else if (!strcmp(kind, "sine")) {
+			v = amplitude * sin(2.0 * M_PI * t / seconds);
+		} else {
+			japll_trace_free(trace);
+			return EINVAL;
+		}
+		if (noise > 0.0)
+			v += noise * gaussian(&seed);
+		trace->ppb[n] = v;
+	}
+
+	return 0;
+}
+
+void japll_trace_free(struct japll_trace *trace)
+{
+	free(trace->ppb);
+	trace->ppb = NULL;
+	trace->len = 0;
+}
+
+/* The frequency offset the presets in the register file amount to */
+static double japll_applied_ppb(void)
+{
+	double total;
+
+	total = (sim_regs[JAPLL_9_INT_PRESET] & JAPLL_INT_MASK) +
+		(double)(sim_regs[JAPLL_8_FRAC_PRESET] & JAPLL_FRAC_MASK) / JAPLL_FRAC_ONE;
+
+	return (total / g_japll.japll_preset_ppb_0 - 1.0) * FRAC_DIVIDER;
+}
+
+/*
+ * Point the servo at the simulated register file, holding the presets
+ * for PPB = 0, with all servo state reset and the current gains.
+ */
+void japll_sim_init(const struct japll_plant *plant)
+{
+	memset(sim_regs, 0, sizeof(sim_regs));
+	sim_regs[TXPLL_DIV_2] = plant->ref_div << 24;
+	g_japll.mem_ptr0 = sim_regs;
+	g_japll.japll_wr_enable = 1;
+	calculate_japll_initial_presets();
+	sim_regs[JAPLL_9_INT_PRESET] = g_japll.integer;
+	sim_regs[JAPLL_8_FRAC_PRESET] = g_japll.fraction | JAPLL_8_HOLD_PRESET_ENABLE;
+	japll_reset();
+}
+
+/*
+ * Run the servo over 'trace' with the gains currently in g_pi_conf.
+ *
+ * Settling and crossings are judged on the error averaged over
+ * SIM_AVERAGE_S, so that noise around set_point does not count as the
+ * loop leaving the tolerance band. A swing is counted when the average
+ * goes beyond one edge of the band after having been beyond the other,
+ * and the loop is only counted as settled when the average stays in the
+ * band for at least SIM_SETTLE_SHARE % of the trace.
+ */
+void japll_sim_run(const struct japll_trace *trace, const struct japll_plant *plant,
+		   struct japll_sim_result *result)
+{
+	double *err;
+	double ppb, e, avg, acc = 0.0, sum = 0.0, sum_sq = 0.0, mean;
+	long last_out = -1;
+	int side = 0, cur, sign = 0;
+	size_t n, start, window;
+
+	memset(result, 0, sizeof(*result));
+	err = malloc(trace->len * sizeof(*err));
+	if (!err) {
+		result->settle_s = -1.0;
+		return;
+	}
+
+	japll_sim_init(plant);
+
+	ppb = trace->ppb[0];
+	for (n = 0; n < trace->len; n++) {
+		err[n] = ppb - g_pi_conf.set_point;
+
+		/* diverged, ptp4l would sit at its limit from here on */
+		if (fabs(ppb) >= PTP4L_MAX_PPB)
+			continue;
+
+		japll_main(ppb);
+
+		/* the servo asked for presets the JAPLL cannot hold */
+		if ((g_japll.fraction >> JAPLL_FRAC_WIDTH_BITS) ||
+		    (g_japll.integer >> JAPLL_INT_WIDTH_BITS)) {
+			ppb = copysign(PTP4L_MAX_PPB, ppb);
+			continue;
+		}
+
+		if (n + 1 < trace->len) {
+			ppb += plant->response *
+				(trace->ppb[n + 1] + plant->gain * japll_applied_ppb() - ppb);
+			ppb = fmax(fmin(ppb, PTP4L_MAX_PPB), -PTP4L_MAX_PPB);
+		}
+	}
+
+	window = fmax(SIM_AVERAGE_S * trace->rate, 1.0);
+	for (n = 0; n < trace->len; n++) {
+		e = err[n];
+		sum_sq += e * e;
+		acc += e;
+		if (n >= window)
+			acc -= err[n - window];
+		avg = acc / (n < window ? n + 1 : window);
+		if (sign && -sign * avg > result->overshoot)
+			result->overshoot = -sign * avg;
+		if (fabs(avg) <= plant->tolerance)
+			continue;
+
+		last_out = n;
+		cur = avg > 0 ? 1 : -1;
+		if (!sign)
+			sign = cur;
+		if (side && cur != side)
+			result->crossings++;
+		side = cur;
+	}
+	result->rms = sqrt(sum_sq / trace->len);
+
+	if (trace->len - (last_out + 1) < trace->len * SIM_SETTLE_SHARE / 100) {
+		result->settle_s = -1.0;
+		start = trace->len * 3 / 4;
+	} else {
+		result->settle_s = (last_out + 1) / trace->rate;
+		start = last_out + 1;
+	}
+
+	sum = sum_sq = 0.0;
+	for (n = start; n < trace->len; n++) {
+		sum += err[n];
+		sum_sq += err[n] * err[n];
+	}
+	if (trace->len - start > 1) {
+		mean = sum / (trace->len - start);
+		result->jitter = sqrt(fmax(sum_sq / (trace->len - start) - mean * mean, 0.0));
+	}
+
+	free(err);
+}
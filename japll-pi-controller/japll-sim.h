@@ -0,0 +1,58 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * @file japll-sim.h
+ * @brief offline simulation of the JAPLL PI servo
+ * Copyright (C) 2026 Microchip Technology Inc. and its subsidiaries
+ *
+ * The unmodified japll_main() is run against a register file in memory
+ * instead of the /dev/uio0 mapping. The frequency offset it is fed comes
+ * from a trace, either recorded from ptp4l -m with japll_wr_enable 0 so
+ * that it shows the free running offset, or synthetic. After every sample
+ * the preset written to the register file is converted back to ppb and
+ * fed back through a simple plant model:
+ *
+ *   ppb[n + 1] = ppb[n] + response * (trace[n + 1] + gain * applied - ppb[n])
+ *
+ * 'gain' is how the applied JAPLL ppb shows up in the ptp4l frequency and
+ * 'response' the share of a change ptp4l's own servo follows per sample.
+ */
+
+#ifndef __JAPLL_SIM_H
+#define __JAPLL_SIM_H
+
+#include <stddef.h>
+
+#define JAPLL_SIM_DEFAULT_RATE       8.0     /* samples per second, logSyncInterval -3 */
+#define JAPLL_SIM_DEFAULT_TOLERANCE  10.0    /* ppb */
+
+struct japll_trace {
+	double  *ppb;         /* free running frequency offset per sample */
+	size_t  len;
+	double  rate;         /* samples per second */
+};
+
+struct japll_plant {
+	double  gain;
+	double  response;
+	int     ref_div;      /* TXPLL_REF_DIV of the simulated JAPLL */
+	double  tolerance;    /* ppb band around set_point counted as settled */
+};
+
+struct japll_sim_result {
+	double  settle_s;     /* time from which the averaged error stays in tolerance, < 0 if never */
+	double  overshoot;    /* ppb of the averaged error beyond set_point, opposite to the initial error */
+	double  jitter;       /* ppb, standard deviation once settled */
+	double  rms;          /* ppb, rms error over the whole trace */
+	int     crossings;    /* swings of the averaged error across the tolerance band */
+};
+
+int japll_trace_load(struct japll_trace *trace, const char *path);
+int japll_trace_synth(struct japll_trace *trace, const char *spec, size_t len,
+		      double rate, double noise, unsigned int seed);
+void japll_trace_free(struct japll_trace *trace);
+
+void japll_sim_init(const struct japll_plant *plant);
+void japll_sim_run(const struct japll_trace *trace, const struct japll_plant *plant,
+		   struct japll_sim_result *result);
+
+#endif /* __JAPLL_SIM_H */
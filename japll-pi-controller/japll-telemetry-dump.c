@@ -0,0 +1,162 @@
+// SPDX-License-Identifier: MIT
+/*
+ * @file japll-telemetry-dump.c
+ * @brief export slices of a japll-pi telemetry file as CSV
+ * Copyright (C) 2026 Microchip Technology Inc. and its subsidiaries
+ *
+ * The file may be read while japll-pi is appending to it. Records that
+ * are being rewritten, or were overwritten before they could be copied,
+ * are skipped and counted.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "japll-telemetry.h"
+
+static void usage(const char *prog)
+{
+	printf("usage: %s [-s first] [-n count] [-l last] [-f from_s] [-t to_s] [-w] [-i] telemetry-file\n",
+	       prog);
+	printf("\t-s: first sample number to export (default oldest kept)\n");
+	printf("\t-n: number of samples to export (default all)\n");
+	printf("\t-l: export only the last <last> samples\n");
+	printf("\t-f: skip samples taken before <from_s>, seconds since the Epoch\n");
+	printf("\t-t: skip samples taken after <to_s>, seconds since the Epoch\n");
+	printf("\t-w: print wall clock time instead of CLOCK_MONOTONIC\n");
+	printf("\t-i: print the file summary only\n");
+}
+
+int main(int argc, char *argv[])
+{
+	const struct japll_telemetry_hdr *hdr;
+	const struct japll_telemetry_rec *recs, *slot;
+	struct japll_telemetry_rec rec;
+	uint64_t first = 0, count = UINT64_MAX, last = 0;
+	uint64_t head, oldest, seq, skipped = 0;
+	double from_s = -1.0, to_s = -1.0;
+	bool wall = false, info = false, have_first = false;
+	int64_t ts_ns;
+	struct stat st;
+	void *map;
+	int opt, fd;
+
+	while ((opt = getopt(argc, argv, "s:n:l:f:t:wih")) != -1) {
+		switch (opt) {
+		case 's':
+			first = strtoull(optarg, NULL, 0);
+			have_first = true;
+			break;
+		case 'n':
+			count = strtoull(optarg, NULL, 0);
+			break;
+		case 'l':
+			last = strtoull(optarg, NULL, 0);
+			break;
+		case 'f':
+			from_s = strtod(optarg, NULL);
+			break;
+		case 't':
+			to_s = strtod(optarg, NULL);
+			break;
+		case 'w':
+			wall = true;
+			break;
+		case 'i':
+			info = true;
+			break;
+		default:
+			usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (optind >= argc) {
+		usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	fd = open(argv[optind], O_RDONLY);
+	if (fd < 0 || fstat(fd, &st)) {
+		perror(argv[optind]);
+		return EXIT_FAILURE;
+	}
+	if (st.st_size < sizeof(*hdr)) {
+		fprintf(stderr, "%s is not a telemetry file\n", argv[optind]);
+		return EXIT_FAILURE;
+	}
+	map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED) {
+		perror("mmap");
+		return EXIT_FAILURE;
+	}
+
+	hdr = map;
+	recs = (const struct japll_telemetry_rec *)(hdr + 1);
+	if (hdr->magic != JAPLL_TELEMETRY_MAGIC ||
+	    hdr->rec_size != sizeof(struct japll_telemetry_rec) || !hdr->capacity ||
+	    st.st_size < sizeof(*hdr) + (uint64_t)hdr->capacity * hdr->rec_size) {
+		fprintf(stderr, "%s is not a telemetry file\n", argv[optind]);
+		return EXIT_FAILURE;
+	}
+
+	head = __atomic_load_n(&hdr->head, __ATOMIC_ACQUIRE);
+	oldest = head > hdr->capacity ? head - hdr->capacity : 0;
+
+	if (info) {
+		printf("%" PRIu64 " samples appended, %" PRIu64 "..%" PRIu64 " kept in a ring of %u\n",
+		       head, oldest, head ? head - 1 : 0, hdr->capacity);
+		munmap(map, st.st_size);
+		return EXIT_SUCCESS;
+	}
+
+	if (last && head - oldest > last)
+		oldest = head - last;
+	if (!have_first || first < oldest)
+		first = oldest;
+
+	printf("seq,time_s,ppb_in,ppb_out,integer,fraction,write_ns,flags\n");
+
+	for (seq = first; seq < head && count; seq++) {
+		slot = &recs[seq % hdr->capacity];
+
+		/* copy the record, then check it was not rewritten meanwhile */
+		if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != seq) {
+			skipped++;
+			continue;
+		}
+		memcpy(&rec, slot, sizeof(rec));
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		if (__atomic_load_n(&slot->seq, __ATOMIC_RELAXED) != seq) {
+			skipped++;
+			continue;
+		}
+
+		if (from_s >= 0 && rec.realtime_ns < from_s * 1e9)
+			continue;
+		if (to_s >= 0 && rec.realtime_ns > to_s * 1e9)
+			continue;
+
+		ts_ns = wall ? rec.realtime_ns : (int64_t)rec.ts_ns;
+		printf("%" PRIu64 ",%" PRId64 ".%09" PRId64 ",%.3f,%.3f,%u,0x%06x,%u,0x%x\n", seq,
+		       ts_ns / 1000000000, ts_ns % 1000000000, rec.ppb_in, rec.ppb_out,
+		       rec.integer, rec.fraction, rec.write_ns, rec.flags);
+		count--;
+	}
+
+	if (skipped)
+		fprintf(stderr, "%" PRIu64 " samples skipped, overwritten while reading\n", skipped);
+
+	munmap(map, st.st_size);
+	return EXIT_SUCCESS;
+}
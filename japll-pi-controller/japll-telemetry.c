@@ -0,0 +1,75 @@
+// SPDX-License-Identifier: MIT
+/*
+ * @file japll-telemetry.c
+ * @brief binary per sample servo telemetry in a memory mapped ring file
+ * Copyright (C) 2026 Microchip Technology Inc. and its subsidiaries
+ */
+
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "japll-telemetry.h"
+
+/*
+ * Map 'path' as a ring of 'capacity' records. An existing file with the
+ * same record size and capacity keeps its records, anything else is
+ * reinitialised.
+ */
+int japll_telemetry_open(struct japll_telemetry *tm, const char *path, uint32_t capacity)
+{
+	struct japll_telemetry_hdr *hdr;
+	struct stat st;
+	int fd, err;
+
+	if (!capacity)
+		return EINVAL;
+
+	memset(tm, 0, sizeof(*tm));
+	tm->size = sizeof(*hdr) + (size_t)capacity * sizeof(struct japll_telemetry_rec);
+
+	fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+	if (fd < 0)
+		return errno;
+	if (fstat(fd, &st) || (st.st_size != tm->size && ftruncate(fd, tm->size))) {
+		err = errno;
+		close(fd);
+		return err;
+	}
+
+	hdr = mmap(NULL, tm->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	err = errno;
+	close(fd);
+	if (hdr == MAP_FAILED)
+		return err;
+
+	if (hdr->magic != JAPLL_TELEMETRY_MAGIC ||
+	    hdr->rec_size != sizeof(struct japll_telemetry_rec) ||
+	    hdr->capacity != capacity) {
+		memset(hdr, 0, sizeof(*hdr));
+		hdr->rec_size = sizeof(struct japll_telemetry_rec);
+		hdr->capacity = capacity;
+		/* no record is valid until written, seq 0 would look like one */
+		memset(hdr + 1, 0xff, tm->size - sizeof(*hdr));
+		__atomic_store_n(&hdr->magic, JAPLL_TELEMETRY_MAGIC, __ATOMIC_RELEASE);
+	}
+
+	tm->hdr = hdr;
+	tm->recs = (struct japll_telemetry_rec *)(hdr + 1);
+
+	return 0;
+}
+
+void japll_telemetry_close(struct japll_telemetry *tm)
+{
+	if (!tm->hdr)
+		return;
+	msync(tm->hdr, tm->size, MS_ASYNC);
+	munmap(tm->hdr, tm->size);
+	tm->hdr = NULL;
+	tm->recs = NULL;
+}
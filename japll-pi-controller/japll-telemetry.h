@@ -0,0 +1,90 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * @file japll-telemetry.h
+ * @brief binary per sample servo telemetry in a memory mapped ring file
+ * Copyright (C) 2026 Microchip Technology Inc. and its subsidiaries
+ *
+ * The file is a header followed by a ring of fixed size records. Appending
+ * a record is a few stores into the shared mapping, the kernel writes the
+ * pages back in the background. The ring survives restarts: a file with a
+ * matching layout is appended to rather than cleared.
+ *
+ * A record is complete once its 'seq' holds its own sample number, which
+ * is stored last, so the file can be read while japll-pi is running.
+ * Every record carries its own wall clock time, CLOCK_MONOTONIC restarts
+ * with every boot the ring outlives.
+ */
+
+#ifndef __JAPLL_TELEMETRY_H
+#define __JAPLL_TELEMETRY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <time.h>
+
+#define JAPLL_TELEMETRY_MAGIC        0x324d4c4554504a4aULL  /* "JJPTELM2" */
+#define JAPLL_TELEMETRY_DEFAULT_RECS 2097152                /* three days at 8 samples/s */
+
+#define JAPLL_TELEMETRY_SETTLING     0x1   /* sample taken before the servo started */
+#define JAPLL_TELEMETRY_INT_WRITTEN  0x2   /* JAPLL_9_INT_PRESET was written */
+#define JAPLL_TELEMETRY_FRAC_WRITTEN 0x4   /* JAPLL_8_FRAC_PRESET was written */
+
+struct japll_telemetry_rec {
+	uint64_t seq;         /* sample number, written last */
+	uint64_t ts_ns;       /* CLOCK_MONOTONIC when japll_main() was called */
+	int64_t  realtime_ns; /* CLOCK_REALTIME at the same time, comparable across boots */
+	double   ppb_in;      /* ppb handed to japll_main() */
+	double   ppb_out;     /* PI controller output, ppb_in without it */
+	uint32_t integer;     /* g_japll.integer after the sample */
+	uint32_t fraction;    /* g_japll.fraction after the sample */
+	uint32_t write_ns;    /* time spent writing the JAPLL registers */
+	uint32_t flags;       /* JAPLL_TELEMETRY_* */
+};
+
+struct japll_telemetry_hdr {
+	uint64_t magic;
+	uint32_t rec_size;
+	uint32_t capacity;     /* records in the ring */
+	uint64_t head;         /* records ever appended, the next one goes to head % capacity */
+	uint64_t reserved[5];
+};
+
+struct japll_telemetry {
+	struct japll_telemetry_hdr *hdr;
+	struct japll_telemetry_rec *recs;
+	size_t   size;
+};
+
+int japll_telemetry_open(struct japll_telemetry *tm, const char *path, uint32_t capacity);
+void japll_telemetry_close(struct japll_telemetry *tm);
+
+static inline int64_t japll_telemetry_clock_ns(clockid_t clk)
+{
+	struct timespec ts;
+
+	clock_gettime(clk, &ts);
+	return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static inline void japll_telemetry_append(struct japll_telemetry *tm,
+					  const struct japll_telemetry_rec *rec)
+{
+	uint64_t head = tm->hdr->head;
+	struct japll_telemetry_rec *slot = &tm->recs[head % tm->hdr->capacity];
+
+	/* invalidate the slot while it is rewritten */
+	__atomic_store_n(&slot->seq, UINT64_MAX, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+	slot->ts_ns = rec->ts_ns;
+	slot->realtime_ns = rec->realtime_ns;
+	slot->ppb_in = rec->ppb_in;
+	slot->ppb_out = rec->ppb_out;
+	slot->integer = rec->integer;
+	slot->fraction = rec->fraction;
+	slot->write_ns = rec->write_ns;
+	slot->flags = rec->flags;
+	__atomic_store_n(&slot->seq, head, __ATOMIC_RELEASE);
+	__atomic_store_n(&tm->hdr->head, head + 1, __ATOMIC_RELEASE);
+}
+
+#endif /* __JAPLL_TELEMETRY_H */
@@ -0,0 +1,188 @@
+// SPDX-License-Identifier: MIT
+/*
+ * @file print-bench.c
+ * @brief per call cost of log_message(), synchronous against asynchronous
+ * Copyright (C) 2026 Microchip Technology Inc. and its subsidiaries
+ *
+ * Logs the kinds of messages japll-pi logs per sample, from one or more
+ * threads, and reports the time spent inside each call. The log output
+ * itself goes to /dev/null unless another file is given with -o, the
+ * report goes to stderr.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "print.h"
+
+#define DEFAULT_CALLS        20000
+#define DEFAULT_INTERVAL_US  20
+#define MAX_THREADS          16
+
+enum bench_msg {
+	MSG_LINE,       /* a ptp4l line, as logged by the text source */
+	MSG_NUMBERS,    /* integers and doubles, as the servo debug output */
+	MSG_FILTERED,   /* below the log level */
+	NUM_MSGS,
+};
+
+static const char * const msg_names[] = { "ptp4l line", "numbers", "filtered" };
+
+static const char ptp4l_line[] =
+	"ptp4l[5123.456]: master offset        -12 s2 freq   +5012 path delay       512\n";
+
+struct bench_thread {
+	pthread_t thread;
+	enum bench_msg msg;
+	int calls;
+	long interval_ns;
+	long *cost;     /* ns per call */
+};
+
+static long now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+static void *bench_fn(void *arg)
+{
+	struct bench_thread *bt = arg;
+	long t0, t1, next = now_ns();
+	int i;
+
+	for (i = 0; i < bt->calls; i++) {
+		/* pace the calls so the log thread can keep up */
+		while (now_ns() < next)
+			;
+		next += bt->interval_ns;
+
+		t0 = now_ns();
+		switch (bt->msg) {
+		case MSG_LINE:
+			pr_info("p_buf = %s", ptp4l_line);
+			break;
+		case MSG_NUMBERS:
+			pr_info("ppb = %.8f, japll_preset_total = %.8f, int = %d, frac = 0x%x",
+				-5012.0 + i, 20.0001, 20, 0x1a2b3c + i);
+			break;
+		default:
+			pr_debug("ip_val : %lf op_val : %lf", 1.0 * i, -0.9 * i);
+			break;
+		}
+		t1 = now_ns();
+		bt->cost[i] = t1 - t0;
+	}
+
+	return NULL;
+}
+
+static int cmp_long(const void *a, const void *b)
+{
+	long la = *(const long *)a, lb = *(const long *)b;
+
+	return (la > lb) - (la < lb);
+}
+
+static void run(const char *mode, enum bench_msg msg, int threads, int calls, long interval_ns)
+{
+	struct bench_thread bt[MAX_THREADS];
+	unsigned long dropped = log_dropped_count();
+	long *cost, sum = 0;
+	int i, total = threads * calls;
+
+	cost = malloc(total * sizeof(*cost));
+	if (!cost) {
+		perror("malloc");
+		exit(EXIT_FAILURE);
+	}
+
+	for (i = 0; i < threads; i++) {
+		bt[i].msg = msg;
+		bt[i].calls = calls;
+		bt[i].interval_ns = interval_ns;
+		bt[i].cost = cost + i * calls;
+		pthread_create(&bt[i].thread, NULL, bench_fn, &bt[i]);
+	}
+	for (i = 0; i < threads; i++)
+		pthread_join(bt[i].thread, NULL);
+
+	for (i = 0; i < total; i++)
+		sum += cost[i];
+	qsort(cost, total, sizeof(*cost), cmp_long);
+
+	fprintf(stderr, "%-6s %-11s %10.1f %10ld %10ld %10ld %10lu\n", mode, msg_names[msg],
+		(double)sum / total, cost[total / 2], cost[total * 99 / 100], cost[total - 1],
+		log_dropped_count() - dropped);
+	free(cost);
+}
+
+static void usage(const char *prog)
+{
+	printf("usage: %s [-n calls] [-t threads] [-i interval_us] [-o output]\n", prog);
+	printf("\t-n: calls per thread and message kind (default %d)\n", DEFAULT_CALLS);
+	printf("\t-t: logging threads, at most %d (default 1)\n", MAX_THREADS);
+	printf("\t-i: time between calls of a thread (default %d us)\n", DEFAULT_INTERVAL_US);
+	printf("\t-o: where the log output goes (default /dev/null)\n");
+}
+
+int main(int argc, char *argv[])
+{
+	const char *output = "/dev/null";
+	int calls = DEFAULT_CALLS, threads = 1;
+	long interval_ns = DEFAULT_INTERVAL_US * 1000L;
+	int opt, fd, msg;
+
+	while ((opt = getopt(argc, argv, "n:t:i:o:h")) != -1) {
+		switch (opt) {
+		case 'n':
+			calls = atoi(optarg);
+			break;
+		case 't':
+			threads = atoi(optarg);
+			break;
+		case 'i':
+			interval_ns = atol(optarg) * 1000L;
+			break;
+		case 'o':
+			output = optarg;
+			break;
+		default:
+			usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+	if (calls < 1 || threads < 1 || threads > MAX_THREADS || interval_ns < 0) {
+		usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	fd = open(output, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0 || dup2(fd, STDOUT_FILENO) < 0) {
+		perror(output);
+		return EXIT_FAILURE;
+	}
+	close(fd);
+
+	fprintf(stderr, "%d calls x %d threads, %ld us apart, log to %s\n", calls, threads,
+		interval_ns / 1000, output);
+	fprintf(stderr, "%-6s %-11s %10s %10s %10s %10s %10s\n", "mode", "message",
+		"mean_ns", "p50_ns", "p99_ns", "max_ns", "dropped");
+
+	for (msg = 0; msg < NUM_MSGS; msg++)
+		run("sync", msg, threads, calls, interval_ns);
+
+	log_set_async(1);
+	for (msg = 0; msg < NUM_MSGS; msg++)
+		run("async", msg, threads, calls, interval_ns);
+	log_set_async(0);
+
+	return EXIT_SUCCESS;
+}
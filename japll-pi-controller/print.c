@@ -8,10 +8,16 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdarg.h>
+#include <stdatomic.h>
 #include <time.h>
 #include <sys/time.h>
 #include <string.h>
 #include <pthread.h>
+#include <signal.h>
+#include <errno.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
 
 #include "print.h"
 
@@ -22,6 +28,62 @@ static int log_destination = LOG_TO_CONSOLE;
 static int log_level = LOG_INFO;
 static pthread_mutex_t log_mutex = PTHREAD_MUTEX_INITIALIZER;
 
+/*
+ * Asynchronous backend: log_message() only captures the format pointer and
+ * the raw arguments into a slot of a bounded multi-producer ring, and a
+ * background thread formats and writes them. When the ring is full the
+ * message is dropped and counted rather than blocking the caller.
+ *
+ * The thread wakes up every LOG_FLUSH_MS on its own, callers only wake it
+ * when the ring is half full, so a call normally makes no system call
+ * other than the vDSO clock_gettime().
+ */
+#define LOG_RING_SLOTS    1024      /* power of two */
+#define LOG_MAX_ARGS      8
+#define LOG_STR_SPACE     192       /* for copies of %s arguments */
+#define LOG_SPEC_MAX      32
+#define LOG_FLUSH_MS      10        /* how long a message may wait to be written */
+#define LOG_WAKE_FILL     (LOG_RING_SLOTS / 2)
+
+enum log_len {
+	LEN_INT,
+	LEN_LONG,
+	LEN_LLONG,
+	LEN_LDOUBLE,
+};
+
+union log_arg {
+	long long i;
+	double d;
+	const void *p;
+};
+
+struct log_record {
+	atomic_ulong seq;            /* slot sequence of the ring protocol */
+	int level;
+	int saved_errno;             /* for %m */
+	struct timespec ts;
+	const char *format;          /* NULL when 'str' holds the whole message */
+	union log_arg args[LOG_MAX_ARGS];
+	char str[LOG_STR_SPACE];
+};
+
+struct log_spec {
+	size_t len;                  /* length of the conversion, including '%' */
+	int stars;                   /* '*' width and precision arguments */
+	enum log_len length;
+	char conv;
+};
+
+static struct log_record log_ring[LOG_RING_SLOTS];
+static atomic_ulong log_head;    /* next slot claimed by a producer */
+static atomic_ulong log_tail;    /* next slot read by the log thread */
+static atomic_ulong log_dropped;
+static atomic_int log_async;
+static atomic_int log_sleeping;
+static atomic_int log_stop;
+static pthread_t log_thread;
+
 /**
  * @brief Get the current timestamp.
  *
@@ -42,6 +104,307 @@ void get_timestamp(char *buffer, size_t buffer_size)
 	snprintf(buffer, buffer_size, "%ld.%03ld", tv.tv_sec, tv.tv_nsec / 1000000);
 }
 
+static void log_write(int level, const char *timestamp, const char *msg)
+{
+	// Lock the mutex to ensure thread-safe logging
+	pthread_mutex_lock(&log_mutex);
+	if (log_destination == LOG_TO_CONSOLE)
+		printf("[%s] %s\n", timestamp, msg); // Log to console
+	else
+		syslog(level, "[%s] %s", timestamp, msg); //// Log to syslog
+	pthread_mutex_unlock(&log_mutex); // Unlock the mutex
+}
+
+/*
+ * Parse the conversion specification at 'p', which points at a '%'.
+ * Returns 0 for anything the asynchronous path does not handle.
+ */
+static size_t log_parse_spec(const char *p, struct log_spec *spec)
+{
+	const char *s = p + 1;
+
+	memset(spec, 0, sizeof(*spec));
+	s += strspn(s, "-+ #0'");
+	if (*s == '*') {
+		spec->stars++;
+		s++;
+	} else {
+		s += strspn(s, "0123456789");
+	}
+	if (*s == '.') {
+		s++;
+		if (*s == '*') {
+			spec->stars++;
+			s++;
+		} else {
+			s += strspn(s, "0123456789");
+		}
+	}
+
+	if (s[0] == 'h') {
+		s += s[1] == 'h' ? 2 : 1;
+	} else if (s[0] == 'l' && s[1] == 'l') {
+		spec->length = LEN_LLONG;
+		s += 2;
+	} else if (s[0] == 'l' || s[0] == 'z' || s[0] == 't') {
+		spec->length = LEN_LONG;
+		s++;
+	} else if (s[0] == 'j' || s[0] == 'q') {
+		spec->length = LEN_LLONG;
+		s++;
+	} else if (s[0] == 'L') {
+		spec->length = LEN_LDOUBLE;
+		s++;
+	}
+
+	spec->conv = *s;
+	if (!spec->conv || !strchr("diouxXceEfFgGaAspm%", spec->conv) ||
+	    spec->length == LEN_LDOUBLE || s - p >= LOG_SPEC_MAX)
+		return 0;
+	spec->len = s + 1 - p;
+
+	return spec->len;
+}
+
+/*
+ * Take the arguments 'format' refers to out of 'args'. Returns -1 if the
+ * format has conversions that cannot be captured, or too many of them.
+ */
+static int log_capture(struct log_record *rec, const char *format, va_list args)
+{
+	struct log_spec spec;
+	const char *p = format, *str;
+	size_t used = 0, len;
+	int n = 0, i;
+
+	while ((p = strchr(p, '%'))) {
+		if (!log_parse_spec(p, &spec) || n + spec.stars + 1 > LOG_MAX_ARGS)
+			return -1;
+		p += spec.len;
+
+		for (i = 0; i < spec.stars; i++)
+			rec->args[n++].i = va_arg(args, int);
+
+		switch (spec.conv) {
+		case 'd': case 'i': case 'c':
+			if (spec.length == LEN_LLONG)
+				rec->args[n++].i = va_arg(args, long long);
+			else if (spec.length == LEN_LONG)
+				rec->args[n++].i = va_arg(args, long);
+			else
+				rec->args[n++].i = va_arg(args, int);
+			break;
+		case 'o': case 'u': case 'x': case 'X':
+			if (spec.length == LEN_LLONG)
+				rec->args[n++].i = va_arg(args, unsigned long long);
+			else if (spec.length == LEN_LONG)
+				rec->args[n++].i = va_arg(args, unsigned long);
+			else
+				rec->args[n++].i = va_arg(args, unsigned int);
+			break;
+		case 'e': case 'E': case 'f': case 'F':
+		case 'g': case 'G': case 'a': case 'A':
+			rec->args[n++].d = va_arg(args, double);
+			break;
+		case 'p':
+			rec->args[n++].p = va_arg(args, void *);
+			break;
+		case 's':
+			/* the string may be gone by the time it is formatted */
+			str = va_arg(args, const char *);
+			if (!str)
+				str = "(null)";
+			len = strnlen(str, sizeof(rec->str) - 1 - used);
+			memcpy(rec->str + used, str, len);
+			rec->str[used + len] = '\0';
+			rec->args[n++].i = used;
+			used += len + (used + len + 1 < sizeof(rec->str));
+			break;
+		}
+	}
+
+	return 0;
+}
+
+/* Format a captured record, the counterpart of log_capture() */
+static void log_render(const struct log_record *rec, char *buf, size_t size)
+{
+	const char *p = rec->format, *pct;
+	char spec_str[LOG_SPEC_MAX];
+	struct log_spec spec;
+	size_t pos = 0, len;
+	int star[2] = {};
+	int n = 0, i, ret = 0;
+	union log_arg arg = {};
+
+	if (!rec->format) {
+		snprintf(buf, size, "%s", rec->str);
+		return;
+	}
+
+#define LOG_EMIT(val)								\
+	(spec.stars == 0 ? snprintf(buf + pos, size - pos, spec_str, val) :	\
+	 spec.stars == 1 ? snprintf(buf + pos, size - pos, spec_str, star[0], val) : \
+	 snprintf(buf + pos, size - pos, spec_str, star[0], star[1], val))
+
+	while (pos < size - 1 && (pct = strchr(p, '%'))) {
+		len = pct - p;
+		if (len > size - 1 - pos)
+			len = size - 1 - pos;
+		memcpy(buf + pos, p, len);
+		pos += len;
+		if (pos >= size - 1)
+			break;
+
+		log_parse_spec(pct, &spec);
+		memcpy(spec_str, pct, spec.len);
+		spec_str[spec.len] = '\0';
+		p = pct + spec.len;
+
+		for (i = 0; i < spec.stars; i++)
+			star[i] = rec->args[n++].i;
+		if (spec.conv != 'm' && spec.conv != '%')
+			arg = rec->args[n++];
+
+		switch (spec.conv) {
+		case 'd': case 'i': case 'c':
+		case 'o': case 'u': case 'x': case 'X':
+			if (spec.length == LEN_LLONG)
+				ret = LOG_EMIT(arg.i);
+			else if (spec.length == LEN_LONG)
+				ret = LOG_EMIT((long)arg.i);
+			else
+				ret = LOG_EMIT((int)arg.i);
+			break;
+		case 'e': case 'E': case 'f': case 'F':
+		case 'g': case 'G': case 'a': case 'A':
+			ret = LOG_EMIT(arg.d);
+			break;
+		case 'p':
+			ret = LOG_EMIT(arg.p);
+			break;
+		case 's':
+			ret = LOG_EMIT(rec->str + arg.i);
+			break;
+		case 'm':
+			ret = snprintf(buf + pos, size - pos, "%s", strerror(rec->saved_errno));
+			break;
+		case '%':
+			ret = snprintf(buf + pos, size - pos, "%%");
+			break;
+		}
+		if (ret > 0)
+			pos += ret;
+		if (pos > size - 1)
+			pos = size - 1;
+	}
+#undef LOG_EMIT
+
+	if (pos < size - 1 && !pct)
+		snprintf(buf + pos, size - pos, "%s", p);
+	else
+		buf[pos] = '\0';
+}
+
+static void log_futex(atomic_int *addr, int op, int val, const struct timespec *timeout)
+{
+	syscall(SYS_futex, addr, op, val, timeout, NULL, 0);
+}
+
+static int log_ring_ready(void)
+{
+	unsigned long tail = atomic_load_explicit(&log_tail, memory_order_relaxed);
+
+	return atomic_load_explicit(&log_ring[tail & (LOG_RING_SLOTS - 1)].seq,
+				    memory_order_acquire) == tail + 1;
+}
+
+static void *log_thread_fn(void *arg)
+{
+	const struct timespec idle = { .tv_nsec = LOG_FLUSH_MS * 1000000L };
+	struct log_record *rec;
+	char log_buffer[1024];
+	char timestamp[32];
+	unsigned long tail;
+
+	for (;;) {
+		while (log_ring_ready()) {
+			tail = atomic_load_explicit(&log_tail, memory_order_relaxed);
+			rec = &log_ring[tail & (LOG_RING_SLOTS - 1)];
+
+			log_render(rec, log_buffer, sizeof(log_buffer));
+			snprintf(timestamp, sizeof(timestamp), "%ld.%03ld",
+				 rec->ts.tv_sec, rec->ts.tv_nsec / 1000000);
+			log_write(rec->level, timestamp, log_buffer);
+
+			atomic_store_explicit(&rec->seq, tail + LOG_RING_SLOTS,
+					      memory_order_release);
+			atomic_store_explicit(&log_tail, tail + 1, memory_order_release);
+		}
+		fflush(stdout);
+
+		if (atomic_load(&log_stop))
+			break;
+
+		/* producers only make the wake up call while this is set */
+		atomic_store(&log_sleeping, 1);
+		if (!log_ring_ready() && !atomic_load(&log_stop))
+			log_futex(&log_sleeping, FUTEX_WAIT_PRIVATE, 1, &idle);
+		atomic_store(&log_sleeping, 0);
+	}
+
+	return NULL;
+}
+
+static void log_async_push(int level, const char *format, va_list args)
+{
+	struct log_record *rec;
+	unsigned long pos, seq;
+	int saved_errno = errno;
+	va_list copy;
+	long diff;
+
+	pos = atomic_load_explicit(&log_head, memory_order_relaxed);
+	for (;;) {
+		rec = &log_ring[pos & (LOG_RING_SLOTS - 1)];
+		seq = atomic_load_explicit(&rec->seq, memory_order_acquire);
+		diff = (long)(seq - pos);
+		if (diff == 0) {
+			if (atomic_compare_exchange_weak_explicit(&log_head, &pos, pos + 1,
+								  memory_order_relaxed,
+								  memory_order_relaxed))
+				break;
+		} else if (diff < 0) {
+			atomic_fetch_add_explicit(&log_dropped, 1, memory_order_relaxed);
+			return;
+		} else {
+			pos = atomic_load_explicit(&log_head, memory_order_relaxed);
+		}
+	}
+
+	rec->level = level;
+	rec->saved_errno = saved_errno;
+	clock_gettime(CLOCK_MONOTONIC, &rec->ts);
+	rec->format = format;
+	va_copy(copy, args);
+	if (log_capture(rec, format, copy)) {
+		/* not capturable, format it here instead */
+		rec->format = NULL;
+		errno = saved_errno;
+		vsnprintf(rec->str, sizeof(rec->str), format, args);
+	}
+	va_end(copy);
+
+	atomic_store_explicit(&rec->seq, pos + 1, memory_order_release);
+
+	if (pos + 1 - atomic_load_explicit(&log_tail, memory_order_relaxed) < LOG_WAKE_FILL)
+		return;
+	atomic_thread_fence(memory_order_seq_cst);
+	if (atomic_load_explicit(&log_sleeping, memory_order_relaxed) &&
+	    atomic_exchange(&log_sleeping, 0))
+		log_futex(&log_sleeping, FUTEX_WAKE_PRIVATE, 1, NULL);
+}
+
 /**
  * @brief Log a message with a specified log level.
  *
@@ -62,6 +425,13 @@ void log_message(int level, const char *format, ...)
 	if (level > log_level)
 		return;
 
+	if (atomic_load_explicit(&log_async, memory_order_relaxed)) {
+		va_start(args, format);
+		log_async_push(level, format, args);
+		va_end(args);
+		return;
+	}
+
 	// Get the current timestamp
 	get_timestamp(timestamp, sizeof(timestamp));
 
@@ -70,11 +440,88 @@ void log_message(int level, const char *format, ...)
 	vsnprintf(log_buffer, sizeof(log_buffer), format, args);
 	va_end(args);
 
-	// Lock the mutex to ensure thread-safe logging
-	pthread_mutex_lock(&log_mutex);
-	if (log_destination == LOG_TO_CONSOLE)
-		printf("[%s] %s\n", timestamp, log_buffer); // Log to console
-	else
-		syslog(level, "[%s] %s", timestamp, log_buffer); //// Log to syslog
-	pthread_mutex_unlock(&log_mutex); // Unlock the mutex
+	log_write(level, timestamp, log_buffer);
+}
+
+/**
+ * @brief Set the log level.
+ *
+ * Messages with a level higher than this are dropped, LOG_INFO by default.
+ *
+ * @param level The new log level.
+ */
+void log_set_level(int level)
+{
+	log_level = level;
+}
+
+static void log_async_stop(void)
+{
+	unsigned long dropped;
+
+	if (!atomic_exchange(&log_async, 0))
+		return;
+
+	atomic_store(&log_stop, 1);
+	atomic_store(&log_sleeping, 0);
+	log_futex(&log_sleeping, FUTEX_WAKE_PRIVATE, 1, NULL);
+	pthread_join(log_thread, NULL);
+
+	dropped = atomic_load(&log_dropped);
+	if (dropped)
+		log_message(LOG_WARNING, "%lu log messages dropped, ring full", dropped);
+}
+
+/**
+ * @brief Switch between synchronous and asynchronous logging.
+ *
+ * With asynchronous logging enabled, log_message() only records the format
+ * and its arguments, and a background thread formats and writes them.
+ * Messages are dropped, and counted, if that thread falls behind by more
+ * than LOG_RING_SLOTS messages. Disabling it, or exiting the process,
+ * writes out everything still queued.
+ *
+ * @param enable Non-zero to log asynchronously.
+ * @return 0 on success, or the error of pthread_create().
+ */
+int log_set_async(int enable)
+{
+	static int registered;
+	sigset_t all, old;
+	unsigned long i;
+	int ret;
+
+	if (!enable) {
+		log_async_stop();
+		return 0;
+	}
+	if (atomic_load(&log_async))
+		return 0;
+
+	for (i = 0; i < LOG_RING_SLOTS; i++)
+		atomic_store(&log_ring[i].seq, i);
+	atomic_store(&log_head, 0);
+	atomic_store(&log_tail, 0);
+	atomic_store(&log_stop, 0);
+
+	/* signals are left to the threads of the application */
+	sigfillset(&all);
+	pthread_sigmask(SIG_SETMASK, &all, &old);
+	ret = pthread_create(&log_thread, NULL, log_thread_fn, NULL);
+	pthread_sigmask(SIG_SETMASK, &old, NULL);
+	if (ret)
+		return ret;
+	if (!registered++)
+		atexit(log_async_stop);
+	atomic_store(&log_async, 1);
+
+	return 0;
+}
+
+/**
+ * @brief Number of messages dropped by the asynchronous backend.
+ */
+unsigned long log_dropped_count(void)
+{
+	return atomic_load(&log_dropped);
 }
@@ -11,6 +11,9 @@
 #include <syslog.h>
 
 void log_message(int level, const char *format, ...);
+void log_set_level(int level);
+int log_set_async(int enable);
+unsigned long log_dropped_count(void);
 
 #define pr_err(x...)     log_message(LOG_ERR, x)
 #define pr_warning(x...) log_message(LOG_WARNING, x)
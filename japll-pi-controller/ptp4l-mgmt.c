@@ -0,0 +1,196 @@
+// SPDX-License-Identifier: MIT
+/*
+ * @file ptp4l-mgmt.c
+ * @brief minimal client for the ptp4l management socket
+ * Copyright (C) 2026 Microchip Technology Inc. and its subsidiaries
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <endian.h>
+
+#include <sys/socket.h>
+
+#include "ptp4l-mgmt.h"
+
+/* IEEE 1588 management message, all fields big endian */
+#define PTP_VERSION                 2
+#define MSG_TYPE_MANAGEMENT         0xD
+#define CTL_MANAGEMENT              4
+#define LOG_INTERVAL_NONE           0x7F
+#define ACTION_SET                  1
+#define ACTION_RESPONSE             2
+#define TLV_MANAGEMENT              0x0001
+#define TLV_MANAGEMENT_ERROR_STATUS 0x0002
+#define MID_TIME_STATUS_NP          0xC000
+#define MID_SUBSCRIBE_EVENTS_NP     0xC003
+#define NOTIFY_TIME_SYNC            1
+
+#define HDR_LEN                     48   /* common header + management fields */
+#define TLV_HDR_LEN                 6    /* type, length, managementId */
+#define SUBSCRIBE_DATA_LEN          66   /* duration + 64 byte event bitmask */
+#define TIME_STATUS_MIN_LEN         16   /* master_offset + ingress_time */
+
+#define OFF_TSMT                    0
+#define OFF_VERSION                 1
+#define OFF_LENGTH                  2
+#define OFF_DOMAIN                  4
+#define OFF_SOURCE_PORT             28
+#define OFF_SEQUENCE                30
+#define OFF_CONTROL                 32
+#define OFF_LOG_INTERVAL            33
+#define OFF_TARGET_CLOCK            34
+#define OFF_ACTION                  46
+#define OFF_TLV                     48
+
+static void put16(uint8_t *p, uint16_t v)
+{
+	v = htobe16(v);
+	memcpy(p, &v, sizeof(v));
+}
+
+static uint16_t get16(const uint8_t *p)
+{
+	uint16_t v;
+
+	memcpy(&v, p, sizeof(v));
+	return be16toh(v);
+}
+
+static int64_t get64(const uint8_t *p)
+{
+	uint64_t v;
+
+	memcpy(&v, p, sizeof(v));
+	return be64toh(v);
+}
+
+/*
+ * Bind our own socket so ptp4l has an address to reply and send
+ * notifications to, and remember where ptp4l listens.
+ */
+int ptp4l_mgmt_open(struct ptp4l_mgmt *mgmt, const char *address,
+		    int domain, int transport)
+{
+	memset(mgmt, 0, sizeof(*mgmt));
+	mgmt->domain = domain;
+	mgmt->transport = transport;
+
+	if (strlen(address) >= sizeof(mgmt->server.sun_path))
+		return ENAMETOOLONG;
+	mgmt->server.sun_family = AF_UNIX;
+	strcpy(mgmt->server.sun_path, address);
+
+	mgmt->local.sun_family = AF_UNIX;
+	snprintf(mgmt->local.sun_path, sizeof(mgmt->local.sun_path),
+		 "/var/run/japll-pi.%d", getpid());
+
+	mgmt->fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+	if (mgmt->fd < 0)
+		return errno;
+
+	unlink(mgmt->local.sun_path);
+	if (bind(mgmt->fd, (struct sockaddr *)&mgmt->local, sizeof(mgmt->local))) {
+		int err = errno;
+
+		close(mgmt->fd);
+		mgmt->fd = -1;
+		return err;
+	}
+
+	return 0;
+}
+
+void ptp4l_mgmt_close(struct ptp4l_mgmt *mgmt)
+{
+	if (mgmt->fd < 0)
+		return;
+	close(mgmt->fd);
+	unlink(mgmt->local.sun_path);
+	mgmt->fd = -1;
+}
+
+/* SET SUBSCRIBE_EVENTS_NP for NOTIFY_TIME_SYNC, fails until ptp4l is up */
+int ptp4l_mgmt_subscribe(struct ptp4l_mgmt *mgmt)
+{
+	uint8_t msg[HDR_LEN + TLV_HDR_LEN + SUBSCRIBE_DATA_LEN] = {};
+	uint8_t *data = msg + OFF_TLV + TLV_HDR_LEN;
+
+	msg[OFF_TSMT] = (mgmt->transport << 4) | MSG_TYPE_MANAGEMENT;
+	msg[OFF_VERSION] = PTP_VERSION;
+	put16(msg + OFF_LENGTH, sizeof(msg));
+	msg[OFF_DOMAIN] = mgmt->domain;
+	put16(msg + OFF_SOURCE_PORT, getpid());
+	put16(msg + OFF_SEQUENCE, mgmt->sequence++);
+	msg[OFF_CONTROL] = CTL_MANAGEMENT;
+	msg[OFF_LOG_INTERVAL] = LOG_INTERVAL_NONE;
+	/* all clocks and ports, zero boundary hops keeps it on this clock */
+	memset(msg + OFF_TARGET_CLOCK, 0xff, 10);
+	msg[OFF_ACTION] = ACTION_SET;
+
+	put16(msg + OFF_TLV, TLV_MANAGEMENT);
+	put16(msg + OFF_TLV + 2, 2 + SUBSCRIBE_DATA_LEN);
+	put16(msg + OFF_TLV + 4, MID_SUBSCRIBE_EVENTS_NP);
+	put16(data, PTP4L_MGMT_SUBSCRIBE_SEC);
+	data[2 + NOTIFY_TIME_SYNC / 8] |= 1 << (NOTIFY_TIME_SYNC % 8);
+
+	if (sendto(mgmt->fd, msg, sizeof(msg), 0,
+		   (struct sockaddr *)&mgmt->server, sizeof(mgmt->server)) < 0)
+		return errno;
+
+	clock_gettime(CLOCK_MONOTONIC, &mgmt->subscribed);
+
+	return 0;
+}
+
+/* Renew the subscription once a third of its lifetime has passed */
+int ptp4l_mgmt_renew(struct ptp4l_mgmt *mgmt)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	if (now.tv_sec - mgmt->subscribed.tv_sec < PTP4L_MGMT_SUBSCRIBE_SEC / 3)
+		return 0;
+
+	return ptp4l_mgmt_subscribe(mgmt);
+}
+
+/*
+ * Receive one message. Returns 0 when it was a TIME_STATUS_NP notification,
+ * filling in 'status', ENOMSG for any other management message, EPROTO for
+ * a management error status, or the errno of recv(), e.g. EAGAIN with
+ * MSG_DONTWAIT in 'flags'.
+ */
+int ptp4l_mgmt_recv(struct ptp4l_mgmt *mgmt, struct ptp4l_time_status *status,
+		    int flags)
+{
+	uint8_t msg[1500];
+	uint16_t tlv_len;
+	ssize_t len;
+
+	len = recv(mgmt->fd, msg, sizeof(msg), flags);
+	if (len < 0)
+		return errno;
+
+	if (len < HDR_LEN + TLV_HDR_LEN ||
+	    (msg[OFF_TSMT] & 0xf) != MSG_TYPE_MANAGEMENT ||
+	    (msg[OFF_ACTION] & 0xf) != ACTION_RESPONSE)
+		return ENOMSG;
+
+	if (get16(msg + OFF_TLV) == TLV_MANAGEMENT_ERROR_STATUS)
+		return EPROTO;
+
+	tlv_len = get16(msg + OFF_TLV + 2);
+	if (get16(msg + OFF_TLV) != TLV_MANAGEMENT ||
+	    get16(msg + OFF_TLV + 4) != MID_TIME_STATUS_NP ||
+	    tlv_len < 2 + TIME_STATUS_MIN_LEN ||
+	    len < OFF_TLV + 4 + tlv_len)
+		return ENOMSG;
+
+	status->master_offset = get64(msg + OFF_TLV + TLV_HDR_LEN);
+	status->ingress_time = get64(msg + OFF_TLV + TLV_HDR_LEN + 8);
+
+	return 0;
+}
@@ -0,0 +1,50 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * @file ptp4l-mgmt.h
+ * @brief minimal client for the ptp4l management socket
+ * Copyright (C) 2026 Microchip Technology Inc. and its subsidiaries
+ *
+ * ptp4l serves PTP management messages on a local unix datagram socket
+ * (uds_address, /var/run/ptp4l by default). A client that subscribes to
+ * NOTIFY_TIME_SYNC is sent a TIME_STATUS_NP message each time the clock
+ * servo has run, carrying the master offset and the ingress time of the
+ * sync message it was run for. This replaces scraping the "freq" value
+ * out of the ptp4l -m text output.
+ */
+
+#ifndef __PTP4L_MGMT_H
+#define __PTP4L_MGMT_H
+
+#include <stdint.h>
+#include <time.h>
+#include <sys/un.h>
+
+#define PTP4L_MGMT_DEFAULT_ADDRESS   "/var/run/ptp4l"
+
+/* Subscriptions expire, they are renewed after a third of this */
+#define PTP4L_MGMT_SUBSCRIBE_SEC     180
+
+struct ptp4l_mgmt {
+	int                 fd;
+	struct sockaddr_un  local;           /* our own bound address */
+	struct sockaddr_un  server;          /* ptp4l's uds_address */
+	uint8_t             domain;          /* domainNumber of ptp4l */
+	uint8_t             transport;       /* transportSpecific of ptp4l */
+	uint16_t            sequence;
+	struct timespec     subscribed;      /* CLOCK_MONOTONIC of last subscription */
+};
+
+struct ptp4l_time_status {
+	int64_t  master_offset;  /* ns */
+	int64_t  ingress_time;   /* ns, in the time base of the servoed clock */
+};
+
+int ptp4l_mgmt_open(struct ptp4l_mgmt *mgmt, const char *address,
+		    int domain, int transport);
+void ptp4l_mgmt_close(struct ptp4l_mgmt *mgmt);
+int ptp4l_mgmt_subscribe(struct ptp4l_mgmt *mgmt);
+int ptp4l_mgmt_renew(struct ptp4l_mgmt *mgmt);
+int ptp4l_mgmt_recv(struct ptp4l_mgmt *mgmt, struct ptp4l_time_status *status,
+		    int flags);
+
+#endif /* __PTP4L_MGMT_H */
@@ -0,0 +1,182 @@
+// SPDX-License-Identifier: MIT
+/*
+ * @file mmio-trace-dump.c
+ * @brief print and summarise register access traces
+ * Copyright (C) 2026 Microchip Technology Inc. and its subsidiaries
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "mmio-trace.h"
+
+struct reg_stats {
+	uint64_t base;
+	uint32_t offset;
+	uint32_t last_value;     /* last value read from or written to the register */
+	bool     value_known;
+	uint64_t reads;
+	uint64_t writes;
+	uint64_t redundant_writes; /* writes of the value the register already held */
+	uint64_t repeated_reads;   /* reads returning the same value as the last read */
+	uint64_t read_ns;
+	uint64_t write_ns;
+	uint32_t read_max_ns;
+	uint32_t write_max_ns;
+};
+
+static struct reg_stats *regs;
+static size_t num_regs;
+
+static int compare_ts(const void *a, const void *b)
+{
+	const struct mmio_trace_rec *ra = a;
+	const struct mmio_trace_rec *rb = b;
+
+	if (ra->ts_ns < rb->ts_ns)
+		return -1;
+	return ra->ts_ns > rb->ts_ns;
+}
+
+static struct reg_stats *find_reg(uint64_t base, uint32_t offset)
+{
+	size_t i;
+
+	for (i = 0; i < num_regs; i++)
+		if (regs[i].base == base && regs[i].offset == offset)
+			return &regs[i];
+
+	regs = realloc(regs, (num_regs + 1) * sizeof(*regs));
+	if (!regs) {
+		fprintf(stderr, "out of memory\n");
+		exit(EXIT_FAILURE);
+	}
+	memset(&regs[num_regs], 0, sizeof(*regs));
+	regs[num_regs].base = base;
+	regs[num_regs].offset = offset;
+
+	return &regs[num_regs++];
+}
+
+static void account(const struct mmio_trace_rec *rec)
+{
+	struct reg_stats *reg = find_reg(rec->base, rec->offset);
+
+	if (rec->op == MMIO_TRACE_OP_WRITE) {
+		reg->writes++;
+		reg->write_ns += rec->cost_ns;
+		if (rec->cost_ns > reg->write_max_ns)
+			reg->write_max_ns = rec->cost_ns;
+		if (reg->value_known && reg->last_value == rec->value)
+			reg->redundant_writes++;
+	} else {
+		reg->reads++;
+		reg->read_ns += rec->cost_ns;
+		if (rec->cost_ns > reg->read_max_ns)
+			reg->read_max_ns = rec->cost_ns;
+		if (reg->value_known && reg->last_value == rec->value)
+			reg->repeated_reads++;
+	}
+	reg->last_value = rec->value;
+	reg->value_known = true;
+}
+
+static void usage(const char *prog)
+{
+	printf("usage: %s [-l] trace-file\n", prog);
+	printf("\t-l  list every access in time order before the summary\n");
+}
+
+int main(int argc, char *argv[])
+{
+	struct mmio_trace_file_hdr hdr;
+	struct mmio_trace_rec *recs;
+	struct reg_stats *reg;
+	bool list = false;
+	uint64_t i;
+	FILE *fp;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "lh")) != -1) {
+		switch (opt) {
+		case 'l':
+			list = true;
+			break;
+		default:
+			usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (optind >= argc) {
+		usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	fp = fopen(argv[optind], "rb");
+	if (!fp) {
+		perror(argv[optind]);
+		return EXIT_FAILURE;
+	}
+
+	if (fread(&hdr, sizeof(hdr), 1, fp) != 1 || hdr.magic != MMIO_TRACE_MAGIC ||
+	    hdr.rec_size != sizeof(struct mmio_trace_rec)) {
+		fprintf(stderr, "%s is not a register trace\n", argv[optind]);
+		fclose(fp);
+		return EXIT_FAILURE;
+	}
+
+	recs = malloc(hdr.num_recs * sizeof(*recs));
+	if (hdr.num_recs && !recs) {
+		fprintf(stderr, "out of memory\n");
+		fclose(fp);
+		return EXIT_FAILURE;
+	}
+	if (fread(recs, sizeof(*recs), hdr.num_recs, fp) != hdr.num_recs) {
+		fprintf(stderr, "%s is truncated\n", argv[optind]);
+		fclose(fp);
+		return EXIT_FAILURE;
+	}
+	fclose(fp);
+
+	qsort(recs, hdr.num_recs, sizeof(*recs), compare_ts);
+
+	printf("%lu accesses from %u thread(s), %lu lost to ring wrap\n",
+	       hdr.num_recs, hdr.num_threads, hdr.lost_recs);
+
+	for (i = 0; i < hdr.num_recs; i++) {
+		if (list)
+			printf("%lu.%09lu t%u %c 0x%lx+0x%03x = 0x%08x (%u ns)\n",
+			       recs[i].ts_ns / 1000000000, recs[i].ts_ns % 1000000000,
+			       recs[i].thread,
+			       recs[i].op == MMIO_TRACE_OP_WRITE ? 'W' : 'R',
+			       recs[i].base, recs[i].offset, recs[i].value,
+			       recs[i].cost_ns);
+		account(&recs[i]);
+	}
+
+	if (hdr.num_recs > 1)
+		printf("trace spans %.6f s\n",
+		       (recs[hdr.num_recs - 1].ts_ns - recs[0].ts_ns) / 1e9);
+
+	printf("\n%-20s %10s %10s %10s %10s %10s %10s %10s %10s\n",
+	       "register", "reads", "avg ns", "max ns", "repeated",
+	       "writes", "avg ns", "max ns", "redundant");
+	for (i = 0; i < num_regs; i++) {
+		reg = &regs[i];
+		printf("0x%lx+0x%03x %10lu %10lu %10u %10lu %10lu %10lu %10u %10lu\n",
+		       reg->base, reg->offset,
+		       reg->reads, reg->reads ? reg->read_ns / reg->reads : 0,
+		       reg->read_max_ns, reg->repeated_reads,
+		       reg->writes, reg->writes ? reg->write_ns / reg->writes : 0,
+		       reg->write_max_ns, reg->redundant_writes);
+	}
+
+	free(recs);
+	free(regs);
+	return EXIT_SUCCESS;
+}
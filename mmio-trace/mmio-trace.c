@@ -0,0 +1,116 @@
+// SPDX-License-Identifier: MIT
+/*
+ * @file mmio-trace.c
+ * @brief per-thread register access trace rings
+ * Copyright (C) 2026 Microchip Technology Inc. and its subsidiaries
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <stdatomic.h>
+
+#include "mmio-trace.h"
+
+/*
+ * Each thread owns one ring and is the only writer of it, so recording needs
+ * no locks. Rings are pushed onto a global list the first time a thread
+ * records an access and are never freed, which lets mmio_trace_dump() walk
+ * them from any thread.
+ */
+struct mmio_trace_ring {
+	struct mmio_trace_ring *next;
+	_Atomic uint64_t head;     /* total records ever written */
+	uint16_t thread;
+	struct mmio_trace_rec recs[MMIO_TRACE_RING_ENTRIES];
+};
+
+static struct mmio_trace_ring *_Atomic ring_list;
+static atomic_uint num_rings;
+static __thread struct mmio_trace_ring *thread_ring;
+
+static struct mmio_trace_ring *mmio_trace_ring_create(void)
+{
+	struct mmio_trace_ring *ring;
+
+	ring = calloc(1, sizeof(*ring));
+	if (!ring)
+		return NULL;
+
+	ring->thread = atomic_fetch_add(&num_rings, 1);
+	ring->next = atomic_load(&ring_list);
+	while (!atomic_compare_exchange_weak(&ring_list, &ring->next, ring))
+		;
+
+	return ring;
+}
+
+void mmio_trace_record(volatile void *base, uint32_t offset, uint32_t value,
+		       int op, uint64_t ts_ns, uint64_t end_ns)
+{
+	struct mmio_trace_ring *ring = thread_ring;
+	struct mmio_trace_rec *rec;
+	uint64_t head;
+
+	if (!ring) {
+		ring = mmio_trace_ring_create();
+		if (!ring)
+			return;
+		thread_ring = ring;
+	}
+
+	head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+	rec = &ring->recs[head % MMIO_TRACE_RING_ENTRIES];
+	rec->ts_ns = ts_ns;
+	rec->base = (uintptr_t)base;
+	rec->offset = offset;
+	rec->value = value;
+	rec->cost_ns = end_ns - ts_ns;
+	rec->thread = ring->thread;
+	rec->op = op;
+	rec->width = sizeof(uint32_t);
+	atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+}
+
+/*
+ * Write every ring to 'path'. Records are written ring by ring, oldest first;
+ * the dump tool merges them by timestamp.
+ */
+int mmio_trace_dump(const char *path)
+{
+	struct mmio_trace_file_hdr hdr = {
+		.magic = MMIO_TRACE_MAGIC,
+		.rec_size = sizeof(struct mmio_trace_rec),
+	};
+	struct mmio_trace_ring *ring;
+	uint64_t head, first, i;
+	FILE *fp;
+
+	fp = fopen(path, "wb");
+	if (!fp)
+		return errno;
+
+	/* reserve the header, it is rewritten once the counts are known */
+	fwrite(&hdr, sizeof(hdr), 1, fp);
+
+	for (ring = atomic_load(&ring_list); ring; ring = ring->next) {
+		head = atomic_load_explicit(&ring->head, memory_order_acquire);
+		first = head > MMIO_TRACE_RING_ENTRIES ?
+			head - MMIO_TRACE_RING_ENTRIES : 0;
+		for (i = first; i < head; i++)
+			fwrite(&ring->recs[i % MMIO_TRACE_RING_ENTRIES],
+			       sizeof(struct mmio_trace_rec), 1, fp);
+		hdr.num_recs += head - first;
+		hdr.lost_recs += first;
+		hdr.num_threads++;
+	}
+
+	rewind(fp);
+	fwrite(&hdr, sizeof(hdr), 1, fp);
+
+	if (fclose(fp) != 0)
+		return errno;
+
+	return 0;
+}
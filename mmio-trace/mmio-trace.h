@@ -0,0 +1,102 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * @file mmio-trace.h
+ * @brief typed register accessors with optional access tracing
+ * Copyright (C) 2026 Microchip Technology Inc. and its subsidiaries
+ *
+ * All register reads and writes to memory mapped devices should go through
+ * mmio_read32()/mmio_write32(). By default these compile down to a single
+ * volatile access. When built with -DMMIO_TRACE each access is additionally
+ * recorded, with its offset, value, timestamp and cost, into a per-thread
+ * ring that can be written out with mmio_trace_dump() and inspected with the
+ * mmio-trace-dump tool.
+ */
+
+#ifndef __MMIO_TRACE_H
+#define __MMIO_TRACE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <time.h>
+
+#define MMIO_TRACE_MAGIC        0x31435254494f4d4dULL  /* "MMIOTRC1" */
+#define MMIO_TRACE_OP_READ      0
+#define MMIO_TRACE_OP_WRITE     1
+
+/* Records kept per thread, the oldest are overwritten once the ring wraps */
+#ifndef MMIO_TRACE_RING_ENTRIES
+#define MMIO_TRACE_RING_ENTRIES 65536
+#endif
+
+struct mmio_trace_rec {
+	uint64_t ts_ns;    /* CLOCK_MONOTONIC time the access started */
+	uint64_t base;     /* address of the mapping the offset is relative to */
+	uint32_t offset;   /* register offset in bytes */
+	uint32_t value;    /* value read or written */
+	uint32_t cost_ns;  /* time taken by the access itself */
+	uint16_t thread;   /* index of the recording thread */
+	uint8_t  op;       /* MMIO_TRACE_OP_READ or MMIO_TRACE_OP_WRITE */
+	uint8_t  width;    /* access width in bytes */
+};
+
+struct mmio_trace_file_hdr {
+	uint64_t magic;
+	uint32_t rec_size;
+	uint32_t num_threads;
+	uint64_t num_recs;
+	uint64_t lost_recs;  /* records overwritten before the dump */
+};
+
+#ifdef MMIO_TRACE
+
+void mmio_trace_record(volatile void *base, uint32_t offset, uint32_t value,
+		       int op, uint64_t ts_ns, uint64_t end_ns);
+int mmio_trace_dump(const char *path);
+
+static inline uint64_t mmio_trace_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static inline uint32_t mmio_read32(volatile void *base, uint32_t offset)
+{
+	uint64_t start = mmio_trace_now();
+	uint32_t val = *(volatile uint32_t *)((volatile uint8_t *)base + offset);
+
+	mmio_trace_record(base, offset, val, MMIO_TRACE_OP_READ, start,
+			  mmio_trace_now());
+	return val;
+}
+
+static inline void mmio_write32(volatile void *base, uint32_t offset, uint32_t val)
+{
+	uint64_t start = mmio_trace_now();
+
+	*(volatile uint32_t *)((volatile uint8_t *)base + offset) = val;
+	mmio_trace_record(base, offset, val, MMIO_TRACE_OP_WRITE, start,
+			  mmio_trace_now());
+}
+
+#else
+
+static inline int mmio_trace_dump(const char *path)
+{
+	return 0;
+}
+
+static inline uint32_t mmio_read32(volatile void *base, uint32_t offset)
+{
+	return *(volatile uint32_t *)((volatile uint8_t *)base + offset);
+}
+
+static inline void mmio_write32(volatile void *base, uint32_t offset, uint32_t val)
+{
+	*(volatile uint32_t *)((volatile uint8_t *)base + offset) = val;
+}
+
+#endif /* MMIO_TRACE */
+
+#endif /* __MMIO_TRACE_H */